@@ -13,10 +13,12 @@ def AciCommandLookUp(CommandOpCode):
         AciFlagSet.OpCode: "FlagSet",
         AciFlagGet.OpCode: "FlagGet",
         AciDfuData.OpCode: "DfuData",
+        AciTrickleParamsSet.OpCode: "TrickleParamsSet",
         AciValueGet.OpCode: "ValueGet",
         AciBuildVersionGet.OpCode: "BuildVersionGet",
         AciAccessAddressGet.OpCode: "AccessAddressGet",
         AciChannelGet.OpCode: "ChannelGet",
+        AciStatsGet.OpCode: "StatsGet",
         AciIntervalMinMsGet.OpCode: "IntervalMinMsGet",
     }
 
@@ -136,6 +138,16 @@ class AciDfuData(AciCommandPkt):
         else:
             super(AciDfuData, self).__init__(length=length,OpCode=self.OpCode, data = data)
 
+class AciTrickleParamsSet(AciCommandPkt):
+    OpCode = 0x79
+    Length = 7
+    def __init__(self, handle, i_min_ms=0, i_max=0, k=0):
+        payload = valueToByteArray(handle,2)
+        payload.extend(valueToByteArray(i_min_ms,2))
+        payload.extend(valueToByteArray(i_max,1))
+        payload.extend(valueToByteArray(k,1))
+        super(AciTrickleParamsSet, self).__init__(length=self.Length, OpCode=self.OpCode, data=payload)
+
 class AciValueGet(AciCommandPkt):
     OpCode = 0x7A
     Length = 3
@@ -161,6 +173,13 @@ class AciChannelGet(AciCommandPkt):
     def __init__(self):
         super(AciChannelGet, self).__init__(length=self.Length,OpCode=self.OpCode)
 
+class AciStatsGet(AciCommandPkt):
+    OpCode = 0x7E
+    Length = 2
+    def __init__(self, first_stat):
+        payload = valueToByteArray(first_stat,1)
+        super(AciStatsGet, self).__init__(length=self.Length, OpCode=self.OpCode, data=payload)
+
 class AciIntervalMinMsGet(AciCommandPkt):
     OpCode = 0x7F
     Length = 1
@@ -14,8 +14,14 @@ def AciEventDeserialize(pkt):
         0xB6: AciEventTX
     }
 
+    cmdRspLUT = {
+        AciCommand.AciStatsGet.OpCode: AciStatsGetRsp
+    }
+
     opcode = pkt[1]
-    if opcode in eventLUT:
+    if opcode == 0x84 and len(pkt) > 2 and pkt[2] in cmdRspLUT:
+        return cmdRspLUT[pkt[2]](pkt)
+    elif opcode in eventLUT:
         return eventLUT[opcode](pkt)
     else:
         return AciEventPkt(pkt)
@@ -92,6 +98,23 @@ class AciCmdRsp(AciEventPkt):
     def __repr__(self):
         return str.format("I am %s and my Lenght is %d, OpCode is 0x%02x, CommandOpCode is %s, StatusCode is %s, and Data is %s" %(self.__class__.__name__, self.Len, self.OpCode, AciCommand.AciCommandLookUp(self.CommandOpCode), AciStatusLookUp(self.StatusCode), self.Data))
 
+class AciStatsGetRsp(AciCmdRsp):
+    #OpCode = 0x84, CommandOpCode = 0x7E
+    def __init__(self,pkt):
+        super(AciStatsGetRsp, self).__init__(pkt)
+        self.FirstStat = None
+        self.Stats = []
+        if self.Len > 3:
+            self.FirstStat = self.Data[0]
+            statData = self.Data[1:]
+            if len(statData) % 4 != 0:
+                logging.error("Invalid length for %s event: %s", self.__class__.__name__, str(pkt))
+            for i in range(0, len(statData) - len(statData) % 4, 4):
+                self.Stats.append(statData[i] | (statData[i+1] << 8) | (statData[i+2] << 16) | (statData[i+3] << 24))
+
+    def __repr__(self):
+        return str.format("I am %s and my Lenght is %d, OpCode is 0x%02x, CommandOpCode is %s, StatusCode is %s, FirstStat is %s, and Stats are %s" %(self.__class__.__name__, self.Len, self.OpCode, AciCommand.AciCommandLookUp(self.CommandOpCode), AciStatusLookUp(self.StatusCode), self.FirstStat, self.Stats))
+
 class AciEventNew(AciEventPkt):
     #OpCode = 0xB3
     def __init__(self,pkt):
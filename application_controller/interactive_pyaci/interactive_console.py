@@ -55,6 +55,9 @@ class Interactive(object):
     def DFUData(self, Data):
         self.acidev.write_aci_cmd(AciCommand.AciDfuData(data=Data, length=(len(Data)+1)))
 
+    def TrickleParamsSet(self, Handle, IntervalMinMs=0, IntervalMaxDoublings=0, K=0):
+        self.acidev.write_aci_cmd(AciCommand.AciTrickleParamsSet(handle=Handle, i_min_ms=IntervalMinMs, i_max=IntervalMaxDoublings, k=K))
+
     def BuildVersionGet(self):
         self.acidev.write_aci_cmd(AciCommand.AciBuildVersionGet())
 
@@ -67,6 +70,9 @@ class Interactive(object):
     def MinIntervalGet(self):
         self.acidev.write_aci_cmd(AciCommand.AciIntervalMinMsGet())
 
+    def StatsGet(self, FirstStat=0):
+        self.acidev.write_aci_cmd(AciCommand.AciStatsGet(first_stat=FirstStat))
+
 def get_ipython_config(device):
     # import os, sys, IPython
 
@@ -194,6 +194,18 @@ bool rbc_mesh_interval_min_get(){
 	return hal_aci_tl_send(&msg_for_mesh);
 }
 
+bool rbc_mesh_stats_get(uint8_t first_stat){
+
+    hal_aci_data_t msg_for_mesh;
+    serial_cmd_t* p_cmd = (serial_cmd_t*) msg_for_mesh.buffer;
+
+    p_cmd->length = 2;
+    p_cmd->opcode = SERIAL_CMD_OPCODE_STATS_GET;
+    p_cmd->params.stats_get.first_stat = first_stat;
+	
+	return hal_aci_tl_send(&msg_for_mesh);
+}
+
 bool rbc_mesh_tx_event_flag_set(uint16_t handle, bool value)
 {
     hal_aci_data_t msg_for_mesh;
@@ -220,6 +232,20 @@ bool rbc_mesh_persistent_flag_set(uint16_t handle, bool value)
     return hal_aci_tl_send(&msg_for_mesh);
 }
 
+bool rbc_mesh_trickle_params_set(uint16_t handle, uint16_t i_min_ms, uint8_t i_max, uint8_t k)
+{
+    hal_aci_data_t msg_for_mesh;
+    serial_cmd_t* p_cmd = (serial_cmd_t*) msg_for_mesh.buffer;
+    p_cmd->length = 7;
+    p_cmd->opcode = SERIAL_CMD_OPCODE_TRICKLE_PARAMS_SET;
+    p_cmd->params.trickle_params_set.handle = handle;
+    p_cmd->params.trickle_params_set.i_min_ms = i_min_ms;
+    p_cmd->params.trickle_params_set.i_max = i_max;
+    p_cmd->params.trickle_params_set.k = k;
+
+    return hal_aci_tl_send(&msg_for_mesh);
+}
+
 bool rbc_mesh_tx_event_flag_get(uint16_t handle)
 {
     hal_aci_data_t msg_for_mesh;
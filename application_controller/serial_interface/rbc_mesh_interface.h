@@ -137,6 +137,15 @@ bool rbc_mesh_channel_get();
  */
 bool rbc_mesh_interval_min_get();
 
+/** @brief read the runtime statistics counters
+ *  @details
+ *  promts the slave to return up to 6 statistics counters, starting at
+ *  first_stat (an rbc_mesh_stat_t index)
+ *  @return True if the data was successfully queued for sending, 
+ *  false if there is no more space to store messages to send.
+ */
+bool rbc_mesh_stats_get(uint8_t first_stat);
+
 /** @brief read the advertising intervall
  *  @details
  *  promts the slave to return the advertising intervall
@@ -155,6 +164,16 @@ bool rbc_mesh_tx_event_flag_set(uint16_t handle, bool value);
  */
 bool rbc_mesh_persistent_flag_set(uint16_t handle, bool value);
 
+/** @brief set the trickle profile of a handle
+ *  @details
+ *  sets the minimum interval, the number of interval doublings and the
+ *  redundancy constant used when propagating the given handle.
+ *  Parameters set to 0 use the slave's default value.
+ *  @return True if the data was successfully queued for sending, 
+ *  false if there is no more space to store messages to send.
+ */
+bool rbc_mesh_trickle_params_set(uint16_t handle, uint16_t i_min_ms, uint8_t i_max, uint8_t k);
+
 /** @brief read the tx_event flag
  *  @details
  *  promts the slave to return the advertising intervall
@@ -82,6 +82,14 @@ typedef struct
     uint8_t data[RBC_MESH_VALUE_MAX_LEN];
 } __packed serial_evt_cmd_rsp_params_val_get_t;
 
+#define SERIAL_EVT_STATS_PER_RSP    (6)
+
+typedef struct
+{
+    uint8_t first_stat;
+    uint32_t stats[SERIAL_EVT_STATS_PER_RSP];
+} __packed serial_evt_cmd_rsp_params_stats_t;
+
 
 /****** EVT PARAMS ******/
 typedef struct
@@ -101,6 +109,7 @@ typedef struct
         serial_evt_cmd_rsp_params_flag_get_t flag;
         serial_evt_cmd_rsp_params_adv_int_t adv_int;
         serial_evt_cmd_rsp_params_val_get_t val_get;
+        serial_evt_cmd_rsp_params_stats_t stats;
     } __packed response;        
 } __packed serial_evt_params_cmd_rsp_t;
 
@@ -225,6 +225,7 @@ static void rx_cb(mesh_packet_t* p_packet)
         rx_cmd.type = BL_CMD_TYPE_RX;
         rx_cmd.params.rx.p_dfu_packet = (dfu_packet_t*) &p_adv_data->handle;
         rx_cmd.params.rx.length = p_adv_data->adv_data_length - 3;
+        rx_cmd.params.rx.from_serial = false;
         bl_cmd_handler(&rx_cmd);
     }
 }
@@ -72,6 +72,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define DATA_REQ_SEGMENT_NONE            (0)
 
+/** Number of data segments covered by each repair segment we send as the source of a transfer. Set to 0 to disable. */
+#ifndef DFU_REPAIR_BLOCK_SIZE
+#define DFU_REPAIR_BLOCK_SIZE       (8)
+#endif
+
 /*****************************************************************************
 * Local typedefs
 *****************************************************************************/
@@ -93,14 +98,17 @@ typedef struct
     uint32_t*       p_indicated_start_addr;
     uint32_t*       p_last_requested_entry;
     uint32_t        length;
+    uint32_t        compressed_length;
     uint32_t        signature_length;
     uint8_t         signature[DFU_SIGNATURE_LEN];
     uint8_t         signature_bitmap;
     uint16_t        segments_remaining;
     uint16_t        segment_count;
     fwid_union_t    target_fwid_union;
+    sha256_context_t hash_context;
     bool            segment_is_valid_after_transfer;
     bool            flood;
+    bool            delta;
 } transaction_t;
 
 typedef struct
@@ -122,6 +130,13 @@ typedef struct
     uint16_t segment;
     uint16_t rx_count;
 } req_cache_entry_t;
+
+typedef struct
+{
+    uint16_t        first_segment;
+    uint16_t        segment_count;
+    uint8_t         parity[SEGMENT_LENGTH];
+} repair_block_t;
 /*****************************************************************************
 * Static globals
 *****************************************************************************/
@@ -132,6 +147,7 @@ static req_cache_entry_t        m_req_cache[REQ_CACHE_SIZE];
 static uint8_t                  m_req_index;
 static uint8_t                  m_tx_slots;
 static bool                     m_data_req_segment;
+static repair_block_t           m_repair_block;
 
 #ifdef RTT_LOG
 static const char*              m_state_strs[] =
@@ -212,6 +228,16 @@ static void get_info_pointers(void)
     }
 }
 
+static bool start_packet_length_is_valid(dfu_packet_t* p_packet, uint16_t length)
+{
+    if (length < DFU_PACKET_LEN_START)
+    {
+        return false;
+    }
+    /* the compressed length field is only present in compressed start packets */
+    return (!p_packet->payload.start.compressed || length >= DFU_PACKET_LEN_START_COMPRESSED);
+}
+
 static uint32_t segment_count_from_start_packet(dfu_packet_t* p_packet)
 {
     uint32_t start_address = p_packet->payload.start.start_address;
@@ -219,7 +245,13 @@ static uint32_t segment_count_from_start_packet(dfu_packet_t* p_packet)
     {
         start_address = 0; /* It'll be aligned. */
     }
-    uint32_t segment_count = ((p_packet->payload.start.length * 4) + (start_address & 0x0F) - 1) / 16 + 1;
+    /* compressed transfers send the compressed stream instead of the image */
+    uint32_t length = p_packet->payload.start.length;
+    if (p_packet->payload.start.compressed)
+    {
+        length = p_packet->payload.start.compressed_length;
+    }
+    uint32_t segment_count = ((length * 4) + (start_address & 0x0F) - 1) / 16 + 1;
 
     if (p_packet->payload.start.signature_length != 0)
     {
@@ -286,6 +318,35 @@ static void packet_tx_dynamic(dfu_packet_t* p_packet,
     }
 }
 
+/** Hash the transfer parameters, the image is hashed by the transfer module as it's written. */
+static void signature_hash_start(void)
+{
+    sha256_context_t* p_hash_context = &m_transaction.hash_context;
+    sha256_init(p_hash_context);
+    sha256_update(p_hash_context, (uint8_t*) &m_transaction.type, 1);
+    sha256_update(p_hash_context, (uint8_t*) &m_transaction.p_indicated_start_addr, 4);
+    sha256_update(p_hash_context, (uint8_t*) &m_transaction.length, 4);
+    uint8_t padding = 0;
+    sha256_update(p_hash_context, &padding, 1);
+
+    switch (m_transaction.type)
+    {
+        case DFU_TYPE_APP:
+            sha256_update(p_hash_context, (uint8_t*) &m_transaction.target_fwid_union, DFU_FWID_LEN_APP);
+            break;
+        case DFU_TYPE_SD:
+            sha256_update(p_hash_context, (uint8_t*) &m_transaction.target_fwid_union, DFU_FWID_LEN_SD);
+            break;
+        case DFU_TYPE_BOOTLOADER:
+            sha256_update(p_hash_context, (uint8_t*) &m_transaction.target_fwid_union, DFU_FWID_LEN_BL);
+            break;
+        default:
+            break;
+    }
+
+    dfu_transfer_sha256_start(p_hash_context);
+}
+
 static bool signature_check(void)
 {
     __LOG("Verifying signature... ");
@@ -303,35 +364,14 @@ static bool signature_check(void)
         return false;
     }
 
+    /* the hash was started with the transfer, only the part that arrived
+     * out of order is left. */
     uint8_t hash[uECC_BYTES];
-    sha256_context_t hash_context;
-    sha256_init(&hash_context);
-    sha256_update(&hash_context, (uint8_t*) &m_transaction.type, 1);
-    sha256_update(&hash_context, (uint8_t*) &m_transaction.p_indicated_start_addr, 4);
-    sha256_update(&hash_context, (uint8_t*) &m_transaction.length, 4);
-    uint8_t padding = 0;
-    sha256_update(&hash_context, &padding, 1);
-
-    switch (m_transaction.type)
-    {
-        case DFU_TYPE_APP:
-            sha256_update(&hash_context, (uint8_t*) &m_transaction.target_fwid_union, DFU_FWID_LEN_APP);
-            break;
-        case DFU_TYPE_SD:
-            sha256_update(&hash_context, (uint8_t*) &m_transaction.target_fwid_union, DFU_FWID_LEN_SD);
-            break;
-        case DFU_TYPE_BOOTLOADER:
-            sha256_update(&hash_context, (uint8_t*) &m_transaction.target_fwid_union, DFU_FWID_LEN_BL);
-            break;
-        default:
-            break;
-    }
-
-    dfu_transfer_sha256(&hash_context);
+    dfu_transfer_sha256(&m_transaction.hash_context);
 #if NORDIC_SDK_VERSION >= 11
-    sha256_final(&hash_context, hash, false);
+    sha256_final(&m_transaction.hash_context, hash, false);
 #else
-    sha256_final(&hash_context, hash);
+    sha256_final(&m_transaction.hash_context, hash);
 #endif
     bool success = (bool) (uECC_verify(m_bl_info_pointers.p_ecdsa_public_key, hash, m_transaction.signature));
     if (success)
@@ -512,6 +552,7 @@ static void start_ready(dfu_packet_t* p_ready_packet)
 static void start_target(void)
 {
     SET_STATE(DFU_STATE_TARGET);
+    memset(&m_repair_block, 0, sizeof(m_repair_block));
 
     bl_info_entry_t flags_entry;
     memset(&flags_entry, 0xFF, (BL_INFO_LEN_FLAGS + 3) & ~0x03UL);
@@ -610,8 +651,17 @@ static void start_target(void)
                 m_transaction.p_start_addr,
                 m_transaction.p_bank_addr,
                 m_transaction.length,
+                m_transaction.compressed_length,
+                m_transaction.delta ? (uint32_t*) m_bl_info_pointers.p_segment_app->start : NULL,
                 m_transaction.segment_is_valid_after_transfer) == NRF_SUCCESS)
     {
+        /* signature_check() only needs the hash if we have a key and a signature. */
+        if (m_bl_info_pointers.p_ecdsa_public_key != NULL &&
+            m_transaction.signature_length != 0)
+        {
+            signature_hash_start();
+        }
+
         bl_evt_t abort_evt;
         abort_evt.type = BL_EVT_TYPE_TX_ABORT;
         abort_evt.params.tx.abort.tx_slot = TX_SLOT_BEACON;
@@ -630,6 +680,36 @@ static void start_target(void)
     }
 }
 
+/** Flash needed for the bank, including the area compressed transfers are received in. */
+static uint32_t bank_length(void)
+{
+    if (m_transaction.compressed_length == 0)
+    {
+        return m_transaction.length;
+    }
+    return PAGE_ALIGN(m_transaction.length + PAGE_SIZE - 1) + m_transaction.compressed_length;
+}
+
+/** Check whether a delta transfer can be rebuilt from the installed application. */
+static bool delta_transfer_is_possible(void)
+{
+    return (m_transaction.type == DFU_TYPE_APP &&
+            m_transaction.compressed_length >= sizeof(dfu_delta_header_t) &&
+            m_transaction.p_bank_addr != m_transaction.p_start_addr && /* the source is read while the bank is written */
+            (m_bl_info_pointers.p_flags == NULL || m_bl_info_pointers.p_flags->app_intact));
+}
+
+/** Check the delta header against the installed application before accepting any of the patch. */
+static bool delta_header_is_valid(dfu_delta_header_t* p_header)
+{
+    fwid_union_t source_fwid;
+    source_fwid.app = p_header->source_fwid;
+    return (fwid_union_cmp(&source_fwid, (fwid_union_t*) &m_bl_info_pointers.p_fwid->app, DFU_TYPE_APP) &&
+            p_header->source_length <= m_bl_info_pointers.p_segment_app->length &&
+            !section_overlap(m_bl_info_pointers.p_segment_app->start, p_header->source_length,
+                             (uint32_t) m_transaction.p_bank_addr, bank_length()));
+}
+
 static void start_rampdown(void)
 {
     bl_evt_t timer_evt;
@@ -673,6 +753,12 @@ static void target_rx_start(dfu_packet_t* p_packet, bool* p_do_relay)
     m_transaction.segment_count                     = segment_count;
     m_transaction.p_start_addr                      = (uint32_t*) start_address;
     m_transaction.length                            = p_packet->payload.start.length * 4;
+    m_transaction.compressed_length                 = 0;
+    if (p_packet->payload.start.compressed)
+    {
+        m_transaction.compressed_length             = p_packet->payload.start.compressed_length * 4;
+    }
+    m_transaction.delta                             = (p_packet->payload.start.compressed && p_packet->payload.start.diff);
     m_transaction.signature_length                  = p_packet->payload.start.signature_length;
     m_transaction.segment_is_valid_after_transfer   = p_packet->payload.start.last;
     m_transaction.p_last_requested_entry            = NULL;
@@ -697,7 +783,7 @@ static void target_rx_start(dfu_packet_t* p_packet, bool* p_do_relay)
             }
             /* Place bootloader bank at end of app section */
             m_transaction.p_bank_addr = (uint32_t*) (upper_limit -
-                    (m_transaction.length & ((uint32_t) ~(PAGE_SIZE - 1))) -
+                    (bank_length() & ((uint32_t) ~(PAGE_SIZE - 1))) -
                     (PAGE_SIZE));
         }
         else
@@ -709,7 +795,7 @@ static void target_rx_start(dfu_packet_t* p_packet, bool* p_do_relay)
     }
     else
     {
-        if ((uint32_t) m_transaction.p_bank_addr + m_transaction.length > BOOTLOADERADDR())
+        if ((uint32_t) m_transaction.p_bank_addr + bank_length() > BOOTLOADERADDR())
         {
             send_end_evt(DFU_END_ERROR_BANK_IN_BOOTLOADER_AREA);
             start_find_fwid();
@@ -719,7 +805,7 @@ static void target_rx_start(dfu_packet_t* p_packet, bool* p_do_relay)
     
     if (m_transaction.p_start_addr != m_transaction.p_bank_addr &&
         section_overlap((uint32_t) m_transaction.p_start_addr, m_transaction.length, 
-                        (uint32_t) m_transaction.p_bank_addr, m_transaction.length))
+                        (uint32_t) m_transaction.p_bank_addr, bank_length()))
     {
         send_end_evt(DFU_END_ERROR_BANK_AND_DESTINATION_OVERLAP);
         start_find_fwid();
@@ -733,9 +819,27 @@ static void target_rx_start(dfu_packet_t* p_packet, bool* p_do_relay)
     __LOG("\tbank addr:  0x%x\n", m_transaction.p_bank_addr);
     __LOG("\tlength:     %u\n", m_transaction.length);
     __LOG("\tsigned:     %s\n", m_transaction.signature_length > 0 ? "YES" : "NO");
+    __LOG("\tcompressed: %u\n", m_transaction.compressed_length);
+    __LOG("\tdelta:      %s\n", m_transaction.delta ? "YES" : "NO");
+
+    if ((p_packet->payload.start.diff && !m_transaction.delta) ||
+        (m_transaction.delta && !delta_transfer_is_possible()))
+    {
+        __LOG(RTT_CTRL_TEXT_RED "ERROR: Can't rebuild delta transfer from the installed application.\n");
+        tid_cache_entry_put(p_packet->payload.start.transaction_id);
+        start_req(m_transaction.type, &m_transaction.target_fwid_union);
+        return;
+    }
+
+    /* single banked transfers receive the compressed stream inside the section */
+    uint32_t section_length = m_transaction.length;
+    if (m_transaction.p_start_addr == m_transaction.p_bank_addr)
+    {
+        section_length = bank_length();
+    }
 
     if ((uint32_t) m_transaction.p_start_addr >= p_segment->start &&
-        (uint32_t) m_transaction.p_start_addr + m_transaction.length <= p_segment->start + p_segment->length)
+        (uint32_t) m_transaction.p_start_addr + section_length <= p_segment->start + p_segment->length)
     {
         start_target();
         *p_do_relay = true;
@@ -748,7 +852,90 @@ static void target_rx_start(dfu_packet_t* p_packet, bool* p_do_relay)
     }
 }
 
-static uint32_t target_rx_data(dfu_packet_t* p_packet, uint16_t length, bool* p_do_relay)
+static uint16_t data_segment_count(void)
+{
+    return m_transaction.segment_count - m_transaction.signature_length / SEGMENT_LENGTH;
+}
+
+/** Add a data segment to the parity of its block, and send a repair segment once the block is complete. */
+static void repair_segment_add(uint16_t segment, uint8_t* p_data, uint32_t data_length)
+{
+#if DFU_REPAIR_BLOCK_SIZE > 0
+    uint16_t first_segment = segment - ((segment - 1) % DFU_REPAIR_BLOCK_SIZE);
+    if (first_segment != m_repair_block.first_segment)
+    {
+        m_repair_block.first_segment = first_segment;
+        m_repair_block.segment_count = 0;
+        memset(m_repair_block.parity, 0, SEGMENT_LENGTH);
+    }
+
+    /* pad short segments the way they look in erased flash. */
+    for (uint32_t i = 0; i < SEGMENT_LENGTH; ++i)
+    {
+        m_repair_block.parity[i] ^= (i < data_length) ? p_data[i] : 0xFF;
+    }
+
+    uint16_t block_size = DFU_REPAIR_BLOCK_SIZE;
+    if (first_segment + block_size - 1 > data_segment_count())
+    {
+        block_size = data_segment_count() - first_segment + 1;
+    }
+
+    if (++m_repair_block.segment_count == block_size)
+    {
+        dfu_packet_t repair_packet;
+        repair_packet.packet_type = DFU_PACKET_TYPE_DATA_REPAIR;
+        repair_packet.payload.repair_data.segment = first_segment;
+        repair_packet.payload.repair_data.transaction_id = m_transaction.transaction_id;
+        repair_packet.payload.repair_data.block_size = block_size;
+        memcpy(repair_packet.payload.repair_data.data, m_repair_block.parity, SEGMENT_LENGTH);
+
+        packet_tx_dynamic(&repair_packet, DFU_PACKET_LEN_DATA_REPAIR, TX_INTERVAL_TYPE_DATA, TX_REPEATS_DATA);
+        packet_cache_put(&repair_packet);
+        __LOG("TX REPAIR FOR 0x%x-0x%x\n", first_segment, first_segment + block_size - 1);
+    }
+#endif
+}
+
+static void target_rx_repair(dfu_packet_t* p_packet)
+{
+    uint16_t first_segment = p_packet->payload.repair_data.segment;
+    uint16_t block_size = p_packet->payload.repair_data.block_size;
+
+    if (first_segment == 0 ||
+        block_size == 0 ||
+        first_segment + block_size - 1 > data_segment_count())
+    {
+        return;
+    }
+
+    /* the delta header must be checked before it's written, leave it to the data requests. */
+    if (m_transaction.delta &&
+        first_segment == 1 &&
+        !dfu_transfer_has_entry(m_transaction.p_start_addr, NULL, 0))
+    {
+        return;
+    }
+
+    uint32_t* p_repaired_addr = NULL;
+    if (dfu_transfer_repair(
+                addr_from_seg(first_segment, m_transaction.p_start_addr),
+                block_size,
+                p_packet->payload.repair_data.data,
+                &p_repaired_addr) == NRF_SUCCESS)
+    {
+        uint16_t segment = ADDR_SEGMENT(p_repaired_addr, m_transaction.p_start_addr);
+        __LOG("Repaired segment #%u\n", segment);
+        if (m_data_req_segment == segment)
+        {
+            m_data_req_segment = DATA_REQ_SEGMENT_NONE;
+        }
+        send_progress_event(segment, m_transaction.segment_count);
+        m_transaction.segments_remaining--;
+    }
+}
+
+static uint32_t target_rx_data(dfu_packet_t* p_packet, uint16_t length, bool from_serial, bool* p_do_relay)
 {
     uint32_t* p_addr = NULL;
     uint32_t error_code = NRF_ERROR_NULL;
@@ -760,10 +947,30 @@ static uint32_t target_rx_data(dfu_packet_t* p_packet, uint16_t length, bool* p_
         {
             m_data_req_segment = DATA_REQ_SEGMENT_NONE;
         }
+        if (m_transaction.delta &&
+            p_packet->payload.data.segment == 1 &&
+            (length < DFU_PACKET_LEN_DATA ||
+             !delta_header_is_valid((dfu_delta_header_t*) p_packet->payload.data.data)))
+        {
+            __LOG(RTT_CTRL_TEXT_RED "ERROR: Delta transfer doesn't apply to the installed application.\n");
+            tid_cache_entry_put(m_transaction.transaction_id);
+            dfu_transfer_end();
+            send_end_evt(DFU_END_ERROR_INVALID_DELTA_SOURCE);
+            start_find_fwid();
+            return NRF_ERROR_INVALID_DATA;
+        }
         p_addr = addr_from_seg(p_packet->payload.data.segment, m_transaction.p_start_addr);
         error_code = dfu_transfer_data((uint32_t) p_addr,
                 p_packet->payload.data.data,
                 length - (DFU_PACKET_LEN_DATA - SEGMENT_LENGTH));
+
+        /* the device feeding the transfer into the mesh protects it with repair segments. */
+        if (error_code == NRF_SUCCESS && from_serial)
+        {
+            repair_segment_add(p_packet->payload.data.segment,
+                    p_packet->payload.data.data,
+                    length - (DFU_PACKET_LEN_DATA - SEGMENT_LENGTH));
+        }
     }
     else /* treat signature packets at the end */
     {
@@ -824,7 +1031,7 @@ static uint32_t target_rx_data(dfu_packet_t* p_packet, uint16_t length, bool* p_
     return error_code;
 }
 
-static void handle_data_packet(dfu_packet_t* p_packet, uint16_t length)
+static void handle_data_packet(dfu_packet_t* p_packet, uint16_t length, bool from_serial)
 {
     if (p_packet->payload.data.transaction_id != m_transaction.transaction_id)
     {
@@ -834,6 +1041,12 @@ static void handle_data_packet(dfu_packet_t* p_packet, uint16_t length)
     {
         return;
     }
+    if (p_packet->payload.start.segment == 0 &&
+        !start_packet_length_is_valid(p_packet, length))
+    {
+        __LOG(RTT_CTRL_TEXT_RED "ERROR: Start packet too short.\n");
+        return;
+    }
     
     bool do_relay = false;
 
@@ -856,7 +1069,7 @@ static void handle_data_packet(dfu_packet_t* p_packet, uint16_t length)
             if (p_packet->payload.data.segment > 0 &&
                 p_packet->payload.data.segment <= m_transaction.segment_count)
             {
-                target_rx_data(p_packet, length, &do_relay);
+                target_rx_data(p_packet, length, from_serial, &do_relay);
             }
 
             /* ending the DFU */
@@ -1121,7 +1334,41 @@ static void handle_data_rsp_packet(dfu_packet_t* p_packet, uint16_t length)
     }
     else
     {
-        handle_data_packet(p_packet, length);
+        handle_data_packet(p_packet, length, false);
+    }
+}
+
+static void handle_data_repair_packet(dfu_packet_t* p_packet, uint16_t length)
+{
+    if (length < DFU_PACKET_LEN_DATA_REPAIR ||
+        p_packet->payload.repair_data.transaction_id != m_transaction.transaction_id)
+    {
+        return;
+    }
+    if (packet_in_cache(p_packet))
+    {
+        return;
+    }
+
+    switch (m_state)
+    {
+        case DFU_STATE_TARGET:
+            target_rx_repair(p_packet);
+
+            /* ending the DFU */
+            if (m_transaction.segments_remaining == 0)
+            {
+                start_rampdown();
+            }
+            relay_packet(p_packet, length);
+            break;
+
+        case DFU_STATE_RELAY:
+            relay_packet(p_packet, length);
+            break;
+
+        default:
+            break;
     }
 }
 
@@ -1235,7 +1482,7 @@ uint32_t dfu_mesh_rx(dfu_packet_t* p_packet, uint16_t length, bool from_serial)
             break;
 
         case DFU_PACKET_TYPE_DATA:
-            handle_data_packet(p_packet, length);
+            handle_data_packet(p_packet, length, from_serial);
             break;
 
         case DFU_PACKET_TYPE_DATA_REQ:
@@ -1246,6 +1493,10 @@ uint32_t dfu_mesh_rx(dfu_packet_t* p_packet, uint16_t length, bool from_serial)
             handle_data_rsp_packet(p_packet, length);
             break;
 
+        case DFU_PACKET_TYPE_DATA_REPAIR:
+            handle_data_repair_packet(p_packet, length);
+            break;
+
         default:
             /* don't care */
             break;
@@ -1272,7 +1523,12 @@ void dfu_mesh_timeout(void)
             break;
 
         case DFU_STATE_VALIDATE:
-            if (signature_check())
+            if (!dfu_transfer_is_complete())
+            {
+                /* still decompressing, check again later. */
+                start_rampdown();
+            }
+            else if (signature_check())
             {
                 dfu_mesh_finalize();
             }
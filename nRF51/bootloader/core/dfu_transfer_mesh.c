@@ -43,13 +43,22 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 * Local defines
 *****************************************************************************/
 #define INVALID_SEGMENT_INDEX   (0xFFFF)
-#define MISSING_BITFIELD_WIDTH  (64ULL)
+#define MISSING_GAPS_MAX        (32)
+#define DECOMPRESS_BUFFER_SIZE  (4 * SEGMENT_LENGTH)
+
+#define LZ_MATCH_LENGTH_MIN     (3)
+#define LZ_SOURCE_OFFSET_BYTES  (3)
 
 /*****************************************************************************
 * Local typedefs
 *****************************************************************************/
 
-typedef uint64_t bitfield_t;
+/** Range of consecutive missing segments, both ends inclusive. */
+typedef struct
+{
+    uint16_t first;
+    uint16_t last;
+} segment_gap_t;
 
 typedef struct
 {
@@ -59,16 +68,63 @@ typedef struct
     bool            final_transfer;
     uint32_t        size;
     uint32_t*       p_write_pointer;
-    bitfield_t      missing_segments;
-    uint8_t         write_buffer[SEGMENT_LENGTH];
+    sha256_context_t* p_hash_context; /**< Context the image is hashed into as it's written, or NULL. */
+    uint32_t        hashed_length;  /**< Number of bytes of the image in the hash context. */
+    segment_gap_t   gaps[MISSING_GAPS_MAX]; /**< Missing segments below segment_max, in ascending order. */
+    uint32_t        write_buffer[SEGMENT_LENGTH / 4]; /**< Word aligned, flash_write() requires it. */
     uint16_t        segment_max;
     uint16_t        segment_prev;
+    uint8_t         gap_count;
 } dfu_transfer_t;
 
+typedef enum
+{
+    LZ_STATE_HEADER,    /**< Expecting the delta header. */
+    LZ_STATE_FLAGS,     /**< Expecting a flag byte. */
+    LZ_STATE_ITEM,      /**< Expecting a literal, or the first byte of a match. */
+    LZ_STATE_MATCH,     /**< Expecting the second byte of a match. */
+    LZ_STATE_SOURCE,    /**< Expecting the rest of a source copy. */
+    LZ_STATE_COPY       /**< Copying a match to the output. */
+} lz_state_t;
+
+/**
+ * Streaming decompression of compressed transfers. The compressed stream is
+ * LZSS: a flag byte precedes every 8 items, and each flag bit (LSB first)
+ * marks the item as a literal byte (1) or a 2-byte match (0). A match holds
+ * the distance back into the output minus 1 in its lower 12 bits (first byte
+ * and upper nibble of the second), and the length minus 3 in the lower nibble
+ * of the second byte. Matches read the output from the bank, so the only RAM
+ * needed is the output buffer.
+ *
+ * Delta transfers start the stream with a dfu_delta_header_t, and replace
+ * the matches with 4-byte source copies: a 24-bit offset into the installed
+ * application, followed by the length minus 3.
+ */
+typedef struct
+{
+    uint8_t*        p_out_addr;     /**< Start of the decompressed image in the bank. */
+    const uint8_t*  p_source_addr;  /**< Start of the installed application. NULL if the transfer isn't a delta. */
+    uint32_t        source_length;  /**< Number of bytes the delta may copy from the installed application. */
+    uint32_t        out_size;       /**< Size of the decompressed image. 0 if the transfer isn't compressed. */
+    uint32_t        out_length;     /**< Number of bytes decompressed so far. */
+    uint32_t        out_flushed;    /**< Number of decompressed bytes written to the bank. */
+    uint32_t        in_offset;      /**< Number of bytes consumed from the compressed stream. */
+    uint8_t         out_buffer[DECOMPRESS_BUFFER_SIZE];
+    lz_state_t      state;
+    uint8_t         flags;
+    uint8_t         flag_count;
+    uint16_t        match_distance;
+    uint16_t        match_length;
+    uint32_t        source_offset;
+    uint8_t         source_offset_bytes;
+    bool            write_pending;
+} decompress_t;
+
 /*****************************************************************************
 * Static globals
 *****************************************************************************/
 static dfu_transfer_t m_transfer;
+static decompress_t m_decompress;
 
 /*****************************************************************************
 * Static functions
@@ -80,17 +136,269 @@ static void transfer_abort(dfu_end_t end_reason)
     send_end_evt(end_reason);
 }
 
+static segment_gap_t* gap_find(uint16_t segment)
+{
+    for (uint32_t i = 0; i < m_transfer.gap_count; ++i)
+    {
+        if (segment < m_transfer.gaps[i].first)
+        {
+            break;
+        }
+        if (segment <= m_transfer.gaps[i].last)
+        {
+            return &m_transfer.gaps[i];
+        }
+    }
+    return NULL;
+}
+
+static void gap_segment_remove(segment_gap_t* p_gap, uint16_t segment)
+{
+    segment_gap_t* p_gaps_end = &m_transfer.gaps[m_transfer.gap_count];
+    if (p_gap->first == p_gap->last)
+    {
+        memmove(p_gap, p_gap + 1, (p_gaps_end - (p_gap + 1)) * sizeof(segment_gap_t));
+        m_transfer.gap_count--;
+    }
+    else if (segment == p_gap->first)
+    {
+        p_gap->first++;
+    }
+    else if (segment == p_gap->last)
+    {
+        p_gap->last--;
+    }
+    else
+    {
+        /* split the gap in two, the caller has ensured that there's room. */
+        memmove(p_gap + 1, p_gap, (p_gaps_end - p_gap) * sizeof(segment_gap_t));
+        p_gap->last = segment - 1;
+        (p_gap + 1)->first = segment + 1;
+        m_transfer.gap_count++;
+    }
+}
+
 static bool segment_is_missing(uint16_t segment)
 {
     if (segment > m_transfer.segment_max)
     {
         return true;
     }
-    if (m_transfer.segment_max - segment > MISSING_BITFIELD_WIDTH)
+    return (gap_find(segment) != NULL);
+}
+
+static uint32_t contiguous_bytes_available(void)
+{
+    /* everything before the first missing segment is in flash, unless it's
+     * still being written. */
+    uint16_t segment = m_transfer.segment_max + 1;
+    if (m_transfer.gap_count > 0)
     {
-        return false;
+        segment = m_transfer.gaps[0].first;
     }
-    return !!((1ULL << (m_transfer.segment_max - segment)) & m_transfer.missing_segments);
+    if (m_transfer.segment_prev < segment)
+    {
+        segment = m_transfer.segment_prev;
+    }
+    uint32_t available = SEGMENT_ADDR(segment, m_transfer.p_start_addr) - (uint32_t) m_transfer.p_start_addr;
+    if (available > m_transfer.size)
+    {
+        available = m_transfer.size;
+    }
+    return available;
+}
+
+/** Hash the part of the image that's in flash without gaps, so it doesn't have to be hashed when the transfer ends. */
+static void hash_run(void)
+{
+    if (m_transfer.p_hash_context == NULL ||
+        m_transfer.segment_max == INVALID_SEGMENT_INDEX)
+    {
+        return;
+    }
+    const uint8_t* p_image = (const uint8_t*) m_transfer.p_bank_addr;
+    uint32_t length = contiguous_bytes_available();
+    if (m_decompress.out_size > 0)
+    {
+        p_image = m_decompress.p_out_addr;
+        length = m_decompress.out_flushed;
+    }
+    if (length > m_transfer.hashed_length)
+    {
+        sha256_update(m_transfer.p_hash_context,
+                (uint8_t*) &p_image[m_transfer.hashed_length],
+                length - m_transfer.hashed_length);
+        m_transfer.hashed_length = length;
+    }
+}
+
+static void decompress_flush(void)
+{
+    if (flash_write(
+            (void*) (m_decompress.p_out_addr + m_decompress.out_flushed),
+            m_decompress.out_buffer,
+            m_decompress.out_length - m_decompress.out_flushed) != NRF_SUCCESS)
+    {
+        transfer_abort(DFU_END_ERROR_NO_MEM);
+        return;
+    }
+    m_decompress.write_pending = true;
+}
+
+static void decompress_output(uint8_t byte)
+{
+    m_decompress.out_buffer[m_decompress.out_length - m_decompress.out_flushed] = byte;
+    m_decompress.out_length++;
+}
+
+static uint8_t decompress_history(uint16_t distance)
+{
+    uint32_t position = m_decompress.out_length - distance;
+    if (position >= m_decompress.out_flushed)
+    {
+        return m_decompress.out_buffer[position - m_decompress.out_flushed];
+    }
+    return m_decompress.p_out_addr[position];
+}
+
+static void decompress_item_done(void)
+{
+    m_decompress.state = (m_decompress.flag_count == 0) ? LZ_STATE_FLAGS : LZ_STATE_ITEM;
+}
+
+/** Decompress as much of the received stream as possible, stopping when the output buffer needs flushing. */
+static void decompress_run(void)
+{
+    if (m_decompress.out_size == 0 ||
+        m_decompress.write_pending ||
+        m_decompress.out_flushed == m_decompress.out_size ||
+        m_transfer.segment_max == INVALID_SEGMENT_INDEX)
+    {
+        return;
+    }
+
+    const uint8_t* p_in = (const uint8_t*) m_transfer.p_bank_addr;
+    uint32_t in_available = contiguous_bytes_available();
+
+    while (m_decompress.out_length < m_decompress.out_size)
+    {
+        if (m_decompress.out_length - m_decompress.out_flushed == DECOMPRESS_BUFFER_SIZE)
+        {
+            decompress_flush();
+            return;
+        }
+
+        if (m_decompress.state == LZ_STATE_COPY)
+        {
+            if (m_decompress.p_source_addr != NULL)
+            {
+                decompress_output(m_decompress.p_source_addr[m_decompress.source_offset++]);
+            }
+            else
+            {
+                decompress_output(decompress_history(m_decompress.match_distance));
+            }
+            if (--m_decompress.match_length == 0)
+            {
+                decompress_item_done();
+            }
+            continue;
+        }
+
+        if (m_decompress.in_offset == in_available)
+        {
+            if (in_available == m_transfer.size)
+            {
+                /* the stream ended before the image was complete. */
+                transfer_abort(DFU_END_ERROR_INVALID_TRANSFER);
+            }
+            return;
+        }
+
+        if (m_decompress.state == LZ_STATE_HEADER)
+        {
+            /* The source FWID has already been checked by the DFU module, we
+             * only need the length. */
+            if (in_available < m_decompress.in_offset + sizeof(dfu_delta_header_t))
+            {
+                if (in_available == m_transfer.size)
+                {
+                    transfer_abort(DFU_END_ERROR_INVALID_TRANSFER);
+                }
+                return;
+            }
+            m_decompress.source_length = ((const dfu_delta_header_t*) p_in)->source_length;
+            m_decompress.in_offset += sizeof(dfu_delta_header_t);
+            m_decompress.state = LZ_STATE_FLAGS;
+            continue;
+        }
+
+        uint8_t byte = p_in[m_decompress.in_offset++];
+        switch (m_decompress.state)
+        {
+            case LZ_STATE_FLAGS:
+                m_decompress.flags = byte;
+                m_decompress.flag_count = 8;
+                m_decompress.state = LZ_STATE_ITEM;
+                break;
+
+            case LZ_STATE_ITEM:
+                m_decompress.flag_count--;
+                if (m_decompress.flags & 0x01)
+                {
+                    decompress_output(byte);
+                    decompress_item_done();
+                }
+                else if (m_decompress.p_source_addr != NULL)
+                {
+                    m_decompress.source_offset = byte;
+                    m_decompress.source_offset_bytes = 1;
+                    m_decompress.state = LZ_STATE_SOURCE;
+                }
+                else
+                {
+                    m_decompress.match_distance = byte;
+                    m_decompress.state = LZ_STATE_MATCH;
+                }
+                m_decompress.flags >>= 1;
+                break;
+
+            case LZ_STATE_MATCH:
+                m_decompress.match_distance |= ((uint16_t) (byte & 0xF0)) << 4;
+                m_decompress.match_distance += 1;
+                m_decompress.match_length = (byte & 0x0F) + LZ_MATCH_LENGTH_MIN;
+                if (m_decompress.match_distance > m_decompress.out_length ||
+                    m_decompress.out_length + m_decompress.match_length > m_decompress.out_size)
+                {
+                    transfer_abort(DFU_END_ERROR_INVALID_TRANSFER);
+                    return;
+                }
+                m_decompress.state = LZ_STATE_COPY;
+                break;
+
+            case LZ_STATE_SOURCE:
+                if (m_decompress.source_offset_bytes < LZ_SOURCE_OFFSET_BYTES)
+                {
+                    m_decompress.source_offset |= ((uint32_t) byte) << (8 * m_decompress.source_offset_bytes);
+                    m_decompress.source_offset_bytes++;
+                    break;
+                }
+                m_decompress.match_length = byte + LZ_MATCH_LENGTH_MIN;
+                if (m_decompress.source_offset + m_decompress.match_length > m_decompress.source_length ||
+                    m_decompress.out_length + m_decompress.match_length > m_decompress.out_size)
+                {
+                    transfer_abort(DFU_END_ERROR_INVALID_TRANSFER);
+                    return;
+                }
+                m_decompress.state = LZ_STATE_COPY;
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    decompress_flush();
 }
 
 /*****************************************************************************
@@ -99,6 +407,7 @@ static bool segment_is_missing(uint16_t segment)
 void dfu_transfer_init(void)
 {
     memset(&m_transfer, 0, sizeof(dfu_transfer_t));
+    memset(&m_decompress, 0, sizeof(decompress_t));
     m_transfer.segment_max = INVALID_SEGMENT_INDEX;
 }
 
@@ -106,10 +415,11 @@ uint32_t dfu_transfer_start(
         uint32_t* p_start_addr,
         uint32_t* p_bank_addr,
         uint32_t size,
+        uint32_t compressed_size,
+        uint32_t* p_delta_source_addr,
         bool final_transfer)
 {
     dfu_transfer_init();
-    uint16_t segment_count = (((size + (uint32_t) p_start_addr) & 0xFFFFFFF0) - ((uint32_t) p_start_addr & 0xFFFFFFF0)) / 16;
 
     if (PAGE_OFFSET(p_start_addr) != 0 ||
         PAGE_OFFSET(p_bank_addr) != 0)
@@ -126,16 +436,35 @@ uint32_t dfu_transfer_start(
         m_transfer.p_bank_addr = p_bank_addr;
     }
 
+    uint32_t* p_erase_addr = m_transfer.p_bank_addr;
+    uint32_t erase_length = PAGE_ALIGN(size + PAGE_SIZE - 1);
+    if (compressed_size > 0)
+    {
+        /* Keep the compressed stream in the pages after the bank, and
+         * decompress it into the bank as it comes in. */
+        m_decompress.p_out_addr = (uint8_t*) m_transfer.p_bank_addr;
+        m_decompress.out_size = size;
+        m_decompress.state = LZ_STATE_FLAGS;
+        if (p_delta_source_addr != NULL)
+        {
+            m_decompress.p_source_addr = (const uint8_t*) p_delta_source_addr;
+            m_decompress.state = LZ_STATE_HEADER;
+        }
+        m_transfer.p_bank_addr = (uint32_t*) ((uint32_t) m_transfer.p_bank_addr + erase_length);
+        erase_length += PAGE_ALIGN(compressed_size + PAGE_SIZE - 1);
+        size = compressed_size;
+    }
+
     /* erase all affected pages. */
-    flash_erase((uint32_t*) PAGE_ALIGN(m_transfer.p_bank_addr),
-                            PAGE_ALIGN(size + PAGE_SIZE - 1));
+    flash_erase((uint32_t*) PAGE_ALIGN(p_erase_addr), erase_length);
 
+    uint16_t segment_count = (((size + (uint32_t) p_start_addr) & 0xFFFFFFF0) - ((uint32_t) p_start_addr & 0xFFFFFFF0)) / 16;
     m_transfer.p_start_addr = p_start_addr;
     m_transfer.segment_count = segment_count;
     m_transfer.final_transfer = final_transfer;
     m_transfer.p_write_pointer = m_transfer.p_start_addr;
     m_transfer.size = size;
-    m_transfer.missing_segments = 0;
+    m_transfer.gap_count = 0;
     m_transfer.segment_prev = INVALID_SEGMENT_INDEX;
     m_transfer.segment_max = 0;
     return NRF_SUCCESS;
@@ -172,22 +501,35 @@ uint32_t dfu_transfer_data(uint32_t p_addr, uint8_t* p_data, uint16_t length)
 
     if (segment > m_transfer.segment_max)
     {
-        /* Ensure that we don't shift out any set bits: Mask the shift on the
-         * MSB side (ie only look at the part that will overflow), and check
-         * whether there are any bits set in that section. */
-        uint16_t segment_offset = segment - m_transfer.segment_max;
-        bitfield_t shift_mask = (1ULL << segment_offset) - 1ULL;
-        if (m_transfer.missing_segments & (shift_mask << (MISSING_BITFIELD_WIDTH - segment_offset)))
+        /* All segments we skipped are considered missing, and are kept as a
+         * new gap until they're filled through data requests. If we can't
+         * keep track of any more gaps, drop the segment and fall behind
+         * instead, we'll request it once the existing gaps are filled. */
+        if (segment > m_transfer.segment_max + 1)
         {
-            transfer_abort(DFU_END_ERROR_PACKET_LOSS);
-            return NRF_ERROR_NOT_FOUND;
+            if (m_transfer.gap_count == MISSING_GAPS_MAX)
+            {
+                return NRF_ERROR_NO_MEM;
+            }
+            m_transfer.gaps[m_transfer.gap_count].first = m_transfer.segment_max + 1;
+            m_transfer.gaps[m_transfer.gap_count].last = segment - 1;
+            m_transfer.gap_count++;
         }
-        /* Offset the bitfield to match the new segment_max, and set all bits
-         * that we skipped to 1, as they're considered missing. */
-        m_transfer.missing_segments = (m_transfer.missing_segments << segment_offset) | shift_mask;
-        m_transfer.missing_segments &= ~1ULL; /* The newest segment isn't missing. */
         m_transfer.segment_max = segment;
     }
+    else
+    {
+        /* Filling the middle of a gap splits it. If there's no room for
+         * another gap, drop the segment, it will be requested again once the
+         * gap has shrunk from its edges. */
+        segment_gap_t* p_gap = gap_find(segment);
+        if (segment != p_gap->first &&
+            segment != p_gap->last &&
+            m_transfer.gap_count == MISSING_GAPS_MAX)
+        {
+            return NRF_ERROR_NO_MEM;
+        }
+    }
 
     m_transfer.segment_prev = segment;
     memcpy(m_transfer.write_buffer, p_data, length);
@@ -234,47 +576,170 @@ bool dfu_transfer_get_oldest_missing_entry(
     {
         return false;
     }
-    for (int32_t i = 63; i >= 0; i--)
+    for (uint32_t i = 0; i < m_transfer.gap_count; ++i)
     {
-        if (m_transfer.missing_segments & (1ULL << i))
+        uint16_t segment = m_transfer.gaps[i].first;
+        if (SEGMENT_ADDR(segment, m_transfer.p_start_addr) < (uint32_t) p_start_addr)
         {
-            uint16_t segment = m_transfer.segment_max - i;
-            uint32_t addr = SEGMENT_ADDR(segment, m_transfer.p_start_addr);
-            if (addr >= (uint32_t) p_start_addr)
+            /* skip to the first segment in the gap at or after the given address. */
+            segment = ADDR_SEGMENT(p_start_addr, m_transfer.p_start_addr);
+            if (SEGMENT_ADDR(segment, m_transfer.p_start_addr) < (uint32_t) p_start_addr)
+            {
+                segment++;
+            }
+            if (segment > m_transfer.gaps[i].last)
             {
-                *pp_entry = (uint32_t*) addr;
-                *p_len = SEGMENT_LENGTH;
-                return true;
+                continue;
             }
         }
+        *pp_entry = (uint32_t*) SEGMENT_ADDR(segment, m_transfer.p_start_addr);
+        *p_len = SEGMENT_LENGTH;
+        return true;
+    }
+
+    /* no gaps left, but we may have fallen behind the transfer. */
+    uint32_t next_addr = SEGMENT_ADDR(m_transfer.segment_max + 1, m_transfer.p_start_addr);
+    if (next_addr < (uint32_t) m_transfer.p_start_addr + m_transfer.size &&
+        next_addr >= (uint32_t) p_start_addr)
+    {
+        *pp_entry = (uint32_t*) next_addr;
+        *p_len = SEGMENT_LENGTH;
+        return true;
     }
     return false;
 }
 
+uint32_t dfu_transfer_repair(
+        uint32_t* p_block_addr,
+        uint16_t segments,
+        uint8_t* p_parity,
+        uint32_t** pp_repaired_addr)
+{
+    if (m_transfer.segment_max == INVALID_SEGMENT_INDEX)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    /* All other segments in the block must be in flash. */
+    if (m_transfer.segment_prev != INVALID_SEGMENT_INDEX)
+    {
+        return NRF_ERROR_BUSY;
+    }
+
+    uint16_t first_segment = ADDR_SEGMENT(p_block_addr, m_transfer.p_start_addr);
+    uint16_t missing_segment = INVALID_SEGMENT_INDEX;
+    for (uint16_t segment = first_segment; segment < first_segment + segments; ++segment)
+    {
+        if (segment_is_missing(segment))
+        {
+            if (missing_segment != INVALID_SEGMENT_INDEX)
+            {
+                /* the parity can only restore a single segment. */
+                return NRF_ERROR_NOT_FOUND;
+            }
+            missing_segment = segment;
+        }
+    }
+    if (missing_segment == INVALID_SEGMENT_INDEX)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    /* XOR the parity with the segments we have. Any part of a segment beyond
+     * the end of the transfer reads as erased flash, the same padding the
+     * source uses when calculating the parity. */
+    uint8_t segment_data[SEGMENT_LENGTH];
+    memcpy(segment_data, p_parity, SEGMENT_LENGTH);
+    for (uint16_t segment = first_segment; segment < first_segment + segments; ++segment)
+    {
+        if (segment != missing_segment)
+        {
+            uint8_t* p_bank_segment = (uint8_t*) ((uint32_t) m_transfer.p_bank_addr +
+                (SEGMENT_ADDR(segment, m_transfer.p_start_addr) - (uint32_t) m_transfer.p_start_addr));
+            for (uint32_t i = 0; i < SEGMENT_LENGTH; ++i)
+            {
+                segment_data[i] ^= p_bank_segment[i];
+            }
+        }
+    }
+
+    uint32_t addr = SEGMENT_ADDR(missing_segment, m_transfer.p_start_addr);
+    uint32_t length = (uint32_t) m_transfer.p_start_addr + m_transfer.size - addr;
+    if (length > SEGMENT_LENGTH)
+    {
+        length = SEGMENT_LENGTH;
+    }
+    *pp_repaired_addr = (uint32_t*) addr;
+    return dfu_transfer_data(addr, segment_data, length);
+}
+
+uint32_t dfu_transfer_sha256_start(sha256_context_t* p_hash_context)
+{
+    if (m_transfer.segment_max == INVALID_SEGMENT_INDEX)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_transfer.p_hash_context = p_hash_context;
+    m_transfer.hashed_length = 0;
+    hash_run();
+    return NRF_SUCCESS;
+}
+
 uint32_t dfu_transfer_sha256(sha256_context_t* p_hash_context)
 {
     if (m_transfer.segment_max == INVALID_SEGMENT_INDEX)
     {
         return NRF_ERROR_INVALID_STATE;
     }
+    uint8_t* p_image = (uint8_t*) m_transfer.p_bank_addr;
+    uint32_t length = m_transfer.size;
+    if (m_decompress.out_size > 0)
+    {
+        p_image = m_decompress.p_out_addr;
+        length = m_decompress.out_size;
+    }
+    /* only hash what hasn't been hashed as it came in. */
+    uint32_t hashed_length = 0;
+    if (p_hash_context == m_transfer.p_hash_context)
+    {
+        hashed_length = m_transfer.hashed_length;
+        m_transfer.p_hash_context = NULL;
+    }
     return sha256_update(p_hash_context,
-                  (uint8_t*) m_transfer.p_bank_addr,
-                  m_transfer.size);
+                  &p_image[hashed_length],
+                  length - hashed_length);
+}
+
+bool dfu_transfer_is_complete(void)
+{
+    return (m_decompress.out_flushed == m_decompress.out_size);
 }
 
 void dfu_transfer_end(void)
 {
     memset(&m_transfer, 0, sizeof(m_transfer));
+    memset(&m_decompress, 0, sizeof(m_decompress));
     m_transfer.segment_max = INVALID_SEGMENT_INDEX;
 }
 
 void dfu_transfer_flash_write_complete(uint8_t* p_write_src)
 {
-    if (p_write_src == m_transfer.write_buffer)
+    if (p_write_src == (uint8_t*) m_transfer.write_buffer)
     {
-        uint32_t offset = m_transfer.segment_max - m_transfer.segment_prev;
-        m_transfer.missing_segments &= ~(1 << offset);
+        segment_gap_t* p_gap = gap_find(m_transfer.segment_prev);
+        if (p_gap != NULL)
+        {
+            gap_segment_remove(p_gap, m_transfer.segment_prev);
+        }
         m_transfer.segment_prev = INVALID_SEGMENT_INDEX;
+        decompress_run();
+        hash_run();
+    }
+    else if (p_write_src == m_decompress.out_buffer)
+    {
+        m_decompress.out_flushed = m_decompress.out_length;
+        m_decompress.write_pending = false;
+        hash_run();
+        decompress_run();
     }
 }
 
@@ -40,6 +40,8 @@ uint32_t dfu_transfer_start(
         uint32_t* p_start_addr,
         uint32_t* p_bank_addr,
         uint32_t size,
+        uint32_t compressed_size,
+        uint32_t* p_delta_source_addr,
         bool final_transfer);
 
 uint32_t dfu_transfer_data(uint32_t p_addr, uint8_t* p_data, uint16_t length);
@@ -51,8 +53,18 @@ bool dfu_transfer_get_oldest_missing_entry(
         uint32_t** pp_entry,
         uint32_t* p_len);
 
+uint32_t dfu_transfer_repair(
+        uint32_t* p_block_addr,
+        uint16_t segments,
+        uint8_t* p_parity,
+        uint32_t** pp_repaired_addr);
+
+uint32_t dfu_transfer_sha256_start(sha256_context_t* p_hash_context);
+
 uint32_t dfu_transfer_sha256(sha256_context_t* p_hash_context);
 
+bool dfu_transfer_is_complete(void);
+
 void dfu_transfer_end(void);
 
 void dfu_transfer_flash_write_complete(uint8_t* p_write_src);
@@ -0,0 +1,101 @@
+import sys
+
+# LZSS format decoded by the bootloader, see dfu_transfer_mesh.c:
+# A flag byte precedes every 8 items, where each bit (LSB first) marks the
+# item as a literal byte (1) or a 2-byte match (0). A match holds the distance
+# back into the output minus 1 in 12 bits (first byte, then the upper nibble of
+# the second byte), and the length minus 3 in the lower nibble of the second
+# byte.
+DISTANCE_MAX = 4096
+LENGTH_MIN = 3
+LENGTH_MAX = 18
+CHAIN_MAX = 256
+
+def find_match(data, pos, chains):
+    key = bytes(data[pos:pos + LENGTH_MIN])
+    best_length = 0
+    best_distance = 0
+    candidates = chains.get(key, [])
+    for candidate in reversed(candidates[-CHAIN_MAX:]):
+        distance = pos - candidate
+        if distance > DISTANCE_MAX:
+            break
+        length = LENGTH_MIN
+        while (length < LENGTH_MAX and pos + length < len(data) and
+               data[candidate + length] == data[pos + length]):
+            length += 1
+        if length > best_length:
+            best_length = length
+            best_distance = distance
+            if length == LENGTH_MAX:
+                break
+    return best_length, best_distance
+
+def compress(data):
+    out = bytearray()
+    chains = {}
+    pos = 0
+    while pos < len(data):
+        flag_index = len(out)
+        out.append(0)
+        for bit in range(8):
+            if pos >= len(data):
+                break
+            length = 0
+            if pos + LENGTH_MIN <= len(data):
+                length, distance = find_match(data, pos, chains)
+            if length >= LENGTH_MIN:
+                out.append((distance - 1) & 0xFF)
+                out.append((((distance - 1) >> 4) & 0xF0) | (length - LENGTH_MIN))
+            else:
+                length = 1
+                out[flag_index] |= (1 << bit)
+                out.append(data[pos])
+            for i in range(pos, pos + length):
+                chains.setdefault(bytes(data[i:i + LENGTH_MIN]), []).append(i)
+            pos += length
+    return out
+
+def decompress(data, size):
+    out = bytearray()
+    pos = 0
+    while len(out) < size:
+        flags = data[pos]
+        pos += 1
+        for bit in range(8):
+            if len(out) >= size:
+                break
+            if flags & (1 << bit):
+                out.append(data[pos])
+                pos += 1
+            else:
+                distance = (data[pos] | ((data[pos + 1] & 0xF0) << 4)) + 1
+                length = (data[pos + 1] & 0x0F) + LENGTH_MIN
+                pos += 2
+                for i in range(length):
+                    out.append(out[-distance])
+    return out
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        print("Usage: " + sys.argv[0] + " <firmware.bin> <compressed.bin>")
+        exit(1)
+
+    with open(sys.argv[1], "rb") as f:
+        image = bytearray(f.read())
+    # the transfer length is given in words
+    while len(image) % 4:
+        image.append(0xFF)
+
+    compressed = compress(image)
+    if decompress(compressed, len(image)) != image:
+        print("Error: Compressed image doesn't match the original.")
+        exit(2)
+    while len(compressed) % 4:
+        compressed.append(0x00)
+
+    with open(sys.argv[2], "wb") as f:
+        f.write(compressed)
+
+    print("Image length:      %d words" % (len(image) // 4))
+    print("Compressed length: %d words (%d%%)" % (len(compressed) // 4, 100 * len(compressed) // len(image)))
@@ -0,0 +1,127 @@
+import sys
+import struct
+
+# Delta format decoded by the bootloader, see dfu_transfer_mesh.c:
+# The stream starts with a 16 byte header holding the FWID of the application
+# the patch was made against (company ID, app ID, app version), two reserved
+# bytes and the number of bytes of the installed application the patch reads.
+# The header is followed by the same flag bytes as in compressed transfers,
+# where each bit (LSB first) marks the item as a literal byte (1) or a 4-byte
+# copy from the installed application (0). A copy holds a 24-bit offset into
+# the installed application, followed by the length minus 3.
+HEADER_FORMAT = "<IHIHI"
+OFFSET_MAX = (1 << 24) - 1
+LENGTH_MIN = 3
+LENGTH_MAX = 258
+COPY_WORTHWHILE = 5 # shorter copies are cheaper as literals
+KEY_LENGTH = 4
+CHAIN_MAX = 64
+
+def index_source(source):
+    chains = {}
+    for i in range(len(source) - KEY_LENGTH + 1):
+        chain = chains.setdefault(bytes(source[i:i + KEY_LENGTH]), [])
+        if len(chain) < CHAIN_MAX:
+            chain.append(i)
+    return chains
+
+def match_length(source, offset, data, pos):
+    length = 0
+    while (length < LENGTH_MAX and offset + length < len(source) and
+           pos + length < len(data) and source[offset + length] == data[pos + length]):
+        length += 1
+    return length
+
+def find_copy(source, chains, data, pos, next_offset):
+    # firmware changes tend to shift whole blocks, so try continuing the previous copy first.
+    best_length = 0
+    best_offset = 0
+    if next_offset < len(source):
+        best_length = match_length(source, next_offset, data, pos)
+        best_offset = next_offset
+    if best_length < LENGTH_MAX:
+        for candidate in chains.get(bytes(data[pos:pos + KEY_LENGTH]), []):
+            length = match_length(source, candidate, data, pos)
+            if length > best_length:
+                best_length = length
+                best_offset = candidate
+                if length == LENGTH_MAX:
+                    break
+    return best_length, best_offset
+
+def diff(source, data, source_fwid):
+    out = bytearray(struct.pack(HEADER_FORMAT, source_fwid[0], source_fwid[1], source_fwid[2], 0xFFFF, len(source)))
+    chains = index_source(source)
+    next_offset = 0
+    pos = 0
+    while pos < len(data):
+        flag_index = len(out)
+        out.append(0)
+        for bit in range(8):
+            if pos >= len(data):
+                break
+            length, offset = find_copy(source, chains, data, pos, next_offset)
+            if length >= COPY_WORTHWHILE:
+                out += struct.pack("<I", offset)[:3]
+                out.append(length - LENGTH_MIN)
+                next_offset = offset + length
+            else:
+                length = 1
+                out[flag_index] |= (1 << bit)
+                out.append(data[pos])
+                next_offset += 1
+            pos += length
+    return out
+
+def patch(source, delta, size):
+    (company_id, app_id, app_version, _, source_length) = struct.unpack_from(HEADER_FORMAT, delta)
+    out = bytearray()
+    pos = struct.calcsize(HEADER_FORMAT)
+    while len(out) < size:
+        flags = delta[pos]
+        pos += 1
+        for bit in range(8):
+            if len(out) >= size:
+                break
+            if flags & (1 << bit):
+                out.append(delta[pos])
+                pos += 1
+            else:
+                offset = delta[pos] | (delta[pos + 1] << 8) | (delta[pos + 2] << 16)
+                length = delta[pos + 3] + LENGTH_MIN
+                pos += 4
+                if offset + length > source_length:
+                    raise ValueError("Copy outside the source")
+                out += source[offset:offset + length]
+    return out
+
+def pad_to_words(data, pad):
+    while len(data) % 4:
+        data.append(pad)
+    return data
+
+if __name__ == '__main__':
+    if len(sys.argv) != 7:
+        print("Usage: " + sys.argv[0] + " <installed.bin> <company_id> <app_id> <app_version> <firmware.bin> <delta.bin>")
+        exit(1)
+
+    with open(sys.argv[1], "rb") as f:
+        source = pad_to_words(bytearray(f.read()), 0xFF)
+    source_fwid = (int(sys.argv[2], 0), int(sys.argv[3], 0), int(sys.argv[4], 0))
+    if len(source) > OFFSET_MAX:
+        print("Error: The installed application is too large.")
+        exit(2)
+    with open(sys.argv[5], "rb") as f:
+        image = pad_to_words(bytearray(f.read()), 0xFF)
+
+    delta = diff(source, image, source_fwid)
+    if patch(source, delta, len(image)) != image:
+        print("Error: Patched image doesn't match the new firmware.")
+        exit(2)
+    pad_to_words(delta, 0x00)
+
+    with open(sys.argv[6], "wb") as f:
+        f.write(delta)
+
+    print("Image length: %d words" % (len(image) // 4))
+    print("Delta length: %d words (%d%%)" % (len(delta) // 4, 100 * len(delta) // len(image)))
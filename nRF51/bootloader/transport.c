@@ -101,7 +101,9 @@ static void set_next_tx(tx_t* p_tx)
 static void order_scan(void)
 {
     radio_event_t evt;
+    memset(&evt, 0, sizeof(radio_event_t));
     evt.event_type = RADIO_EVENT_TYPE_RX_PREEMPTABLE;
+    evt.priority = RADIO_EVENT_PRIORITY_NORMAL;
     if (!mesh_packet_acquire((mesh_packet_t**) &evt.packet_ptr))
     {
         APP_ERROR_CHECK(NRF_ERROR_NO_MEM);
@@ -330,7 +332,9 @@ void transport_rtc_irq_handler(void)
             ((ticks_now - m_ticks_at_order_time) & RTC_MASK))
         {
             radio_event_t radio_evt;
+            memset(&radio_evt, 0, sizeof(radio_event_t));
             radio_evt.event_type = RADIO_EVENT_TYPE_TX;
+            radio_evt.priority = RADIO_EVENT_PRIORITY_NORMAL;
             radio_evt.packet_ptr = (uint8_t*) m_tx[i].p_packet;
             radio_evt.access_address = 0;
 
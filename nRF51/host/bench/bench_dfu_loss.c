@@ -0,0 +1,208 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+
+/**
+ * DFU loss simulation, running the bootloader's segment tracking in
+ * dfu_transfer_mesh.c against a lossy, multi-hop transfer. The source
+ * broadcasts the image once, in order, and each hop loses a segment with the
+ * given probability. After every received segment, the node requests its
+ * oldest missing segment the way target_rx_data() in dfu_mesh.c does, and a
+ * neighbour answers it, with both the request and the response subject to
+ * loss. Once the stream has ended, the node keeps requesting segments until
+ * the image is complete or the request budget runs out.
+ *
+ * Prints the share of transfers that completed, and how many request rounds
+ * completing them took after the stream ended.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dfu_transfer_mesh.h"
+#include "dfu_types_mesh.h"
+#include "bootloader_app_bridge.h"
+#include "sha256.h"
+#include "nrf_error.h"
+
+#define SIM_SEGMENT_COUNT       (8192) /* 128kB image */
+#define SIM_RUNS                (200)
+#define SIM_FILL_ROUNDS_MAX     (4 * SIM_SEGMENT_COUNT)
+#define SIM_SEED                (1234)
+
+static uint8_t m_flash[SIM_SEGMENT_COUNT * SEGMENT_LENGTH] __attribute__((aligned(PAGE_SIZE)));
+static uint8_t m_image[SIM_SEGMENT_COUNT * SEGMENT_LENGTH];
+static bool m_ended;
+static uint32_t m_rand;
+static uint32_t m_loss; /* per hop, in parts per 2^32 */
+
+/*****************************************************************************
+* Bootloader functions used by dfu_transfer_mesh.c
+*****************************************************************************/
+uint32_t flash_write(void* p_dest, void* p_data, uint32_t length)
+{
+    memcpy(p_dest, p_data, length);
+    dfu_transfer_flash_write_complete(p_data);
+    return NRF_SUCCESS;
+}
+
+uint32_t flash_erase(void* p_dest, uint32_t length)
+{
+    memset(p_dest, 0xFF, length);
+    return NRF_SUCCESS;
+}
+
+void send_end_evt(dfu_end_t end_reason)
+{
+    m_ended = true;
+}
+
+uint32_t sha256_update(sha256_context_t* p_ctx, const uint8_t* p_data, size_t len)
+{
+    return NRF_SUCCESS;
+}
+
+/*****************************************************************************
+* Simulation
+*****************************************************************************/
+static bool lost(void)
+{
+    m_rand ^= m_rand << 13;
+    m_rand ^= m_rand >> 17;
+    m_rand ^= m_rand << 5;
+    return (m_rand < m_loss);
+}
+
+static bool segment_rx(uint16_t segment, uint32_t* p_remaining)
+{
+    uint32_t addr = SEGMENT_ADDR(segment, m_flash);
+    if (dfu_transfer_data(addr, &m_image[addr - (uint32_t) m_flash], SEGMENT_LENGTH) != NRF_SUCCESS)
+    {
+        return false;
+    }
+    (*p_remaining)--;
+    return true;
+}
+
+/** Runs a single transfer, returns the number of request rounds needed after the stream, or -1 if it didn't complete. */
+static int32_t transfer_run(uint32_t hops)
+{
+    m_ended = false;
+    dfu_transfer_start((uint32_t*) m_flash, NULL, sizeof(m_flash), 0, NULL, true);
+
+    uint32_t remaining = SIM_SEGMENT_COUNT;
+    uint32_t* p_last_requested = NULL;
+    for (uint32_t segment = 1; segment <= SIM_SEGMENT_COUNT && !m_ended; ++segment)
+    {
+        bool received = true;
+        for (uint32_t hop = 0; hop < hops; ++hop)
+        {
+            if (lost())
+            {
+                received = false;
+            }
+        }
+        if (!received || !segment_rx(segment, &remaining))
+        {
+            continue;
+        }
+
+        uint32_t* p_entry;
+        uint32_t length;
+        if (dfu_transfer_get_oldest_missing_entry(p_last_requested, &p_entry, &length) &&
+            ADDR_SEGMENT(p_entry, m_flash) < segment - 1)
+        {
+            p_last_requested = p_entry;
+            if (!lost() && !lost())
+            {
+                segment_rx(ADDR_SEGMENT(p_entry, m_flash), &remaining);
+            }
+        }
+    }
+
+    int32_t rounds = 0;
+    while (remaining > 0 && !m_ended && rounds < SIM_FILL_ROUNDS_MAX)
+    {
+        uint32_t* p_entry;
+        uint32_t length;
+        if (!dfu_transfer_get_oldest_missing_entry(NULL, &p_entry, &length))
+        {
+            break;
+        }
+        rounds++;
+        if (!lost() && !lost())
+        {
+            segment_rx(ADDR_SEGMENT(p_entry, m_flash), &remaining);
+        }
+    }
+
+    bool complete = (remaining == 0 && !m_ended &&
+                     memcmp(m_flash, m_image, sizeof(m_image)) == 0);
+    dfu_transfer_end();
+    return complete ? rounds : -1;
+}
+
+int main(void)
+{
+    static const uint32_t loss_percent[] = {5, 10, 20};
+    static const uint32_t hops[] = {1, 3};
+
+    for (uint32_t i = 0; i < sizeof(m_image); ++i)
+    {
+        m_image[i] = (uint8_t) (i * 7 + (i >> 8));
+    }
+
+    printf("%-6s %-5s %10s %14s\n", "loss", "hops", "completed", "fill rounds");
+    bool all_complete = true;
+    for (uint32_t l = 0; l < sizeof(loss_percent) / sizeof(loss_percent[0]); ++l)
+    {
+        for (uint32_t h = 0; h < sizeof(hops) / sizeof(hops[0]); ++h)
+        {
+            m_loss = (uint32_t) ((UINT32_MAX / 100ULL) * loss_percent[l]);
+            m_rand = SIM_SEED;
+            uint32_t completed = 0;
+            uint64_t rounds_total = 0;
+            for (uint32_t run = 0; run < SIM_RUNS; ++run)
+            {
+                int32_t rounds = transfer_run(hops[h]);
+                if (rounds >= 0)
+                {
+                    completed++;
+                    rounds_total += rounds;
+                }
+            }
+            printf("%4u%%  %-5u %9u%% %14.0f\n",
+                    loss_percent[l], hops[h], completed * 100 / SIM_RUNS,
+                    completed ? (double) rounds_total / completed : 0.0);
+            all_complete &= (completed == SIM_RUNS);
+        }
+    }
+    return all_complete ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+
+/**
+ * Handle lookup benchmark, comparing the handle index in handle_storage.c to
+ * the linear walk of the handle cache it replaced. Built once for every cache
+ * size in HANDLE_LOOKUP_BENCH_ENTRIES (see CMakeLists.txt), by setting
+ * RBC_MESH_HANDLE_CACHE_ENTRIES.
+ *
+ * The module is included directly to get to its static lookup function. Both
+ * lookups are checked against each other before timing them.
+ */
+#include "handle_storage.c"
+
+#include <stdio.h>
+#include <time.h>
+
+#include "host_test.h"
+#include "host_hal.h"
+
+#define BENCH_QUERY_COUNT   (4096)
+#define BENCH_MIN_NS        (20000000ULL)
+
+static rbc_mesh_value_handle_t m_handles[RBC_MESH_HANDLE_CACHE_ENTRIES];
+static rbc_mesh_value_handle_t m_queries[BENCH_QUERY_COUNT];
+static volatile uint32_t m_sink;
+static uint32_t m_rand = 0x1D872B41;
+
+static uint32_t bench_rand(void)
+{
+    m_rand ^= m_rand << 13;
+    m_rand ^= m_rand >> 17;
+    m_rand ^= m_rand << 5;
+    return m_rand;
+}
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/** The lookup handle_entry_get() did before the handle index, walking the LRU
+  list from the head. */
+static uint16_t handle_entry_get_linear(rbc_mesh_value_handle_t handle)
+{
+    event_handler_critical_section_begin();
+    uint16_t i = m_handle_cache_head;
+    while (m_handle_cache[i].handle != handle)
+    {
+        if (m_handle_cache_tail == i)
+        {
+            event_handler_critical_section_end();
+            return HANDLE_CACHE_ENTRY_INVALID;
+        }
+        HANDLE_CACHE_ITERATE(i);
+    }
+    event_handler_critical_section_end();
+    return i;
+}
+
+static bool handle_is_cached(rbc_mesh_value_handle_t handle, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (m_handles[i] == handle)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Fill the cache with random handles, and make a set of queries where every
+  query has the given chance of hitting the cache. */
+static void bench_setup(uint32_t hit_percent)
+{
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_init(100000));
+    for (uint32_t i = 0; i < RBC_MESH_HANDLE_CACHE_ENTRIES; ++i)
+    {
+        do
+        {
+            m_handles[i] = bench_rand() % RBC_MESH_APP_MAX_HANDLE;
+        } while (m_handles[i] == RBC_MESH_INVALID_HANDLE || handle_is_cached(m_handles[i], i));
+        TEST_ASSERT(handle_entry_to_head(m_handles[i]) != HANDLE_CACHE_ENTRY_INVALID);
+    }
+
+    for (uint32_t i = 0; i < BENCH_QUERY_COUNT; ++i)
+    {
+        if (bench_rand() % 100 < hit_percent)
+        {
+            m_queries[i] = m_handles[bench_rand() % RBC_MESH_HANDLE_CACHE_ENTRIES];
+        }
+        else
+        {
+            do
+            {
+                m_queries[i] = bench_rand() % RBC_MESH_APP_MAX_HANDLE;
+            } while (m_queries[i] == RBC_MESH_INVALID_HANDLE || handle_is_cached(m_queries[i], RBC_MESH_HANDLE_CACHE_ENTRIES));
+        }
+        TEST_ASSERT_EQUAL(handle_entry_get_linear(m_queries[i]), handle_entry_get(m_queries[i]));
+    }
+}
+
+/** Run the lookup over the queries until at least BENCH_MIN_NS has passed, and
+  return the time per lookup. */
+static double bench_run(uint16_t (*lookup)(rbc_mesh_value_handle_t))
+{
+    uint64_t lookups = 0;
+    uint64_t start = time_ns();
+    uint64_t elapsed;
+    do
+    {
+        uint32_t sum = 0;
+        for (uint32_t i = 0; i < BENCH_QUERY_COUNT; ++i)
+        {
+            sum += lookup(m_queries[i]);
+        }
+        m_sink += sum;
+        lookups += BENCH_QUERY_COUNT;
+        elapsed = time_ns() - start;
+    } while (elapsed < BENCH_MIN_NS);
+    return (double) elapsed / lookups;
+}
+
+int main(void)
+{
+    host_hal_init(1);
+    event_handler_init();
+
+    static const uint32_t hit_percents[] = {100, 50, 0};
+    printf("%-8s %-6s %14s %14s\n", "entries", "hits", "index ns/op", "linear ns/op");
+    for (uint32_t i = 0; i < sizeof(hit_percents) / sizeof(hit_percents[0]); ++i)
+    {
+        bench_setup(hit_percents[i]);
+        double index_ns = bench_run(handle_entry_get);
+        double linear_ns = bench_run(handle_entry_get_linear);
+        printf("%-8u %5u%% %14.1f %14.1f\n",
+               RBC_MESH_HANDLE_CACHE_ENTRIES, hit_percents[i], index_ns, linear_ns);
+    }
+    return 0;
+}
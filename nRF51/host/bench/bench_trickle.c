@@ -0,0 +1,123 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+
+/**
+ * Trickle benchmark, timing trickle_tx_timeout() and trickle_rx_consistent()
+ * over a set of instances with the default profile. Time moves forward in
+ * steps of I_min/4 between rounds, so that a share of the calls start a new
+ * interval, as they would in the handle storage.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "host_hal.h"
+#include "trickle.h"
+
+#define BENCH_INSTANCE_COUNT    (1024)
+#define BENCH_I_MIN             (100000)
+#define BENCH_I_MAX             (2048)
+#define BENCH_K                 (3)
+#define BENCH_MIN_NS            (50000000ULL)
+
+static trickle_t m_instances[BENCH_INSTANCE_COUNT];
+static volatile uint32_t m_sink;
+
+static uint64_t time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void instances_reset(void)
+{
+    for (uint32_t i = 0; i < BENCH_INSTANCE_COUNT; ++i)
+    {
+        trickle_timer_reset(&m_instances[i], i * (BENCH_I_MIN / BENCH_INSTANCE_COUNT));
+    }
+}
+
+static double bench_tx_timeout(void)
+{
+    instances_reset();
+    uint32_t time_now = 0;
+    uint64_t ops = 0;
+    uint32_t tx_count = 0;
+    uint64_t start = time_ns();
+    uint64_t elapsed;
+    do
+    {
+        for (uint32_t i = 0; i < BENCH_INSTANCE_COUNT; ++i)
+        {
+            bool do_tx;
+            trickle_tx_timeout(&m_instances[i], &do_tx, time_now);
+            tx_count += do_tx;
+        }
+        time_now += BENCH_I_MIN / 4;
+        ops += BENCH_INSTANCE_COUNT;
+        elapsed = time_ns() - start;
+    } while (elapsed < BENCH_MIN_NS);
+    m_sink += tx_count;
+    return (double) elapsed / ops;
+}
+
+static double bench_rx_consistent(void)
+{
+    instances_reset();
+    uint32_t time_now = 0;
+    uint64_t ops = 0;
+    uint64_t start = time_ns();
+    uint64_t elapsed;
+    do
+    {
+        for (uint32_t i = 0; i < BENCH_INSTANCE_COUNT; ++i)
+        {
+            trickle_rx_consistent(&m_instances[i], time_now);
+        }
+        time_now += BENCH_I_MIN / 4;
+        ops += BENCH_INSTANCE_COUNT;
+        elapsed = time_ns() - start;
+    } while (elapsed < BENCH_MIN_NS);
+    m_sink += m_instances[0].c;
+    return (double) elapsed / ops;
+}
+
+int main(void)
+{
+    host_hal_init(1);
+    trickle_setup(BENCH_I_MIN, BENCH_I_MAX, BENCH_K);
+
+    printf("%-24s %10s\n", "function", "ns/op");
+    printf("%-24s %10.1f\n", "trickle_tx_timeout", bench_tx_timeout());
+    printf("%-24s %10.1f\n", "trickle_rx_consistent", bench_rx_consistent());
+    return 0;
+}
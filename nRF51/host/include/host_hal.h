@@ -0,0 +1,207 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#ifndef HOST_HAL_H__
+#define HOST_HAL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrf.h"
+#include "timer.h"
+#include "mesh_packet.h"
+#include "rbc_mesh.h"
+
+/**
+ * @defgroup HOST_HAL Host HAL
+ * Stand-ins for the nRF51 peripherals, the SoftDevice and the timing
+ * critical rbc_mesh modules (timer, timeslot and radio_control), letting the
+ * rest of the mesh core run as a regular Linux process. All time is virtual,
+ * and only moves when the test advances it.
+ * @{
+ */
+
+/** Maximum number of transmitted packets kept in the fake radio's log. */
+#ifndef HOST_RADIO_TX_LOG_LENGTH
+#define HOST_RADIO_TX_LOG_LENGTH    (64)
+#endif
+
+/** Entry in the fake radio's log of transmitted packets. */
+typedef struct
+{
+    mesh_packet_t packet;       /**< Copy of the packet, as it was on air. */
+    timestamp_t timestamp;      /**< Virtual time of the transmission. */
+    uint8_t channel;            /**< Channel the packet was transmitted on. */
+    uint8_t access_address;     /**< Logical access address (0 or 1). */
+} host_radio_tx_t;
+
+/**
+ * Shared medium for the fake radio, see host_radio_air_set(). The functions
+ * are called from the RADIO IRQ, and must not call back into the radio.
+ */
+typedef struct
+{
+    /** The radio started transmitting, call host_radio_tx_end() when the packet is off air. */
+    void (*tx_start)(const mesh_packet_t* p_packet, uint8_t channel, uint32_t access_address, uint8_t tx_power);
+    /**
+     * The radio started listening on the BLE advertisement access address,
+     * and on @p alt_access_address. Packets are given to it with
+     * host_radio_rx_sync() and host_radio_rx().
+     */
+    void (*rx_start)(uint8_t channel, uint32_t alt_access_address);
+    /** The radio stopped listening without receiving anything. */
+    void (*rx_stop)(void);
+} host_radio_air_t;
+
+/** Application error hook, replaces the default abort() in app_error_handler(). */
+typedef void (*host_app_error_hook_t)(uint32_t error_code, uint32_t line_num, const uint8_t* p_file_name);
+
+/**
+ * Reset all fakes to their power-on state: virtual time 0, no IRQs pending,
+ * an empty radio and a deterministic HW RNG seeded with @p seed.
+ *
+ * IRQs behave like on a Cortex-M0 running the application in thread mode:
+ * pending an enabled IRQ outside of IRQ context executes it right away, while
+ * IRQs pended in IRQ context run after the current handler returns, highest
+ * priority first. Handlers never preempt each other. The RADIO and TIMER0
+ * IRQs execute radio_event_handler() and timer_event_handler(), as the
+ * timeslot signal handler does on target.
+ */
+void host_hal_init(uint32_t seed);
+
+/**
+ * Advance the virtual time by @p time_us, firing the timers that expire on
+ * the way in order.
+ */
+void host_hal_run(uint32_t time_us);
+
+/** Run pending IRQs without moving the virtual time. */
+void host_hal_process(void);
+
+/** Replace the default application error behavior (print and abort). */
+void host_app_error_hook_set(host_app_error_hook_t hook);
+
+/**
+ * Execute all pending and enabled IRQ handlers.
+ *
+ * @return Whether any handler was executed.
+ */
+bool host_irq_process(void);
+
+/** Whether IRQs are currently masked through __disable_irq(). */
+bool host_irq_is_masked(void);
+
+/** Seed the deterministic replacement for the HW RNG. */
+void host_rng_seed(uint32_t seed);
+
+/** Reset the fake timer, setting the virtual time to @p time. */
+void host_timer_init(timestamp_t time);
+
+/**
+ * Get the earliest ordered timeout.
+ *
+ * @param[out] p_timeout Earliest timeout.
+ *
+ * @return Whether any timer is ordered.
+ */
+bool host_timer_next_timeout_get(timestamp_t* p_timeout);
+
+/** Move the virtual time to @p time, firing every timer up to and including it. */
+void host_timer_run_until(timestamp_t time);
+
+/**
+ * Reset the fake radio, dropping all queued events and the TX log. The fake
+ * radio executes its queue in the RADIO IRQ: TX events are logged and
+ * reported to the stack immediately (or when the medium ends them, see
+ * host_radio_air_set()), preemptable RX events are aborted when other events
+ * are waiting behind them, and other RX events wait for host_radio_rx().
+ */
+void host_radio_init(void);
+
+/**
+ * Receive a packet in the ordered RX event.
+ *
+ * @param[in] p_packet Packet to receive.
+ * @param[in] crc_ok Whether the packet passed the CRC check.
+ * @param[in] rssi Reported RSSI.
+ *
+ * @return NRF_SUCCESS The packet was received.
+ * @return NRF_ERROR_INVALID_STATE The radio isn't listening.
+ */
+uint32_t host_radio_rx(const mesh_packet_t* p_packet, bool crc_ok, uint8_t rssi);
+
+/**
+ * Put the fake radio on a shared medium. Transmissions then last until the
+ * medium calls host_radio_tx_end(), and the medium is told when the radio
+ * listens. Reset by host_radio_init().
+ *
+ * @param[in] p_air Medium to use, or NULL to complete transmissions immediately.
+ */
+void host_radio_air_set(const host_radio_air_t* p_air);
+
+/**
+ * Mark the start of a packet on air, e.g. when its access address is
+ * received. Until the packet is given with host_radio_rx(), the RX is not
+ * preempted by other radio events.
+ *
+ * @return NRF_SUCCESS The radio is receiving the packet.
+ * @return NRF_ERROR_INVALID_STATE The radio isn't listening.
+ */
+uint32_t host_radio_rx_sync(void);
+
+/**
+ * End the ongoing transmission, when on a shared medium.
+ *
+ * @return NRF_SUCCESS The transmission ended.
+ * @return NRF_ERROR_INVALID_STATE The radio isn't transmitting.
+ */
+uint32_t host_radio_tx_end(void);
+
+/** Number of packets transmitted since the last host_radio_init(). */
+uint32_t host_radio_tx_count_get(void);
+
+/**
+ * Get a transmitted packet from the log.
+ *
+ * @param[in] index Transmission number, counting from 0 at the last host_radio_init().
+ *
+ * @return The logged transmission, or NULL if it isn't (or no longer) in the log.
+ */
+const host_radio_tx_t* host_radio_tx_get(uint32_t index);
+
+/**
+ * Reset the application event queue. The host HAL implements
+ * rbc_mesh_event_push(), rbc_mesh_event_get() and rbc_mesh_event_release()
+ * in place of rbc_mesh.c, with the same reference counting.
+ */
+void host_app_init(void);
+
+/** @} */
+
+#endif /* HOST_HAL_H__ */
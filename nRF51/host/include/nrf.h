@@ -0,0 +1,110 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#ifndef NRF_H
+#define NRF_H
+
+/**
+ * @file
+ * Host replacement for the nRF51 device header. Only the peripherals and
+ * core functions used by the rbc_mesh core are provided. Peripherals are
+ * plain structures in RAM, and the NVIC and PRIMASK are emulated by the
+ * host HAL, see host_hal.h.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef HOST
+    #error "The host device header must only be used in a HOST build"
+#endif
+
+#define __ASM   __asm__
+#define __NOP() do {} while (0)
+#define __DMB() __asm__ volatile ("" ::: "memory")
+
+typedef enum
+{
+    POWER_CLOCK_IRQn    = 0,
+    RADIO_IRQn          = 1,
+    UART0_IRQn          = 2,
+    SPI0_TWI0_IRQn      = 3,
+    SPI1_TWI1_IRQn      = 4,
+    GPIOTE_IRQn         = 6,
+    ADC_IRQn            = 7,
+    TIMER0_IRQn         = 8,
+    TIMER1_IRQn         = 9,
+    TIMER2_IRQn         = 10,
+    RTC0_IRQn           = 11,
+    TEMP_IRQn           = 12,
+    RNG_IRQn            = 13,
+    ECB_IRQn            = 14,
+    CCM_AAR_IRQn        = 15,
+    WDT_IRQn            = 16,
+    RTC1_IRQn           = 17,
+    QDEC_IRQn           = 18,
+    LPCOMP_IRQn         = 19,
+    SWI0_IRQn           = 20,
+    SWI1_IRQn           = 21,
+    SWI2_IRQn           = 22,
+    SWI3_IRQn           = 23,
+    SWI4_IRQn           = 24,
+    SWI5_IRQn           = 25,
+    IRQn__COUNT
+} IRQn_Type;
+
+typedef struct
+{
+    volatile uint32_t OUT;
+    volatile uint32_t OUTSET;
+    volatile uint32_t OUTCLR;
+} NRF_GPIO_Type;
+
+typedef struct
+{
+    volatile uint32_t CODEPAGESIZE;
+    volatile uint32_t CODESIZE;
+    volatile uint32_t DEVICEID[2];
+    volatile uint32_t DEVICEADDRTYPE;
+    volatile uint32_t DEVICEADDR[2];
+} NRF_FICR_Type;
+
+extern NRF_GPIO_Type* NRF_GPIO;
+extern NRF_FICR_Type* NRF_FICR;
+
+uint32_t __disable_irq(void);
+void __enable_irq(void);
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_SetPendingIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+
+#endif /* NRF_H */
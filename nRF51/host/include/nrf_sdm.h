@@ -0,0 +1,51 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#ifndef NRF_SDM_H__
+#define NRF_SDM_H__
+
+#include <stdint.h>
+#include "nrf_error.h"
+
+/** Low frequency clock source, only used as a parameter type on the host. */
+typedef enum
+{
+    NRF_CLOCK_LFCLKSRC_SYNTH_250_PPM,
+    NRF_CLOCK_LFCLKSRC_XTAL_500_PPM,
+    NRF_CLOCK_LFCLKSRC_XTAL_250_PPM,
+    NRF_CLOCK_LFCLKSRC_XTAL_150_PPM,
+    NRF_CLOCK_LFCLKSRC_XTAL_100_PPM,
+    NRF_CLOCK_LFCLKSRC_XTAL_75_PPM,
+    NRF_CLOCK_LFCLKSRC_XTAL_50_PPM,
+    NRF_CLOCK_LFCLKSRC_XTAL_30_PPM,
+    NRF_CLOCK_LFCLKSRC_XTAL_20_PPM,
+    NRF_CLOCK_LFCLKSRC_RC_250_PPM_250MS_CALIBRATION,
+} nrf_clock_lfclksrc_t;
+
+#endif /* NRF_SDM_H__ */
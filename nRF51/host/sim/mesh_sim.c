@@ -0,0 +1,357 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+
+/**
+ * Multi-node mesh simulator. Runs the mesh stack on any number of simulated
+ * nodes sharing a virtual medium (see sim_air.h), injects value updates on
+ * random nodes, and reports how long each update takes to reach every node,
+ * along with the medium statistics. Run with --help for the options.
+ */
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sim_air.h"
+#include "sim_node.h"
+#include "sim_queue.h"
+#include "version_handler.h"
+#include "nrf_error.h"
+
+typedef struct
+{
+    uint64_t time;          /**< Time of the update. */
+    uint32_t source;        /**< Node updating the value. */
+    uint32_t reached;       /**< Nodes that have the update. */
+    uint64_t latency_sum;
+    uint64_t latency_max;
+} update_t;
+
+/*****************************************************************************
+* Static globals
+*****************************************************************************/
+static sim_air_config_t m_air_config =
+{
+    .topology = SIM_TOPOLOGY_GRID,
+    .spacing_m = 10.0,
+    .area_m = 100.0,
+    .path_loss_1m_db = 40.0,
+    .path_loss_exponent = 3.0,
+    .shadowing_db = 4.0,
+    .sensitivity_dbm = -93.0,
+    .capture_db = 6.0,
+    .crc_fail_rate = 0.0,
+    .seed = 1,
+};
+static sim_node_config_t m_node_config =
+{
+    .interval_min_us = 100000,
+    .access_address = RBC_MESH_ACCESS_ADDRESS_BLE_ADV,
+    .channel = 38,
+    .seed = 1,
+};
+static uint32_t     m_node_count = 100;
+static uint32_t     m_update_count = 10;
+static uint64_t     m_update_period_us = 1000000;
+static uint64_t     m_duration_us = 30000000;
+static bool         m_check;
+static update_t*    mp_updates;
+static uint8_t*     mp_reached; /**< Whether update u has reached node n, at [u * m_node_count + n]. */
+
+/*****************************************************************************
+* Static functions
+*****************************************************************************/
+static void usage(const char* p_name)
+{
+    printf("Usage: %s [options]\n"
+           "  --nodes N                Number of nodes (%u)\n"
+           "  --topology grid|line|random\n"
+           "  --spacing M              Distance between nodes in grid and line topologies (%.1f m)\n"
+           "  --area M                 Side of the square in random topologies (%.1f m)\n"
+           "  --path-loss-exponent N   Path loss exponent (%.1f)\n"
+           "  --shadowing DB           Standard deviation of the link shadowing (%.1f dB)\n"
+           "  --capture DB             Capture threshold (%.1f dB)\n"
+           "  --crc-fail P             Random CRC failure rate, 0 to 1 (%.2f)\n"
+           "  --interval MS            Trickle I_min (%u ms)\n"
+           "  --updates N              Number of value updates, each on its own handle (%u)\n"
+           "  --update-period MS       Time between updates (%llu ms)\n"
+           "  --duration S             Simulated time (%llu s)\n"
+           "  --seed N                 Seed for the medium and the nodes (%u)\n"
+           "  --check                  Fail unless every update reaches every node\n",
+           p_name, m_node_count, m_air_config.spacing_m, m_air_config.area_m,
+           m_air_config.path_loss_exponent, m_air_config.shadowing_db,
+           m_air_config.capture_db, m_air_config.crc_fail_rate,
+           m_node_config.interval_min_us / 1000, m_update_count,
+           (unsigned long long) m_update_period_us / 1000,
+           (unsigned long long) m_duration_us / 1000000, m_air_config.seed);
+}
+
+static void args_parse(int argc, char** argv)
+{
+    static const struct option options[] =
+    {
+        {"nodes",               required_argument, NULL, 'n'},
+        {"topology",            required_argument, NULL, 't'},
+        {"spacing",             required_argument, NULL, 's'},
+        {"area",                required_argument, NULL, 'a'},
+        {"path-loss-exponent",  required_argument, NULL, 'p'},
+        {"shadowing",           required_argument, NULL, 'w'},
+        {"capture",             required_argument, NULL, 'c'},
+        {"crc-fail",            required_argument, NULL, 'f'},
+        {"interval",            required_argument, NULL, 'i'},
+        {"updates",             required_argument, NULL, 'u'},
+        {"update-period",       required_argument, NULL, 'P'},
+        {"duration",            required_argument, NULL, 'd'},
+        {"seed",                required_argument, NULL, 'S'},
+        {"check",               no_argument,       NULL, 'C'},
+        {"help",                no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': m_node_count = strtoul(optarg, NULL, 0); break;
+            case 's': m_air_config.spacing_m = atof(optarg); break;
+            case 'a': m_air_config.area_m = atof(optarg); break;
+            case 'p': m_air_config.path_loss_exponent = atof(optarg); break;
+            case 'w': m_air_config.shadowing_db = atof(optarg); break;
+            case 'c': m_air_config.capture_db = atof(optarg); break;
+            case 'f': m_air_config.crc_fail_rate = atof(optarg); break;
+            case 'i': m_node_config.interval_min_us = strtoul(optarg, NULL, 0) * 1000; break;
+            case 'u': m_update_count = strtoul(optarg, NULL, 0); break;
+            case 'P': m_update_period_us = strtoull(optarg, NULL, 0) * 1000; break;
+            case 'd': m_duration_us = (uint64_t) (atof(optarg) * 1000000); break;
+            case 'S': m_air_config.seed = m_node_config.seed = strtoul(optarg, NULL, 0); break;
+            case 'C': m_check = true; break;
+            case 't':
+                if (strcmp(optarg, "grid") == 0)
+                {
+                    m_air_config.topology = SIM_TOPOLOGY_GRID;
+                }
+                else if (strcmp(optarg, "line") == 0)
+                {
+                    m_air_config.topology = SIM_TOPOLOGY_LINE;
+                }
+                else if (strcmp(optarg, "random") == 0)
+                {
+                    m_air_config.topology = SIM_TOPOLOGY_RANDOM;
+                }
+                else
+                {
+                    fprintf(stderr, "Unknown topology %s\n", optarg);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+            case 'h':
+                usage(argv[0]);
+                exit(EXIT_SUCCESS);
+            default:
+                usage(argv[0]);
+                exit(EXIT_FAILURE);
+        }
+    }
+
+    if (m_node_count == 0 ||
+        m_update_count > RBC_MESH_APP_MAX_HANDLE ||
+        m_node_config.interval_min_us < RBC_MESH_INTERVAL_MIN_MIN_MS * 1000)
+    {
+        fprintf(stderr, "Invalid configuration\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void update_reached(uint32_t update, uint32_t node)
+{
+    uint8_t* p_reached = &mp_reached[(size_t) update * m_node_count + node];
+    if (*p_reached)
+    {
+        return;
+    }
+    *p_reached = 1;
+
+    update_t* p_update = &mp_updates[update];
+    uint64_t latency = sim_time_now() - p_update->time;
+    p_update->reached++;
+    p_update->latency_sum += latency;
+    if (latency > p_update->latency_max)
+    {
+        p_update->latency_max = latency;
+    }
+}
+
+static void app_evt_handler(uint32_t node, const rbc_mesh_event_t* p_evt)
+{
+    if ((p_evt->type == RBC_MESH_EVENT_TYPE_NEW_VAL || p_evt->type == RBC_MESH_EVENT_TYPE_UPDATE_VAL) &&
+        p_evt->params.rx.data_len == sizeof(uint32_t))
+    {
+        uint32_t update;
+        memcpy(&update, p_evt->params.rx.p_data, sizeof(update));
+        if (update < m_update_count && p_evt->params.rx.value_handle == update + 1)
+        {
+            update_reached(update, node);
+        }
+    }
+}
+
+static void update_event_handle(uint32_t update)
+{
+    update_t* p_update = &mp_updates[update];
+    p_update->time = sim_time_now();
+    update_reached(update, p_update->source);
+
+    sim_node_enter(p_update->source);
+    uint32_t error_code = vh_local_update(update + 1, (uint8_t*) &update, sizeof(update));
+    sim_node_exit();
+    if (error_code != NRF_SUCCESS)
+    {
+        fprintf(stderr, "Update %u on node %u failed (0x%x)\n", update, p_update->source, error_code);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void updates_schedule(void)
+{
+    mp_updates = calloc(m_update_count, sizeof(update_t));
+    mp_reached = calloc((size_t) m_update_count * m_node_count, 1);
+    if ((mp_updates == NULL || mp_reached == NULL) && m_update_count > 0)
+    {
+        fprintf(stderr, "Out of memory for %u updates\n", m_update_count);
+        exit(EXIT_FAILURE);
+    }
+
+    /* give the nodes a second to settle, then update from random nodes */
+    uint32_t rand = m_air_config.seed * 2654435761UL + 1;
+    for (uint32_t i = 0; i < m_update_count; ++i)
+    {
+        rand ^= rand << 13;
+        rand ^= rand >> 17;
+        rand ^= rand << 5;
+        mp_updates[i].source = rand % m_node_count;
+
+        sim_event_t evt = {.time = 1000000 + i * m_update_period_us, .type = SIM_EVENT_UPDATE, .node = mp_updates[i].source, .param = i};
+        sim_queue_push(&evt);
+    }
+}
+
+static bool report(double wall_time_s, uint64_t event_count)
+{
+    static const char* topologies[] = {"grid", "line", "random"};
+    sim_air_stats_t stats;
+    sim_air_stats_get(&stats);
+
+    printf("%u nodes, %s topology, %.1f s simulated in %.2f s (%.0f events/s), %u bytes of stack state per node\n",
+           m_node_count, topologies[m_air_config.topology], m_duration_us / 1e6, wall_time_s,
+           event_count / wall_time_s, sim_node_state_size_get());
+    printf("links: %.1f per node\n", (double) stats.links / m_node_count);
+    printf("air: %llu TX, %.2f%% airtime per node\n",
+           (unsigned long long) stats.tx, 100.0 * stats.airtime_us / m_node_count / m_duration_us);
+    uint64_t rx_total = stats.rx_ok + stats.rx_collision + stats.rx_crc_fail;
+    printf("rx: %llu OK, %llu collisions, %llu CRC failures, %llu missed (%.1f%% received)\n",
+           (unsigned long long) stats.rx_ok, (unsigned long long) stats.rx_collision,
+           (unsigned long long) stats.rx_crc_fail, (unsigned long long) stats.rx_missed,
+           (rx_total + stats.rx_missed) ? 100.0 * stats.rx_ok / (rx_total + stats.rx_missed) : 0.0);
+
+    printf("%8s %8s %10s %14s %14s\n", "update", "source", "reached", "mean ms", "max ms");
+    uint32_t converged = 0;
+    uint64_t latency_sum = 0;
+    uint64_t latency_max = 0;
+    for (uint32_t i = 0; i < m_update_count; ++i)
+    {
+        update_t* p_update = &mp_updates[i];
+        if (p_update->reached == 0)
+        {
+            printf("%8u %8u %10s\n", i, p_update->source, "-");
+            continue;
+        }
+        printf("%8u %8u %5u/%-5u %14.1f %14.1f\n", i, p_update->source, p_update->reached, m_node_count,
+               p_update->latency_sum / 1000.0 / p_update->reached, p_update->latency_max / 1000.0);
+        if (p_update->reached == m_node_count)
+        {
+            converged++;
+            latency_sum += p_update->latency_max;
+            if (p_update->latency_max > latency_max)
+            {
+                latency_max = p_update->latency_max;
+            }
+        }
+    }
+    printf("converged: %u/%u updates reached every node", converged, m_update_count);
+    if (converged > 0)
+    {
+        printf(", convergence time mean %.1f ms, max %.1f ms", latency_sum / 1000.0 / converged, latency_max / 1000.0);
+    }
+    printf("\n");
+    return (converged == m_update_count);
+}
+
+static double wall_time_get(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char** argv)
+{
+    args_parse(argc, argv);
+    double start = wall_time_get();
+
+    sim_queue_init();
+    sim_air_init(m_node_count, &m_air_config);
+    sim_nodes_init(m_node_count, &m_node_config, sim_air_radio_get(), app_evt_handler);
+    updates_schedule();
+
+    uint64_t event_count = 0;
+    sim_event_t evt;
+    while (sim_queue_pop(&evt) && evt.time <= m_duration_us)
+    {
+        switch (evt.type)
+        {
+            case SIM_EVENT_NODE_TIMER:
+                sim_node_timer_event_handle(evt.node);
+                break;
+            case SIM_EVENT_TX_BEGIN:
+            case SIM_EVENT_TX_END:
+                sim_air_event_handle(&evt);
+                break;
+            case SIM_EVENT_UPDATE:
+                update_event_handle(evt.param);
+                break;
+        }
+        event_count++;
+    }
+
+    bool converged = report(wall_time_get() - start, event_count);
+    return ((m_check && !converged) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,443 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#include "sim_air.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim_node.h"
+#include "nrf_error.h"
+
+#define SIM_TX_NONE             (UINT32_MAX)
+#define RADIO_RAMP_UP_US        (140)   /* nRF51 TXEN/RXEN to READY */
+#define TX_POWER_MAX_DBM        (4)
+#define AIRTIME_US(length)      ((1 + 4 + 2 + (length) + 3) * 8) /* preamble, access address, header, payload and CRC at 1 Mbit */
+
+typedef struct
+{
+    uint32_t node;
+    float gain_db;              /**< Link gain, negative path loss. */
+} link_t;
+
+typedef struct
+{
+    double x;
+    double y;
+    link_t* p_links;            /**< Nodes that can hear this node. */
+    uint32_t link_count;
+    /* radio state */
+    bool listening;
+    uint8_t channel;
+    uint32_t alt_access_address;
+    uint64_t listen_start;      /**< The radio can lock on to packets going on air from this time. */
+    uint32_t rx_tx;             /**< Transmission being received, SIM_TX_NONE if none. */
+    double rx_rssi;
+    bool rx_corrupt;
+} air_node_t;
+
+typedef struct
+{
+    mesh_packet_t packet;
+    uint32_t src;
+    uint8_t channel;
+    uint32_t access_address;
+    int8_t tx_power;
+    uint32_t active_index;      /**< Position in the list of transmissions on air. */
+    uint32_t next_free;
+} sim_tx_t;
+
+/*****************************************************************************
+* Static globals
+*****************************************************************************/
+static sim_air_config_t m_config;
+static air_node_t*      mp_nodes;
+static uint32_t         m_node_count;
+static sim_tx_t*        mp_txs;
+static uint32_t         m_tx_capacity;
+static uint32_t         m_tx_free;
+static uint32_t*        mp_active;      /**< Transmissions on air. */
+static uint32_t         m_active_count;
+static uint32_t         m_rand;
+static sim_air_stats_t  m_stats;
+
+/*****************************************************************************
+* Static functions
+*****************************************************************************/
+static void* alloc_or_exit(void* p, size_t size)
+{
+    p = realloc(p, size);
+    if (p == NULL && size != 0)
+    {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static uint32_t hash32(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352D;
+    x ^= x >> 15;
+    x *= 0x846CA68B;
+    x ^= x >> 16;
+    return x;
+}
+
+/** Uniform in [0, 1) */
+static double rand_uniform(void)
+{
+    m_rand ^= m_rand << 13;
+    m_rand ^= m_rand >> 17;
+    m_rand ^= m_rand << 5;
+    return m_rand / 4294967296.0;
+}
+
+/** Gain of the link between two nodes, the same in both directions. */
+static double link_gain_db(uint32_t a, uint32_t b)
+{
+    double dx = mp_nodes[a].x - mp_nodes[b].x;
+    double dy = mp_nodes[a].y - mp_nodes[b].y;
+    double distance = sqrt(dx * dx + dy * dy);
+    if (distance < 1.0)
+    {
+        distance = 1.0;
+    }
+    double gain = -(m_config.path_loss_1m_db + 10.0 * m_config.path_loss_exponent * log10(distance));
+
+    if (m_config.shadowing_db > 0)
+    {
+        /* Box-Muller, seeded by the link */
+        uint32_t link = hash32(m_config.seed ^ hash32((a < b ? a : b) * 0x10001 + (a < b ? b : a)));
+        double u1 = (hash32(link) + 1.0) / 4294967297.0;
+        double u2 = hash32(link + 1) / 4294967296.0;
+        gain += m_config.shadowing_db * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+    }
+    return gain;
+}
+
+static void nodes_place(void)
+{
+    uint32_t side = (uint32_t) ceil(sqrt(m_node_count));
+    for (uint32_t i = 0; i < m_node_count; ++i)
+    {
+        switch (m_config.topology)
+        {
+            case SIM_TOPOLOGY_GRID:
+                mp_nodes[i].x = (i % side) * m_config.spacing_m;
+                mp_nodes[i].y = (i / side) * m_config.spacing_m;
+                break;
+            case SIM_TOPOLOGY_LINE:
+                mp_nodes[i].x = i * m_config.spacing_m;
+                mp_nodes[i].y = 0;
+                break;
+            case SIM_TOPOLOGY_RANDOM:
+                mp_nodes[i].x = rand_uniform() * m_config.area_m;
+                mp_nodes[i].y = rand_uniform() * m_config.area_m;
+                break;
+        }
+    }
+}
+
+static void link_add(uint32_t from, uint32_t to, double gain)
+{
+    air_node_t* p_node = &mp_nodes[from];
+    /* grow in powers of two */
+    if ((p_node->link_count & (p_node->link_count - 1)) == 0)
+    {
+        p_node->p_links = alloc_or_exit(p_node->p_links, (p_node->link_count ? 2 * p_node->link_count : 1) * sizeof(link_t));
+    }
+    p_node->p_links[p_node->link_count].node = to;
+    p_node->p_links[p_node->link_count].gain_db = gain;
+    p_node->link_count++;
+}
+
+static void links_compute(void)
+{
+    for (uint32_t a = 0; a < m_node_count; ++a)
+    {
+        for (uint32_t b = a + 1; b < m_node_count; ++b)
+        {
+            double gain = link_gain_db(a, b);
+            if (TX_POWER_MAX_DBM + gain >= m_config.sensitivity_dbm)
+            {
+                link_add(a, b, gain);
+                link_add(b, a, gain);
+                if (gain >= m_config.sensitivity_dbm)
+                {
+                    m_stats.links += 2;
+                }
+            }
+        }
+    }
+}
+
+static uint32_t tx_alloc(void)
+{
+    if (m_tx_free == SIM_TX_NONE)
+    {
+        uint32_t capacity = (m_tx_capacity ? 2 * m_tx_capacity : 64);
+        mp_txs = alloc_or_exit(mp_txs, capacity * sizeof(sim_tx_t));
+        mp_active = alloc_or_exit(mp_active, capacity * sizeof(uint32_t));
+        for (uint32_t i = m_tx_capacity; i < capacity; ++i)
+        {
+            mp_txs[i].next_free = (i + 1 < capacity ? i + 1 : SIM_TX_NONE);
+        }
+        m_tx_free = m_tx_capacity;
+        m_tx_capacity = capacity;
+    }
+    uint32_t tx = m_tx_free;
+    m_tx_free = mp_txs[tx].next_free;
+    return tx;
+}
+
+static void tx_free(uint32_t tx)
+{
+    mp_txs[tx].next_free = m_tx_free;
+    m_tx_free = tx;
+}
+
+/** Whether a transmission on air drowns out a packet received at the given node. */
+static bool is_interfered(uint32_t node, uint32_t tx, double rssi)
+{
+    for (uint32_t i = 0; i < m_active_count; ++i)
+    {
+        sim_tx_t* p_other = &mp_txs[mp_active[i]];
+        if (mp_active[i] == tx || p_other->channel != mp_txs[tx].channel || p_other->src == node)
+        {
+            continue;
+        }
+        double other_rssi = p_other->tx_power + link_gain_db(p_other->src, node);
+        if (other_rssi >= m_config.sensitivity_dbm &&
+            other_rssi > rssi - m_config.capture_db)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void tx_begin(uint32_t tx)
+{
+    sim_tx_t* p_tx = &mp_txs[tx];
+    uint32_t airtime = AIRTIME_US(p_tx->packet.header.length);
+    m_stats.tx++;
+    m_stats.airtime_us += airtime;
+
+    air_node_t* p_src = &mp_nodes[p_tx->src];
+    for (uint32_t i = 0; i < p_src->link_count; ++i)
+    {
+        uint32_t node = p_src->p_links[i].node;
+        air_node_t* p_node = &mp_nodes[node];
+        double rssi = p_tx->tx_power + p_src->p_links[i].gain_db;
+        if (rssi < m_config.sensitivity_dbm)
+        {
+            continue;
+        }
+
+        if (p_node->rx_tx != SIM_TX_NONE)
+        {
+            /* busy with another packet, which may not survive this one */
+            if (mp_txs[p_node->rx_tx].channel == p_tx->channel &&
+                rssi > p_node->rx_rssi - m_config.capture_db)
+            {
+                p_node->rx_corrupt = true;
+            }
+            m_stats.rx_missed++;
+        }
+        else if (p_node->listening &&
+                 p_node->channel == p_tx->channel &&
+                 (p_tx->access_address == RBC_MESH_ACCESS_ADDRESS_BLE_ADV ||
+                  p_tx->access_address == p_node->alt_access_address) &&
+                 p_node->listen_start <= sim_time_now())
+        {
+            p_node->rx_tx = tx;
+            p_node->rx_rssi = rssi;
+            p_node->rx_corrupt = is_interfered(node, tx, rssi);
+            sim_node_enter(node);
+            uint32_t error_code = host_radio_rx_sync();
+            sim_node_exit();
+            if (error_code != NRF_SUCCESS)
+            {
+                fprintf(stderr, "Node %u lost track of its RX (0x%x)\n", node, error_code);
+                abort();
+            }
+        }
+        else
+        {
+            m_stats.rx_missed++;
+        }
+    }
+
+    p_tx->active_index = m_active_count;
+    mp_active[m_active_count++] = tx;
+
+    sim_event_t evt = {.time = sim_time_now() + airtime, .type = SIM_EVENT_TX_END, .node = p_tx->src, .param = tx};
+    sim_queue_push(&evt);
+}
+
+static void tx_end(uint32_t tx)
+{
+    sim_tx_t* p_tx = &mp_txs[tx];
+
+    /* off air */
+    mp_active[p_tx->active_index] = mp_active[--m_active_count];
+    mp_txs[mp_active[p_tx->active_index]].active_index = p_tx->active_index;
+
+    air_node_t* p_src = &mp_nodes[p_tx->src];
+    for (uint32_t i = 0; i < p_src->link_count; ++i)
+    {
+        uint32_t node = p_src->p_links[i].node;
+        air_node_t* p_node = &mp_nodes[node];
+        if (p_node->rx_tx != tx)
+        {
+            continue;
+        }
+        p_node->rx_tx = SIM_TX_NONE;
+        p_node->listening = false;
+
+        bool crc_ok = false;
+        if (p_node->rx_corrupt)
+        {
+            m_stats.rx_collision++;
+        }
+        else if (rand_uniform() < m_config.crc_fail_rate)
+        {
+            m_stats.rx_crc_fail++;
+        }
+        else
+        {
+            m_stats.rx_ok++;
+            crc_ok = true;
+        }
+
+        sim_node_enter(node);
+        uint32_t error_code = host_radio_rx(&p_tx->packet, crc_ok, (uint8_t) -p_node->rx_rssi);
+        sim_node_exit();
+        if (error_code != NRF_SUCCESS)
+        {
+            fprintf(stderr, "Node %u couldn't receive (0x%x)\n", node, error_code);
+            abort();
+        }
+    }
+
+    uint32_t src = p_tx->src;
+    tx_free(tx);
+    sim_node_enter(src);
+    (void) host_radio_tx_end();
+    sim_node_exit();
+}
+
+/*****************************************************************************
+* Radio callbacks, called from the entered node's RADIO IRQ
+*****************************************************************************/
+static void air_tx_start(const mesh_packet_t* p_packet, uint8_t channel, uint32_t access_address, uint8_t tx_power)
+{
+    uint32_t tx = tx_alloc();
+    sim_tx_t* p_tx = &mp_txs[tx];
+    memcpy(&p_tx->packet, p_packet, sizeof(mesh_packet_t));
+    p_tx->src = sim_node_current_get();
+    p_tx->channel = channel;
+    p_tx->access_address = access_address;
+    p_tx->tx_power = (int8_t) tx_power;
+
+    sim_event_t evt = {.time = sim_time_now() + RADIO_RAMP_UP_US, .type = SIM_EVENT_TX_BEGIN, .node = p_tx->src, .param = tx};
+    sim_queue_push(&evt);
+}
+
+static void air_rx_start(uint8_t channel, uint32_t alt_access_address)
+{
+    air_node_t* p_node = &mp_nodes[sim_node_current_get()];
+    p_node->listening = true;
+    p_node->channel = channel;
+    p_node->alt_access_address = alt_access_address;
+    p_node->listen_start = sim_time_now() + RADIO_RAMP_UP_US;
+}
+
+static void air_rx_stop(void)
+{
+    mp_nodes[sim_node_current_get()].listening = false;
+}
+
+static const host_radio_air_t m_air =
+{
+    .tx_start = air_tx_start,
+    .rx_start = air_rx_start,
+    .rx_stop = air_rx_stop,
+};
+
+/*****************************************************************************
+* Interface functions
+*****************************************************************************/
+void sim_air_init(uint32_t node_count, const sim_air_config_t* p_config)
+{
+    m_config = *p_config;
+    m_node_count = node_count;
+    m_rand = hash32(p_config->seed) | 1;
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    mp_nodes = alloc_or_exit(NULL, node_count * sizeof(air_node_t));
+    memset(mp_nodes, 0, node_count * sizeof(air_node_t));
+    for (uint32_t i = 0; i < node_count; ++i)
+    {
+        mp_nodes[i].rx_tx = SIM_TX_NONE;
+    }
+    m_tx_free = SIM_TX_NONE;
+
+    nodes_place();
+    links_compute();
+}
+
+const host_radio_air_t* sim_air_radio_get(void)
+{
+    return &m_air;
+}
+
+void sim_air_event_handle(const sim_event_t* p_event)
+{
+    switch (p_event->type)
+    {
+        case SIM_EVENT_TX_BEGIN:
+            tx_begin(p_event->param);
+            break;
+        case SIM_EVENT_TX_END:
+            tx_end(p_event->param);
+            break;
+        default:
+            break;
+    }
+}
+
+void sim_air_stats_get(sim_air_stats_t* p_stats)
+{
+    *p_stats = m_stats;
+}
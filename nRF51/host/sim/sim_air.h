@@ -0,0 +1,102 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#ifndef SIM_AIR_H__
+#define SIM_AIR_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "host_hal.h"
+#include "sim_queue.h"
+
+/**
+ * @defgroup SIM_AIR Simulated medium
+ * Shared medium for the radios of all simulated nodes. Nodes are placed in a
+ * plane, and the received signal strength of every link follows a log-distance
+ * path loss model with a fixed, per link shadowing term. A packet is received
+ * if the receiver listened on the packet's channel and access address when it
+ * went on air, its signal is above the sensitivity, no other transmission on
+ * the channel came within the capture threshold of it while it was on air,
+ * and it survived the random CRC failure rate.
+ * @{
+ */
+
+typedef enum
+{
+    SIM_TOPOLOGY_GRID,      /**< Square grid, spacing_m apart. */
+    SIM_TOPOLOGY_LINE,      /**< Straight line, spacing_m apart. */
+    SIM_TOPOLOGY_RANDOM,    /**< Uniformly placed in a square of area_m x area_m. */
+} sim_topology_t;
+
+typedef struct
+{
+    sim_topology_t topology;
+    double spacing_m;           /**< Distance between neighbors in grid and line topologies. */
+    double area_m;              /**< Side of the square in random topologies. */
+    double path_loss_1m_db;     /**< Path loss at 1 m. */
+    double path_loss_exponent;  /**< Path loss exponent, 2 for free space. */
+    double shadowing_db;        /**< Standard deviation of the per link shadowing. */
+    double sensitivity_dbm;     /**< Weakest signal that can be received. */
+    double capture_db;          /**< How much stronger than interference a packet must be to survive it. */
+    double crc_fail_rate;       /**< Probability of a CRC failure in an otherwise good reception. */
+    uint32_t seed;              /**< Seed for placement, shadowing and CRC failures. */
+} sim_air_config_t;
+
+typedef struct
+{
+    uint64_t tx;                /**< Packets transmitted. */
+    uint64_t airtime_us;        /**< Total time spent transmitting. */
+    uint64_t rx_ok;             /**< Packets received. */
+    uint64_t rx_collision;      /**< Packets received with CRC failures caused by interference. */
+    uint64_t rx_crc_fail;       /**< Packets received with random CRC failures. */
+    uint64_t rx_missed;         /**< Packets in range of a receiver that wasn't listening for them. */
+    uint64_t links;             /**< Directed links above the sensitivity at 0 dBm. */
+} sim_air_stats_t;
+
+/**
+ * Place the nodes, and compute the links between them.
+ *
+ * @param[in] node_count Number of nodes.
+ * @param[in] p_config Medium configuration.
+ */
+void sim_air_init(uint32_t node_count, const sim_air_config_t* p_config);
+
+/** Get the medium to give the nodes' radios, see host_radio_air_set(). */
+const host_radio_air_t* sim_air_radio_get(void);
+
+/** Handle a SIM_EVENT_TX_BEGIN or SIM_EVENT_TX_END event. */
+void sim_air_event_handle(const sim_event_t* p_event);
+
+/** Get the medium statistics. */
+void sim_air_stats_get(sim_air_stats_t* p_stats);
+
+/** @} */
+
+#endif /* SIM_AIR_H__ */
@@ -0,0 +1,201 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#include "sim_node.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim_queue.h"
+#include "version_handler.h"
+#include "transport_control.h"
+#include "timer_scheduler.h"
+#include "event_handler.h"
+#include "mesh_packet.h"
+#include "mesh_stats.h"
+#include "timeslot.h"
+#include "nrf_error.h"
+
+#define TIMER_WAKEUP_NONE   (UINT64_MAX)
+
+typedef struct
+{
+    uint8_t* p_state;       /**< The node's copy of the stack's static data. */
+    uint64_t timer_wakeup;  /**< Time of the node's queued timer event. */
+} sim_node_t;
+
+/* Bounds of the stack's static data, provided by the linker. */
+extern uint8_t __start_mesh_node_state[];
+extern uint8_t __stop_mesh_node_state[];
+
+/*****************************************************************************
+* Static globals
+*****************************************************************************/
+static sim_node_t*              mp_nodes;
+static uint32_t                 m_node_count;
+/** Node whose state is in the mesh_node_state section. */
+static uint32_t                 m_loaded_node = SIM_NODE_NONE;
+/** Node between sim_node_enter() and sim_node_exit(). */
+static uint32_t                 m_current_node = SIM_NODE_NONE;
+static sim_node_app_evt_cb_t    m_app_evt_cb;
+
+/*****************************************************************************
+* Static functions
+*****************************************************************************/
+static uint32_t state_size(void)
+{
+    return (uint32_t) (__stop_mesh_node_state - __start_mesh_node_state);
+}
+
+static void state_load(uint32_t node)
+{
+    if (m_loaded_node == node)
+    {
+        return;
+    }
+    if (m_loaded_node != SIM_NODE_NONE)
+    {
+        memcpy(mp_nodes[m_loaded_node].p_state, __start_mesh_node_state, state_size());
+    }
+    memcpy(__start_mesh_node_state, mp_nodes[node].p_state, state_size());
+    m_loaded_node = node;
+}
+
+static void app_error_hook(uint32_t error_code, uint32_t line_num, const uint8_t* p_file_name)
+{
+    fprintf(stderr, "APP ERROR 0x%x at %s:%u on node %u, %llu us\n",
+            error_code, (const char*) p_file_name, line_num, m_current_node,
+            (unsigned long long) sim_time_now());
+    abort();
+}
+
+#define NODE_ERROR_CHECK(error_code) do { if ((error_code) != NRF_SUCCESS) { app_error_hook((error_code), __LINE__, (const uint8_t*) __FILE__); } } while (0)
+
+static void stack_init(uint32_t node, const sim_node_config_t* p_config, const host_radio_air_t* p_air)
+{
+    /* Same bring-up as rbc_mesh_init(), minus the SoftDevice */
+    host_hal_init(p_config->seed + node);
+    host_app_error_hook_set(app_error_hook);
+    host_radio_air_set(p_air);
+    mesh_stats_init();
+    NODE_ERROR_CHECK(timer_sch_init());
+    event_handler_init();
+    mesh_packet_init();
+    tc_init(p_config->access_address, p_config->channel, RBC_MESH_RADIO_MODE_BLE_1MBIT);
+    NODE_ERROR_CHECK(vh_init(p_config->interval_min_us, p_config->access_address, p_config->channel, RBC_MESH_TXPOWER_0dBm));
+    NODE_ERROR_CHECK(timeslot_init(NRF_CLOCK_LFCLKSRC_XTAL_20_PPM));
+    NODE_ERROR_CHECK(timeslot_resume());
+}
+
+/*****************************************************************************
+* Interface functions
+*****************************************************************************/
+void sim_nodes_init(uint32_t count, const sim_node_config_t* p_config, const host_radio_air_t* p_air, sim_node_app_evt_cb_t app_evt_cb)
+{
+    m_app_evt_cb = app_evt_cb;
+    m_node_count = count;
+    mp_nodes = calloc(count, sizeof(sim_node_t));
+    uint8_t* p_states = malloc((size_t) count * state_size());
+    if (mp_nodes == NULL || p_states == NULL)
+    {
+        fprintf(stderr, "Out of memory for %u nodes\n", count);
+        exit(EXIT_FAILURE);
+    }
+
+    /* every node starts from the stack's power-on state */
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        mp_nodes[i].p_state = &p_states[(size_t) i * state_size()];
+        memcpy(mp_nodes[i].p_state, __start_mesh_node_state, state_size());
+        mp_nodes[i].timer_wakeup = TIMER_WAKEUP_NONE;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        sim_node_enter(i);
+        stack_init(i, p_config, p_air);
+        sim_node_exit();
+    }
+}
+
+uint32_t sim_node_state_size_get(void)
+{
+    return state_size();
+}
+
+uint32_t sim_node_current_get(void)
+{
+    return m_current_node;
+}
+
+void sim_node_enter(uint32_t node)
+{
+    state_load(node);
+    m_current_node = node;
+    host_timer_run_until((timestamp_t) sim_time_now());
+}
+
+void sim_node_exit(void)
+{
+    uint32_t node = m_current_node;
+    host_hal_process();
+
+    rbc_mesh_event_t evt;
+    while (rbc_mesh_event_get(&evt) == NRF_SUCCESS)
+    {
+        m_app_evt_cb(node, &evt);
+        rbc_mesh_event_release(&evt);
+    }
+
+    timestamp_t timeout;
+    if (host_timer_next_timeout_get(&timeout))
+    {
+        uint64_t wakeup = sim_time_now() + (timestamp_t) (timeout - (timestamp_t) sim_time_now());
+        if (wakeup != mp_nodes[node].timer_wakeup)
+        {
+            /* earlier events for the node are dropped as stale */
+            mp_nodes[node].timer_wakeup = wakeup;
+            sim_event_t evt = {.time = wakeup, .type = SIM_EVENT_NODE_TIMER, .node = node};
+            sim_queue_push(&evt);
+        }
+    }
+    m_current_node = SIM_NODE_NONE;
+}
+
+void sim_node_timer_event_handle(uint32_t node)
+{
+    if (mp_nodes[node].timer_wakeup != sim_time_now())
+    {
+        return; /* stale */
+    }
+    mp_nodes[node].timer_wakeup = TIMER_WAKEUP_NONE;
+    sim_node_enter(node);
+    sim_node_exit();
+}
@@ -0,0 +1,99 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#ifndef SIM_NODE_H__
+#define SIM_NODE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "host_hal.h"
+#include "rbc_mesh.h"
+
+/**
+ * @defgroup SIM_NODE Simulated nodes
+ * Runs any number of copies of the mesh stack in one process. The stack and
+ * the host HAL are linked into a single object, with all their static data
+ * in the mesh_node_state section (see mesh_node.ld). Each node keeps its own
+ * copy of that section, which is swapped in when the simulator calls into
+ * the node, so the stack runs unmodified.
+ *
+ * Calls into a node's stack must be made between sim_node_enter() and
+ * sim_node_exit().
+ * @{
+ */
+
+#define SIM_NODE_NONE       (UINT32_MAX)
+
+/** Stack configuration, the same for all nodes. */
+typedef struct
+{
+    uint32_t interval_min_us;       /**< Trickle I_min. */
+    uint32_t access_address;        /**< Mesh access address. */
+    uint8_t channel;                /**< Mesh channel. */
+    uint32_t seed;                  /**< Seed for the nodes' HW RNGs, offset by the node index. */
+} sim_node_config_t;
+
+/** Called for every application event on a node, from sim_node_exit(). */
+typedef void (*sim_node_app_evt_cb_t)(uint32_t node, const rbc_mesh_event_t* p_evt);
+
+/**
+ * Bring up the stack on all nodes, at simulated time 0.
+ *
+ * @param[in] count Number of nodes.
+ * @param[in] p_config Stack configuration.
+ * @param[in] p_air Medium for the nodes' radios.
+ * @param[in] app_evt_cb Application event callback.
+ */
+void sim_nodes_init(uint32_t count, const sim_node_config_t* p_config, const host_radio_air_t* p_air, sim_node_app_evt_cb_t app_evt_cb);
+
+/** Size of each node's copy of the stack's static data. */
+uint32_t sim_node_state_size_get(void);
+
+/** Get the node whose stack is entered, SIM_NODE_NONE outside of sim_node_enter() and sim_node_exit(). */
+uint32_t sim_node_current_get(void);
+
+/**
+ * Swap in the given node's stack, and bring it up to the current simulated
+ * time, firing its expired timers.
+ */
+void sim_node_enter(uint32_t node);
+
+/**
+ * Leave the entered node. Hands its application events to the application
+ * event callback, and queues an event for its next timer.
+ */
+void sim_node_exit(void);
+
+/** Handle a SIM_EVENT_NODE_TIMER event. */
+void sim_node_timer_event_handle(uint32_t node);
+
+/** @} */
+
+#endif /* SIM_NODE_H__ */
@@ -0,0 +1,127 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#include "sim_queue.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+/* Binary min-heap, keyed on time and push order. */
+#define HEAP_PARENT(index)  (((index) - 1) / 2)
+#define HEAP_LEFT(index)    (2 * (index) + 1)
+
+/*****************************************************************************
+* Static globals
+*****************************************************************************/
+static sim_event_t* mp_heap;
+static uint32_t     m_size;
+static uint32_t     m_capacity;
+static uint64_t     m_seq;
+static uint64_t     m_time;
+
+/*****************************************************************************
+* Static functions
+*****************************************************************************/
+static bool event_before(const sim_event_t* p_a, const sim_event_t* p_b)
+{
+    return (p_a->time < p_b->time || (p_a->time == p_b->time && p_a->seq < p_b->seq));
+}
+
+static void heap_swap(uint32_t a, uint32_t b)
+{
+    sim_event_t temp = mp_heap[a];
+    mp_heap[a] = mp_heap[b];
+    mp_heap[b] = temp;
+}
+
+/*****************************************************************************
+* Interface functions
+*****************************************************************************/
+void sim_queue_init(void)
+{
+    m_size = 0;
+    m_seq = 0;
+    m_time = 0;
+}
+
+void sim_queue_push(sim_event_t* p_event)
+{
+    if (m_size == m_capacity)
+    {
+        m_capacity = (m_capacity ? 2 * m_capacity : 1024);
+        mp_heap = realloc(mp_heap, m_capacity * sizeof(sim_event_t));
+        if (mp_heap == NULL)
+        {
+            fprintf(stderr, "Out of memory for %u events\n", m_capacity);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    p_event->seq = m_seq++;
+    uint32_t index = m_size++;
+    mp_heap[index] = *p_event;
+    while (index > 0 && event_before(&mp_heap[index], &mp_heap[HEAP_PARENT(index)]))
+    {
+        heap_swap(index, HEAP_PARENT(index));
+        index = HEAP_PARENT(index);
+    }
+}
+
+bool sim_queue_pop(sim_event_t* p_event)
+{
+    if (m_size == 0)
+    {
+        return false;
+    }
+    *p_event = mp_heap[0];
+    m_time = p_event->time;
+    mp_heap[0] = mp_heap[--m_size];
+
+    uint32_t index = 0;
+    while (HEAP_LEFT(index) < m_size)
+    {
+        uint32_t child = HEAP_LEFT(index);
+        if (child + 1 < m_size && event_before(&mp_heap[child + 1], &mp_heap[child]))
+        {
+            child++;
+        }
+        if (!event_before(&mp_heap[child], &mp_heap[index]))
+        {
+            break;
+        }
+        heap_swap(index, child);
+        index = child;
+    }
+    return true;
+}
+
+uint64_t sim_time_now(void)
+{
+    return m_time;
+}
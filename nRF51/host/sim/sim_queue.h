@@ -0,0 +1,79 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#ifndef SIM_QUEUE_H__
+#define SIM_QUEUE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @defgroup SIM_QUEUE Simulator event queue
+ * Time ordered queue of discrete simulator events. Events at the same time
+ * are popped in the order they were pushed, which keeps every run with the
+ * same seed identical.
+ * @{
+ */
+
+typedef enum
+{
+    SIM_EVENT_NODE_TIMER,   /**< A node's earliest timer expires. */
+    SIM_EVENT_TX_BEGIN,     /**< A node's transmission goes on air, after the radio ramp-up. */
+    SIM_EVENT_TX_END,       /**< A transmission goes off air. */
+    SIM_EVENT_UPDATE,       /**< The application on a node updates a value. */
+} sim_event_type_t;
+
+typedef struct
+{
+    uint64_t time;          /**< Simulated time in microseconds. */
+    uint64_t seq;           /**< Push order, set by the queue. */
+    sim_event_type_t type;
+    uint32_t node;          /**< Node the event happens on. */
+    uint32_t param;         /**< Event specific, the transmission for TX events, the update for updates. */
+} sim_event_t;
+
+/** Drop all events, and set the simulated time to 0. */
+void sim_queue_init(void);
+
+/** Queue an event, growing the queue as needed. */
+void sim_queue_push(sim_event_t* p_event);
+
+/**
+ * Pop the earliest event, and move the simulated time to it.
+ *
+ * @return Whether there was an event to pop.
+ */
+bool sim_queue_pop(sim_event_t* p_event);
+
+/** Simulated time in microseconds, the time of the last popped event. */
+uint64_t sim_time_now(void);
+
+/** @} */
+
+#endif /* SIM_QUEUE_H__ */
@@ -0,0 +1,117 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#include "host_hal.h"
+
+#include <stddef.h>
+
+#include "rbc_mesh.h"
+#include "fifo.h"
+#include "mesh_packet.h"
+#include "nrf_error.h"
+
+/* Application event queue, as managed by rbc_mesh.c on target. */
+static fifo_t               m_rbc_event_fifo;
+static rbc_mesh_event_t     m_rbc_event_buffer[RBC_MESH_APP_EVENT_QUEUE_LENGTH];
+
+void host_app_init(void)
+{
+    m_rbc_event_fifo.array_len = RBC_MESH_APP_EVENT_QUEUE_LENGTH;
+    m_rbc_event_fifo.elem_array = m_rbc_event_buffer;
+    m_rbc_event_fifo.elem_size = sizeof(rbc_mesh_event_t);
+    m_rbc_event_fifo.memcpy_fptr = NULL;
+    fifo_init(&m_rbc_event_fifo);
+}
+
+uint32_t rbc_mesh_event_push(rbc_mesh_event_t* p_event)
+{
+    if (p_event == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    uint32_t error_code = fifo_push(&m_rbc_event_fifo, p_event);
+    if (error_code != NRF_SUCCESS)
+    {
+        return error_code;
+    }
+
+    switch (p_event->type)
+    {
+        case RBC_MESH_EVENT_TYPE_NEW_VAL:
+        case RBC_MESH_EVENT_TYPE_UPDATE_VAL:
+        case RBC_MESH_EVENT_TYPE_CONFLICTING_VAL:
+            if (p_event->params.rx.p_data)
+            {
+                mesh_packet_ref_count_inc((mesh_packet_t*) p_event->params.rx.p_data); /* will be aligned by packet manager */
+            }
+            break;
+        case RBC_MESH_EVENT_TYPE_TX:
+            if (p_event->params.tx.p_data)
+            {
+                mesh_packet_ref_count_inc((mesh_packet_t*) p_event->params.tx.p_data); /* will be aligned by packet manager */
+            }
+            break;
+        default:
+            break;
+    }
+    return NRF_SUCCESS;
+}
+
+uint32_t rbc_mesh_event_get(rbc_mesh_event_t* p_evt)
+{
+    if (fifo_pop(&m_rbc_event_fifo, p_evt) != NRF_SUCCESS)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    return NRF_SUCCESS;
+}
+
+void rbc_mesh_event_release(rbc_mesh_event_t* p_evt)
+{
+    switch (p_evt->type)
+    {
+        case RBC_MESH_EVENT_TYPE_UPDATE_VAL:
+        case RBC_MESH_EVENT_TYPE_NEW_VAL:
+        case RBC_MESH_EVENT_TYPE_CONFLICTING_VAL:
+            if (p_evt->params.rx.p_data != NULL)
+            {
+                mesh_packet_ref_count_dec((mesh_packet_t*) p_evt->params.rx.p_data);
+            }
+            break;
+        case RBC_MESH_EVENT_TYPE_TX:
+            if (p_evt->params.tx.p_data != NULL)
+            {
+                mesh_packet_ref_count_dec((mesh_packet_t*) p_evt->params.tx.p_data);
+            }
+            break;
+        default:
+            break;
+    }
+}
@@ -0,0 +1,249 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#include "host_hal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "nrf.h"
+#include "app_error.h"
+#include "rand.h"
+#include "radio_control.h"
+#include "timer.h"
+
+typedef void (*host_irq_handler_t)(void);
+
+/* Same as the startup file on target: handlers not implemented by any module are NULL. */
+void UART0_IRQHandler(void)  __attribute__((weak));
+void GPIOTE_IRQHandler(void) __attribute__((weak));
+void RTC0_IRQHandler(void)   __attribute__((weak));
+void QDEC_IRQHandler(void)   __attribute__((weak));
+void SWI0_IRQHandler(void)   __attribute__((weak));
+void SWI1_IRQHandler(void)   __attribute__((weak));
+void SWI2_IRQHandler(void)   __attribute__((weak));
+
+/*****************************************************************************
+* Static globals
+*****************************************************************************/
+static NRF_GPIO_Type            m_gpio;
+static NRF_FICR_Type            m_ficr;
+static uint32_t                 m_primask;
+static uint32_t                 m_irq_enabled;
+static uint32_t                 m_irq_pending;
+static uint8_t                  m_irq_priority[IRQn__COUNT];
+static bool                     m_in_irq;
+static uint32_t                 m_rng_state;
+static host_app_error_hook_t    m_app_error_hook;
+
+NRF_GPIO_Type* NRF_GPIO = &m_gpio;
+NRF_FICR_Type* NRF_FICR = &m_ficr;
+
+/*****************************************************************************
+* Static functions
+*****************************************************************************/
+static host_irq_handler_t irq_handler_get(IRQn_Type irq)
+{
+    switch (irq)
+    {
+        /* owned by the SoftDevice, and forwarded to the mesh in the timeslot */
+        case RADIO_IRQn:    return radio_event_handler;
+        case TIMER0_IRQn:   return timer_event_handler;
+        case UART0_IRQn:    return UART0_IRQHandler;
+        case GPIOTE_IRQn:   return GPIOTE_IRQHandler;
+        case RTC0_IRQn:     return RTC0_IRQHandler;
+        case QDEC_IRQn:     return QDEC_IRQHandler;
+        case SWI0_IRQn:     return SWI0_IRQHandler;
+        case SWI1_IRQn:     return SWI1_IRQHandler;
+        case SWI2_IRQn:     return SWI2_IRQHandler;
+        default:            return NULL;
+    }
+}
+
+/** xorshift32, never returns 0 for a non-zero state. */
+static uint32_t rng_next(void)
+{
+    m_rng_state ^= m_rng_state << 13;
+    m_rng_state ^= m_rng_state >> 17;
+    m_rng_state ^= m_rng_state << 5;
+    return m_rng_state;
+}
+
+/*****************************************************************************
+* Core and NVIC emulation
+*****************************************************************************/
+uint32_t __disable_irq(void)
+{
+    uint32_t was_masked = m_primask;
+    m_primask = 1;
+    return was_masked;
+}
+
+void __enable_irq(void)
+{
+    m_primask = 0;
+    host_irq_process();
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+    m_irq_enabled |= (1UL << irq);
+    host_irq_process();
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq)
+{
+    m_irq_enabled &= ~(1UL << irq);
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type irq)
+{
+    m_irq_pending |= (1UL << irq);
+    host_irq_process();
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+    m_irq_pending &= ~(1UL << irq);
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority)
+{
+    m_irq_priority[irq] = priority;
+}
+
+/*****************************************************************************
+* SDK replacements
+*****************************************************************************/
+void app_error_handler(uint32_t error_code, uint32_t line_num, const uint8_t* p_file_name)
+{
+    if (m_app_error_hook != NULL)
+    {
+        m_app_error_hook(error_code, line_num, p_file_name);
+        return;
+    }
+    fprintf(stderr, "APP ERROR 0x%x at %s:%u\n", (unsigned) error_code,
+            (p_file_name ? (const char*) p_file_name : "?"), (unsigned) line_num);
+    abort();
+}
+
+uint32_t rand_hw_rng_get(uint8_t* p_result, uint16_t len)
+{
+    while (len)
+    {
+        p_result[--len] = (uint8_t) rng_next();
+    }
+    return NRF_SUCCESS;
+}
+
+/*****************************************************************************
+* Interface functions
+*****************************************************************************/
+void host_hal_init(uint32_t seed)
+{
+    /* IRQ enables are kept, as some modules (like the event handler) only
+       enable their IRQ on the first initialization */
+    m_primask = 0;
+    m_irq_pending = 0;
+    m_in_irq = false;
+    m_app_error_hook = NULL;
+
+    m_ficr.CODEPAGESIZE = 1024;
+    m_ficr.CODESIZE = 256;
+    m_ficr.DEVICEADDRTYPE = 1;
+    m_ficr.DEVICEADDR[0] = 0x5EED0000 | (seed & 0xFFFF);
+    m_ficr.DEVICEADDR[1] = 0xC0DE;
+
+    host_rng_seed(seed);
+    host_timer_init(0);
+    host_radio_init();
+    host_app_init();
+
+    NVIC_EnableIRQ(RADIO_IRQn);
+    NVIC_EnableIRQ(TIMER0_IRQn);
+}
+
+void host_hal_process(void)
+{
+    (void) host_irq_process();
+}
+
+void host_hal_run(uint32_t time_us)
+{
+    host_timer_run_until(timer_now() + time_us);
+}
+
+void host_app_error_hook_set(host_app_error_hook_t hook)
+{
+    m_app_error_hook = hook;
+}
+
+bool host_irq_process(void)
+{
+    if (m_in_irq || m_primask)
+    {
+        return false;
+    }
+
+    bool executed = false;
+    m_in_irq = true;
+    while (m_irq_pending & m_irq_enabled)
+    {
+        /* highest priority first, ties go to the lowest IRQ number */
+        uint32_t runnable = (m_irq_pending & m_irq_enabled);
+        IRQn_Type irq = (IRQn_Type) __builtin_ctz(runnable);
+        for (uint32_t i = irq + 1; i < IRQn__COUNT; ++i)
+        {
+            if ((runnable & (1UL << i)) && m_irq_priority[i] < m_irq_priority[irq])
+            {
+                irq = (IRQn_Type) i;
+            }
+        }
+        m_irq_pending &= ~(1UL << irq);
+
+        host_irq_handler_t handler = irq_handler_get(irq);
+        if (handler != NULL)
+        {
+            handler();
+            executed = true;
+        }
+    }
+    m_in_irq = false;
+    return executed;
+}
+
+bool host_irq_is_masked(void)
+{
+    return (m_primask != 0);
+}
+
+void host_rng_seed(uint32_t seed)
+{
+    m_rng_state = (seed ? seed : 0x6D2B79F5);
+}
@@ -0,0 +1,361 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#include "host_hal.h"
+
+#include <string.h>
+
+#include "radio_control.h"
+#include "timeslot.h"
+#include "rbc_mesh_common.h"
+#include "nrf_error.h"
+
+#define RADIO_QUEUE_INDEX(i)    ((m_radio_queue.head + (i)) % RBC_MESH_RADIO_QUEUE_LENGTH)
+
+/*****************************************************************************
+* Static globals
+*****************************************************************************/
+static struct
+{
+    radio_event_t entries[RBC_MESH_RADIO_QUEUE_LENGTH];
+    uint32_t head;
+    uint32_t length;
+} m_radio_queue;
+static radio_idle_cb_t  m_idle_cb;
+static radio_rx_cb_t    m_rx_cb;
+static radio_tx_cb_t    m_tx_cb;
+static uint32_t         m_alt_aa;
+/** The idle callback has been called, and nothing has been ordered since. */
+static bool             m_is_idle;
+/** A packet has been put in the buffer of the RX event at the head of the queue. */
+static bool             m_rx_pending;
+static bool             m_rx_crc_ok;
+static uint8_t          m_rx_rssi;
+static host_radio_tx_t  m_tx_log[HOST_RADIO_TX_LOG_LENGTH];
+static uint32_t         m_tx_count;
+/** Shared medium, NULL when transmissions complete immediately. */
+static const host_radio_air_t* mp_air;
+/** The TX event at the head of the queue has been put on air. */
+static bool             m_tx_started;
+/** The air has finished the started TX. */
+static bool             m_tx_done;
+/** The air has been told that the radio is listening. */
+static bool             m_rx_listening;
+/** The air has started giving the radio a packet, the RX can't be preempted. */
+static bool             m_rx_synced;
+
+/*****************************************************************************
+* Static functions
+*****************************************************************************/
+static radio_event_t* radio_queue_peek(uint32_t index)
+{
+    if (index >= m_radio_queue.length)
+    {
+        return NULL;
+    }
+    return &m_radio_queue.entries[RADIO_QUEUE_INDEX(index)];
+}
+
+static void radio_queue_pop(void)
+{
+    m_radio_queue.head = RADIO_QUEUE_INDEX(1);
+    m_radio_queue.length--;
+}
+
+static void tx_log(const radio_event_t* p_evt)
+{
+    host_radio_tx_t* p_log = &m_tx_log[m_tx_count % HOST_RADIO_TX_LOG_LENGTH];
+    memcpy(&p_log->packet, p_evt->packet_ptr, sizeof(mesh_packet_t));
+    p_log->timestamp = timer_now();
+    p_log->channel = p_evt->channel;
+    p_log->access_address = p_evt->access_address;
+    m_tx_count++;
+}
+
+/** BLE link layer CRC, over the header and payload. */
+static uint32_t ble_crc24(const mesh_packet_t* p_packet)
+{
+    const uint8_t* p_data = (const uint8_t*) p_packet;
+    uint32_t length = 2 + p_packet->header.length;
+    uint32_t crc = 0x555555;
+    for (uint32_t i = 0; i < length; ++i)
+    {
+        uint8_t byte = p_data[i];
+        for (uint32_t bit = 0; bit < 8; ++bit, byte >>= 1)
+        {
+            uint32_t feedback = ((crc >> 23) ^ byte) & 0x01;
+            crc = (crc << 1) & 0xFFFFFF;
+            if (feedback)
+            {
+                crc ^= 0x00065B;
+            }
+        }
+    }
+    return crc;
+}
+
+/*****************************************************************************
+* Interface functions
+*****************************************************************************/
+void radio_init(radio_idle_cb_t idle_cb,
+                radio_rx_cb_t   rx_cb,
+                radio_tx_cb_t   tx_cb)
+{
+    m_idle_cb = idle_cb;
+    m_rx_cb = rx_cb;
+    m_tx_cb = tx_cb;
+
+    if (m_radio_queue.length == 0)
+    {
+        m_is_idle = true;
+        m_idle_cb();
+    }
+    else if (timeslot_is_in_ts())
+    {
+        NVIC_SetPendingIRQ(RADIO_IRQn);
+    }
+}
+
+void radio_alt_aa_set(uint32_t access_address)
+{
+    m_alt_aa = access_address;
+}
+
+void radio_mode_set(rbc_mesh_radio_mode_t radio_mode)
+{
+}
+
+uint32_t radio_order(radio_event_t* p_radio_event)
+{
+    if (p_radio_event == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    if (p_radio_event->event_type == RADIO_EVENT_TYPE_TX &&
+        p_radio_event->access_address > 1)
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+
+    if (m_radio_queue.length == RBC_MESH_RADIO_QUEUE_LENGTH)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    /* high priority events overtake everything but the head and other high priority events */
+    uint32_t index = m_radio_queue.length;
+    if (p_radio_event->priority == RADIO_EVENT_PRIORITY_HIGH)
+    {
+        while (index > 1 &&
+               radio_queue_peek(index - 1)->priority == RADIO_EVENT_PRIORITY_NORMAL &&
+               radio_queue_peek(index - 1)->event_type != RADIO_EVENT_TYPE_RX)
+        {
+            index--;
+        }
+    }
+
+    for (uint32_t i = m_radio_queue.length; i > index; --i)
+    {
+        m_radio_queue.entries[RADIO_QUEUE_INDEX(i)] = m_radio_queue.entries[RADIO_QUEUE_INDEX(i - 1)];
+    }
+    m_radio_queue.entries[RADIO_QUEUE_INDEX(index)] = *p_radio_event;
+    m_radio_queue.length++;
+    m_is_idle = false;
+
+    if (timeslot_is_in_ts())
+    {
+        NVIC_SetPendingIRQ(RADIO_IRQn);
+    }
+    return NRF_SUCCESS;
+}
+
+void radio_disable(void)
+{
+}
+
+void radio_event_handler(void)
+{
+    if (!timeslot_is_in_ts() || m_idle_cb == NULL)
+    {
+        return;
+    }
+
+    while (true)
+    {
+        radio_event_t* p_evt = radio_queue_peek(0);
+        if (p_evt == NULL)
+        {
+            if (m_is_idle)
+            {
+                break;
+            }
+            m_is_idle = true;
+            m_idle_cb();
+        }
+        else if (p_evt->event_type == RADIO_EVENT_TYPE_TX)
+        {
+            if (mp_air != NULL && !m_tx_started)
+            {
+                tx_log(p_evt);
+                m_tx_started = true;
+                mp_air->tx_start((mesh_packet_t*) p_evt->packet_ptr,
+                                 p_evt->channel,
+                                 (p_evt->access_address == 0 ? RBC_MESH_ACCESS_ADDRESS_BLE_ADV : m_alt_aa),
+                                 p_evt->tx_power);
+                break;
+            }
+            if (mp_air != NULL && !m_tx_done)
+            {
+                /* on air */
+                break;
+            }
+            if (mp_air == NULL)
+            {
+                tx_log(p_evt);
+            }
+
+            uint8_t* p_packet = p_evt->packet_ptr;
+            m_tx_started = false;
+            m_tx_done = false;
+            radio_queue_pop();
+            m_tx_cb(p_packet);
+        }
+        else if (m_rx_pending)
+        {
+            uint8_t* p_packet = p_evt->packet_ptr;
+            uint32_t crc = ble_crc24((mesh_packet_t*) p_packet);
+            m_rx_pending = false;
+            radio_queue_pop();
+            m_rx_cb(p_packet, m_rx_crc_ok, (m_rx_crc_ok ? crc : crc ^ 0x000001), m_rx_rssi);
+        }
+        else if (p_evt->event_type == RADIO_EVENT_TYPE_RX_PREEMPTABLE &&
+                 m_radio_queue.length > 1 &&
+                 !m_rx_synced)
+        {
+            uint8_t* p_packet = p_evt->packet_ptr;
+            if (m_rx_listening)
+            {
+                m_rx_listening = false;
+                mp_air->rx_stop();
+            }
+            radio_queue_pop();
+            m_rx_cb(p_packet, false, 0xFFFFFFFF, 100);
+        }
+        else
+        {
+            /* listening */
+            if (mp_air != NULL && !m_rx_listening)
+            {
+                m_rx_listening = true;
+                mp_air->rx_start(p_evt->channel, m_alt_aa);
+            }
+            break;
+        }
+    }
+}
+
+void host_radio_init(void)
+{
+    m_radio_queue.head = 0;
+    m_radio_queue.length = 0;
+    m_idle_cb = NULL;
+    m_rx_cb = NULL;
+    m_tx_cb = NULL;
+    m_alt_aa = RBC_MESH_ACCESS_ADDRESS_BLE_ADV;
+    m_is_idle = false;
+    m_rx_pending = false;
+    m_tx_count = 0;
+    mp_air = NULL;
+    m_tx_started = false;
+    m_tx_done = false;
+    m_rx_listening = false;
+    m_rx_synced = false;
+}
+
+void host_radio_air_set(const host_radio_air_t* p_air)
+{
+    mp_air = p_air;
+}
+
+uint32_t host_radio_rx(const mesh_packet_t* p_packet, bool crc_ok, uint8_t rssi)
+{
+    radio_event_t* p_evt = radio_queue_peek(0);
+    if (!timeslot_is_in_ts() ||
+        p_evt == NULL ||
+        p_evt->event_type == RADIO_EVENT_TYPE_TX ||
+        m_rx_pending)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    memcpy(p_evt->packet_ptr, p_packet, sizeof(mesh_packet_t));
+    m_rx_listening = false;
+    m_rx_synced = false;
+    m_rx_crc_ok = crc_ok;
+    m_rx_rssi = rssi;
+    m_rx_pending = true;
+    NVIC_SetPendingIRQ(RADIO_IRQn);
+    return NRF_SUCCESS;
+}
+
+uint32_t host_radio_rx_sync(void)
+{
+    if (!m_rx_listening)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_rx_synced = true;
+    return NRF_SUCCESS;
+}
+
+uint32_t host_radio_tx_end(void)
+{
+    if (!m_tx_started || m_tx_done)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_tx_done = true;
+    NVIC_SetPendingIRQ(RADIO_IRQn);
+    return NRF_SUCCESS;
+}
+
+uint32_t host_radio_tx_count_get(void)
+{
+    return m_tx_count;
+}
+
+const host_radio_tx_t* host_radio_tx_get(uint32_t index)
+{
+    if (index >= m_tx_count || m_tx_count - index > HOST_RADIO_TX_LOG_LENGTH)
+    {
+        return NULL;
+    }
+    return &m_tx_log[index % HOST_RADIO_TX_LOG_LENGTH];
+}
@@ -0,0 +1,224 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#include "host_hal.h"
+
+#include <stddef.h>
+
+#include "timer.h"
+#include "event_handler.h"
+#include "nrf_error.h"
+
+#define TIMER_COMPARE_COUNT     (3)
+
+/*****************************************************************************
+* Static globals
+*****************************************************************************/
+/** Callbacks for each timer, NULL when not ordered. */
+static timer_callback_t m_callbacks[TIMER_COMPARE_COUNT];
+/** Attributes given to each timer. */
+static timer_attr_t     m_attributes[TIMER_COMPARE_COUNT];
+/** Timestamps set for each timeout. */
+static timestamp_t      m_timeouts[TIMER_COMPARE_COUNT];
+/** Whether each timer has been ordered, with or without a callback. */
+static bool             m_is_ordered[TIMER_COMPARE_COUNT];
+/** Compare events, set when a timer expires and handled in the TIMER0 IRQ. */
+static bool             m_compare_events[TIMER_COMPARE_COUNT];
+/** Current virtual time. */
+static timestamp_t      m_time;
+
+/*****************************************************************************
+* Static functions
+*****************************************************************************/
+static uint32_t timer_order(uint8_t timer, timestamp_t time, timer_callback_t callback, timer_attr_t attributes)
+{
+    if (timer >= TIMER_COMPARE_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    if ((attributes & (TIMER_ATTR_SYNCHRONOUS | TIMER_ATTR_TIMESLOT_LOCAL)) != attributes)
+    {
+        return NRF_ERROR_INVALID_FLAGS;
+    }
+
+    m_callbacks[timer] = callback;
+    m_timeouts[timer] = time;
+    m_attributes[timer] = attributes;
+    m_is_ordered[timer] = true;
+    m_compare_events[timer] = false;
+    return NRF_SUCCESS;
+}
+
+/** Get the earliest ordered timer, timeouts in the past count as now. */
+static bool timer_next_get(uint8_t* p_timer, timestamp_t* p_timeout)
+{
+    bool found = false;
+    for (uint8_t i = 0; i < TIMER_COMPARE_COUNT; ++i)
+    {
+        if (!m_is_ordered[i])
+        {
+            continue;
+        }
+        timestamp_t timeout = (TIMER_OLDER_THAN(m_timeouts[i], m_time) ? m_time : m_timeouts[i]);
+        if (!found || timeout - m_time < *p_timeout - m_time)
+        {
+            *p_timer = i;
+            *p_timeout = timeout;
+            found = true;
+        }
+    }
+    return found;
+}
+
+/*****************************************************************************
+* Interface functions
+*****************************************************************************/
+void timer_event_handler(void)
+{
+    for (uint32_t i = 0; i < TIMER_COMPARE_COUNT; ++i)
+    {
+        if (!m_compare_events[i])
+        {
+            continue;
+        }
+        m_compare_events[i] = false;
+
+        timer_callback_t cb = m_callbacks[i];
+        m_callbacks[i] = NULL;
+        if (cb == NULL)
+        {
+            /* PPI only, or aborted after expiring */
+            continue;
+        }
+
+        if (m_attributes[i] & TIMER_ATTR_SYNCHRONOUS)
+        {
+            cb(m_time);
+        }
+        else
+        {
+            async_event_t evt;
+            evt.type = EVENT_TYPE_TIMER;
+            evt.callback.timer.cb = cb;
+            evt.callback.timer.timestamp = m_time;
+            event_handler_push(&evt);
+        }
+    }
+}
+
+uint32_t timer_order_cb(uint8_t timer,
+                        timestamp_t time,
+                        timer_callback_t callback,
+                        timer_attr_t attributes)
+{
+    return timer_order(timer, time, callback, attributes);
+}
+
+uint32_t timer_order_cb_ppi(uint8_t timer,
+                            timestamp_t time,
+                            timer_callback_t callback,
+                            uint32_t* p_task,
+                            timer_attr_t attributes)
+{
+    return timer_order(timer, time, callback, attributes);
+}
+
+uint32_t timer_order_ppi(uint8_t timer,
+                         timestamp_t time,
+                         uint32_t* p_task,
+                         timer_attr_t attributes)
+{
+    return timer_order(timer, time, NULL, attributes);
+}
+
+uint32_t timer_abort(uint8_t timer)
+{
+    if (timer >= TIMER_COMPARE_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    m_callbacks[timer] = NULL;
+    m_is_ordered[timer] = false;
+    m_compare_events[timer] = false;
+    return NRF_SUCCESS;
+}
+
+timestamp_t timer_now(void)
+{
+    return m_time;
+}
+
+void timer_on_ts_begin(timestamp_t timeslot_start_time)
+{
+}
+
+void timer_on_ts_end(timestamp_t timeslot_end_time)
+{
+    for (uint8_t i = 0; i < TIMER_COMPARE_COUNT; ++i)
+    {
+        if (m_attributes[i] & TIMER_ATTR_TIMESLOT_LOCAL)
+        {
+            m_callbacks[i] = NULL;
+            m_is_ordered[i] = false;
+        }
+    }
+}
+
+void host_timer_init(timestamp_t time)
+{
+    for (uint8_t i = 0; i < TIMER_COMPARE_COUNT; ++i)
+    {
+        m_callbacks[i] = NULL;
+        m_is_ordered[i] = false;
+        m_compare_events[i] = false;
+    }
+    m_time = time;
+}
+
+bool host_timer_next_timeout_get(timestamp_t* p_timeout)
+{
+    uint8_t timer;
+    return timer_next_get(&timer, p_timeout);
+}
+
+void host_timer_run_until(timestamp_t time)
+{
+    uint8_t timer;
+    timestamp_t timeout;
+    while (timer_next_get(&timer, &timeout) &&
+           timeout - m_time <= time - m_time)
+    {
+        m_time = timeout;
+        m_is_ordered[timer] = false;
+        m_compare_events[timer] = true;
+        NVIC_SetPendingIRQ(TIMER0_IRQn);
+    }
+    m_time = time;
+}
@@ -0,0 +1,119 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#include "host_hal.h"
+
+#include "timeslot.h"
+#include "timer.h"
+#include "event_handler.h"
+#include "transport_control.h"
+#include "radio_control.h"
+#include "nrf_error.h"
+
+/**
+ * The host never leaves the timeslot once it has been resumed, the radio is
+ * always available to the mesh.
+ */
+static bool         m_is_in_ts;
+static timestamp_t  m_start_time;
+
+static void timeslot_begin(void)
+{
+    m_is_in_ts = true;
+    m_start_time = timer_now();
+
+    /* notify other modules, same order as the timeslot START signal */
+    event_handler_on_ts_begin();
+    timer_on_ts_begin(m_start_time);
+    tc_on_ts_begin();
+}
+
+static void timeslot_end(void)
+{
+    radio_disable();
+    timer_on_ts_end(timer_now());
+    m_is_in_ts = false;
+}
+
+void timeslot_sd_event_handler(uint32_t evt)
+{
+}
+
+uint32_t timeslot_init(nrf_clock_lfclksrc_t lfclksrc)
+{
+    m_is_in_ts = false;
+    m_start_time = 0;
+    return NRF_SUCCESS;
+}
+
+void timeslot_stop(void)
+{
+    if (m_is_in_ts)
+    {
+        timeslot_end();
+    }
+}
+
+void timeslot_restart(void)
+{
+    if (m_is_in_ts)
+    {
+        timeslot_end();
+        timeslot_begin();
+    }
+}
+
+uint32_t timeslot_resume(void)
+{
+    if (!m_is_in_ts)
+    {
+        timeslot_begin();
+    }
+    return NRF_SUCCESS;
+}
+
+timestamp_t timeslot_start_time_get(void)
+{
+    return m_start_time;
+}
+
+timestamp_t timeslot_end_time_get(void)
+{
+    return timer_now() + timeslot_remaining_time_get();
+}
+
+timestamp_t timeslot_remaining_time_get(void)
+{
+    return (m_is_in_ts ? UINT32_MAX / 2 : 0);
+}
+
+bool timeslot_is_in_ts(void)
+{
+    return m_is_in_ts;
+}
@@ -0,0 +1,71 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#ifndef HOST_TEST_H__
+#define HOST_TEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Minimal assertion helpers for the host tests. A failing assertion prints
+ * its location and exits with a non-zero status, failing the ctest case.
+ */
+#define TEST_ASSERT(cond)                                                       \
+    do                                                                          \
+    {                                                                           \
+        if (!(cond))                                                            \
+        {                                                                       \
+            fprintf(stderr, "%s:%d: assertion failed: %s\n",                    \
+                    __FILE__, __LINE__, #cond);                                 \
+            exit(EXIT_FAILURE);                                                 \
+        }                                                                       \
+    } while (0)
+
+#define TEST_ASSERT_EQUAL(expected, actual)                                     \
+    do                                                                          \
+    {                                                                           \
+        long long _expected = (long long) (expected);                           \
+        long long _actual = (long long) (actual);                               \
+        if (_expected != _actual)                                               \
+        {                                                                       \
+            fprintf(stderr, "%s:%d: %s: expected %lld, got %lld\n",             \
+                    __FILE__, __LINE__, #actual, _expected, _actual);           \
+            exit(EXIT_FAILURE);                                                 \
+        }                                                                       \
+    } while (0)
+
+#define TEST_RUN(test)                                                          \
+    do                                                                          \
+    {                                                                           \
+        test();                                                                 \
+        printf("%s: OK\n", #test);                                              \
+    } while (0)
+
+#endif /* HOST_TEST_H__ */
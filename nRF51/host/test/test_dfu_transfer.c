@@ -0,0 +1,444 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+
+/**
+ * Tests for the incremental image hash in the bootloader's DFU transfer
+ * module. Transfers are run with lost and repeated segments, and with flash
+ * writes that complete late, and the bytes handed to sha256_update() are
+ * checked against the image in the bank, for plain, compressed and delta
+ * transfers. The compressed and delta streams are made by the small encoders
+ * below, in the format dfu_transfer_mesh.c documents.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "dfu_transfer_mesh.h"
+#include "dfu_types_mesh.h"
+#include "bootloader_app_bridge.h"
+#include "sha256.h"
+#include "nrf_error.h"
+
+#define TEST_IMAGE_SIZE         (8 * 1024)
+#define TEST_STREAM_SIZE_MAX    (TEST_IMAGE_SIZE + TEST_IMAGE_SIZE / 8 + 64)
+#define TEST_FLASH_QUEUE_LEN    (8)
+#define TEST_SEED_COUNT         (20)
+#define TEST_FILL_ROUNDS_MAX    (100000)
+
+#define LZ_WINDOW               (4096)
+#define LZ_MATCH_LENGTH_MIN     (3)
+#define LZ_MATCH_LENGTH_MAX     (LZ_MATCH_LENGTH_MIN + 15)
+#define LZ_SOURCE_LENGTH_MAX    (LZ_MATCH_LENGTH_MIN + 255)
+
+typedef enum
+{
+    TRANSFER_PLAIN,
+    TRANSFER_COMPRESSED,
+    TRANSFER_DELTA
+} transfer_type_t;
+
+typedef struct
+{
+    void*       p_dest;
+    const void* p_src;
+    uint32_t    length;
+} flash_write_t;
+
+typedef struct
+{
+    uint8_t     data[TEST_IMAGE_SIZE];
+    uint32_t    length;
+} hash_record_t;
+
+static uint8_t m_flash[4 * TEST_IMAGE_SIZE] __attribute__((aligned(PAGE_SIZE)));
+static uint8_t m_source[TEST_IMAGE_SIZE] __attribute__((aligned(PAGE_SIZE)));
+static uint8_t m_image[TEST_IMAGE_SIZE];
+static uint8_t m_stream[TEST_STREAM_SIZE_MAX];
+static uint32_t m_stream_size;
+
+static flash_write_t m_flash_queue[TEST_FLASH_QUEUE_LEN];
+static uint32_t m_flash_queue_len;
+static bool m_ended;
+static uint32_t m_rand;
+
+static sha256_context_t m_hash_context;
+static sha256_context_t m_other_hash_context;
+static hash_record_t m_hashed;
+static hash_record_t m_other_hashed;
+
+/*****************************************************************************
+* Bootloader functions used by dfu_transfer_mesh.c
+*****************************************************************************/
+uint32_t flash_write(void* p_dest, void* p_data, uint32_t length)
+{
+    TEST_ASSERT(((uint32_t) p_data & 0x03) == 0);
+    TEST_ASSERT((length & 0x03) == 0);
+    if (m_flash_queue_len == TEST_FLASH_QUEUE_LEN)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+    m_flash_queue[m_flash_queue_len].p_dest = p_dest;
+    m_flash_queue[m_flash_queue_len].p_src = p_data;
+    m_flash_queue[m_flash_queue_len].length = length;
+    m_flash_queue_len++;
+    return NRF_SUCCESS;
+}
+
+uint32_t flash_erase(void* p_dest, uint32_t length)
+{
+    TEST_ASSERT((uint8_t*) p_dest + length <= &m_flash[sizeof(m_flash)]);
+    memset(p_dest, 0xFF, length);
+    return NRF_SUCCESS;
+}
+
+void send_end_evt(dfu_end_t end_reason)
+{
+    m_ended = true;
+}
+
+uint32_t sha256_update(sha256_context_t* p_ctx, const uint8_t* p_data, size_t len)
+{
+    hash_record_t* p_record = (p_ctx == &m_hash_context) ? &m_hashed : &m_other_hashed;
+    TEST_ASSERT(p_record->length + len <= sizeof(p_record->data));
+    memcpy(&p_record->data[p_record->length], p_data, len);
+    p_record->length += len;
+    return NRF_SUCCESS;
+}
+
+/*****************************************************************************
+* Helpers
+*****************************************************************************/
+static uint32_t rand_next(void)
+{
+    m_rand ^= m_rand << 13;
+    m_rand ^= m_rand >> 17;
+    m_rand ^= m_rand << 5;
+    return m_rand;
+}
+
+/** Complete the pending flash writes in order, the way the flash driver does. */
+static void flash_process(void)
+{
+    while (m_flash_queue_len > 0)
+    {
+        flash_write_t op = m_flash_queue[0];
+        memmove(&m_flash_queue[0], &m_flash_queue[1], --m_flash_queue_len * sizeof(flash_write_t));
+        memcpy(op.p_dest, op.p_src, op.length);
+        dfu_transfer_flash_write_complete((uint8_t*) op.p_src);
+    }
+}
+
+/** Firmware-like image: runs of repeated instruction patterns between noise. */
+static void image_generate(uint8_t* p_image, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; )
+    {
+        uint32_t run = 16 + rand_next() % 64;
+        uint32_t pattern = rand_next();
+        bool repeat = (rand_next() & 0x03) != 0;
+        for (uint32_t j = 0; j < run && i < length; ++j, ++i)
+        {
+            p_image[i] = repeat ? (uint8_t) (pattern >> (8 * (j & 0x03))) : (uint8_t) rand_next();
+        }
+    }
+}
+
+static uint32_t match_length_get(const uint8_t* p_a, const uint8_t* p_b, uint32_t max)
+{
+    uint32_t length = 0;
+    while (length < max && p_a[length] == p_b[length])
+    {
+        length++;
+    }
+    return length;
+}
+
+/** Appends an item to the stream, starting a new flag byte every 8 items. */
+static void stream_item_add(uint32_t* p_flag_pos, uint32_t* p_flag_count, bool literal)
+{
+    if (*p_flag_count == 8)
+    {
+        *p_flag_pos = m_stream_size++;
+        m_stream[*p_flag_pos] = 0;
+        *p_flag_count = 0;
+    }
+    if (literal)
+    {
+        m_stream[*p_flag_pos] |= (1 << *p_flag_count);
+    }
+    (*p_flag_count)++;
+}
+
+/** Pads the stream to whole words with erased flash, dfu_transfer_data() only takes whole words. */
+static void stream_pad(void)
+{
+    while (m_stream_size & 0x03)
+    {
+        m_stream[m_stream_size++] = 0xFF;
+    }
+}
+
+static void lz_compress(const uint8_t* p_in, uint32_t length)
+{
+    uint32_t flag_pos = 0;
+    uint32_t flag_count = 8;
+    m_stream_size = 0;
+    for (uint32_t i = 0; i < length; )
+    {
+        uint32_t best_length = 0;
+        uint32_t best_distance = 0;
+        uint32_t max = length - i < LZ_MATCH_LENGTH_MAX ? length - i : LZ_MATCH_LENGTH_MAX;
+        for (uint32_t distance = 1; distance <= LZ_WINDOW && distance <= i; ++distance)
+        {
+            uint32_t match = match_length_get(&p_in[i - distance], &p_in[i], max);
+            if (match > best_length)
+            {
+                best_length = match;
+                best_distance = distance;
+            }
+        }
+        if (best_length >= LZ_MATCH_LENGTH_MIN)
+        {
+            stream_item_add(&flag_pos, &flag_count, false);
+            m_stream[m_stream_size++] = (uint8_t) (best_distance - 1);
+            m_stream[m_stream_size++] = (uint8_t) ((((best_distance - 1) >> 8) << 4) | (best_length - LZ_MATCH_LENGTH_MIN));
+            i += best_length;
+        }
+        else
+        {
+            stream_item_add(&flag_pos, &flag_count, true);
+            m_stream[m_stream_size++] = p_in[i++];
+        }
+    }
+    stream_pad();
+}
+
+static void delta_encode(const uint8_t* p_in, uint32_t length, const uint8_t* p_source, uint32_t source_length)
+{
+    dfu_delta_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.source_length = source_length;
+    memcpy(m_stream, &header, sizeof(header));
+    m_stream_size = sizeof(header);
+
+    uint32_t flag_pos = 0;
+    uint32_t flag_count = 8;
+    for (uint32_t i = 0; i < length; )
+    {
+        uint32_t best_length = 0;
+        uint32_t best_offset = 0;
+        uint32_t max = length - i < LZ_SOURCE_LENGTH_MAX ? length - i : LZ_SOURCE_LENGTH_MAX;
+        for (uint32_t offset = 0; offset < source_length; ++offset)
+        {
+            uint32_t source_max = source_length - offset < max ? source_length - offset : max;
+            uint32_t match = match_length_get(&p_source[offset], &p_in[i], source_max);
+            if (match > best_length)
+            {
+                best_length = match;
+                best_offset = offset;
+            }
+        }
+        if (best_length >= LZ_MATCH_LENGTH_MIN)
+        {
+            stream_item_add(&flag_pos, &flag_count, false);
+            m_stream[m_stream_size++] = (uint8_t) best_offset;
+            m_stream[m_stream_size++] = (uint8_t) (best_offset >> 8);
+            m_stream[m_stream_size++] = (uint8_t) (best_offset >> 16);
+            m_stream[m_stream_size++] = (uint8_t) (best_length - LZ_MATCH_LENGTH_MIN);
+            i += best_length;
+        }
+        else
+        {
+            stream_item_add(&flag_pos, &flag_count, true);
+            m_stream[m_stream_size++] = p_in[i++];
+        }
+    }
+    stream_pad();
+}
+
+static uint32_t segment_send(uint16_t segment)
+{
+    uint32_t addr = SEGMENT_ADDR(segment, m_flash);
+    uint32_t offset = addr - (uint32_t) m_flash;
+    uint32_t length = m_stream_size - offset;
+    if (length > SEGMENT_LENGTH)
+    {
+        length = SEGMENT_LENGTH;
+    }
+    return dfu_transfer_data(addr, &m_stream[offset], length);
+}
+
+/**
+ * Runs a transfer of the current stream. Segments are lost 30% of the time,
+ * are sometimes received twice, and flash writes complete in batches that
+ * lag behind the radio. Missing segments are filled through the oldest
+ * missing entry once the stream has ended.
+ */
+static void transfer_run(transfer_type_t type, uint32_t seed)
+{
+    m_rand = seed;
+    m_ended = false;
+    m_flash_queue_len = 0;
+    memset(&m_hashed, 0, sizeof(m_hashed));
+    memset(&m_other_hashed, 0, sizeof(m_other_hashed));
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dfu_transfer_start(
+                (uint32_t*) m_flash,
+                NULL,
+                (type == TRANSFER_PLAIN) ? m_stream_size : TEST_IMAGE_SIZE,
+                (type == TRANSFER_PLAIN) ? 0 : m_stream_size,
+                (type == TRANSFER_DELTA) ? (uint32_t*) m_source : NULL,
+                true));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dfu_transfer_sha256_start(&m_hash_context));
+
+    uint16_t segment_count = (m_stream_size + SEGMENT_LENGTH - 1) / SEGMENT_LENGTH;
+    for (uint16_t segment = 1; segment <= segment_count; ++segment)
+    {
+        if (rand_next() % 10 < 3)
+        {
+            continue;
+        }
+        segment_send(segment);
+        if (rand_next() % 3 == 0)
+        {
+            flash_process();
+        }
+        else if (segment_send(segment) == NRF_ERROR_BUSY)
+        {
+            flash_process();
+        }
+    }
+    flash_process();
+
+    for (uint32_t i = 0; i < TEST_FILL_ROUNDS_MAX && !m_ended; ++i)
+    {
+        uint32_t* p_entry;
+        uint32_t length;
+        if (!dfu_transfer_get_oldest_missing_entry(NULL, &p_entry, &length))
+        {
+            break;
+        }
+        segment_send(ADDR_SEGMENT(p_entry, m_flash));
+        flash_process();
+    }
+    TEST_ASSERT(!m_ended);
+}
+
+/** Checks that the image is in the bank, and that the hash got all of it, once and in order. */
+static void transfer_check(const uint8_t* p_image, uint32_t length)
+{
+    TEST_ASSERT(dfu_transfer_is_complete());
+    TEST_ASSERT(memcmp(m_flash, p_image, length) == 0);
+
+    /* all of the image should have been hashed as it came in. */
+    TEST_ASSERT_EQUAL(length, m_hashed.length);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dfu_transfer_sha256(&m_hash_context));
+    TEST_ASSERT_EQUAL(length, m_hashed.length);
+    TEST_ASSERT(memcmp(m_hashed.data, p_image, length) == 0);
+    dfu_transfer_end();
+}
+
+/*****************************************************************************
+* Tests
+*****************************************************************************/
+static void test_hash_plain(void)
+{
+    for (uint32_t seed = 1; seed <= TEST_SEED_COUNT; ++seed)
+    {
+        m_rand = seed;
+        image_generate(m_image, TEST_IMAGE_SIZE);
+        memcpy(m_stream, m_image, TEST_IMAGE_SIZE);
+        m_stream_size = TEST_IMAGE_SIZE;
+        transfer_run(TRANSFER_PLAIN, seed);
+        transfer_check(m_image, TEST_IMAGE_SIZE);
+    }
+}
+
+static void test_hash_compressed(void)
+{
+    for (uint32_t seed = 1; seed <= TEST_SEED_COUNT; ++seed)
+    {
+        m_rand = seed;
+        image_generate(m_image, TEST_IMAGE_SIZE);
+        lz_compress(m_image, TEST_IMAGE_SIZE);
+        TEST_ASSERT(m_stream_size < TEST_IMAGE_SIZE);
+        transfer_run(TRANSFER_COMPRESSED, seed);
+        transfer_check(m_image, TEST_IMAGE_SIZE);
+    }
+}
+
+static void test_hash_delta(void)
+{
+    for (uint32_t seed = 1; seed <= TEST_SEED_COUNT; ++seed)
+    {
+        /* the new image is the installed one with a few words changed, and
+         * a block inserted in the middle. */
+        m_rand = seed;
+        image_generate(m_source, TEST_IMAGE_SIZE);
+        uint32_t insert_pos = TEST_IMAGE_SIZE / 2;
+        uint32_t insert_length = 256;
+        memcpy(m_image, m_source, insert_pos);
+        image_generate(&m_image[insert_pos], insert_length);
+        memcpy(&m_image[insert_pos + insert_length], &m_source[insert_pos], TEST_IMAGE_SIZE - insert_pos - insert_length);
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            m_image[(rand_next() % (TEST_IMAGE_SIZE / 4)) * 4] ^= 0x5A;
+        }
+        delta_encode(m_image, TEST_IMAGE_SIZE, m_source, TEST_IMAGE_SIZE);
+        TEST_ASSERT(m_stream_size < TEST_IMAGE_SIZE / 4);
+        transfer_run(TRANSFER_DELTA, seed);
+        transfer_check(m_image, TEST_IMAGE_SIZE);
+    }
+}
+
+static void test_hash_unregistered_context(void)
+{
+    m_rand = 1;
+    image_generate(m_image, TEST_IMAGE_SIZE);
+    lz_compress(m_image, TEST_IMAGE_SIZE);
+    transfer_run(TRANSFER_COMPRESSED, 1);
+
+    /* a context that wasn't passed to dfu_transfer_sha256_start() gets the
+     * whole image, without affecting the registered one. */
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, dfu_transfer_sha256(&m_other_hash_context));
+    TEST_ASSERT_EQUAL(TEST_IMAGE_SIZE, m_other_hashed.length);
+    TEST_ASSERT(memcmp(m_other_hashed.data, m_image, TEST_IMAGE_SIZE) == 0);
+    transfer_check(m_image, TEST_IMAGE_SIZE);
+}
+
+int main(void)
+{
+    TEST_RUN(test_hash_plain);
+    TEST_RUN(test_hash_compressed);
+    TEST_RUN(test_hash_delta);
+    TEST_RUN(test_hash_unregistered_context);
+    return 0;
+}
@@ -0,0 +1,99 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "host_hal.h"
+#include "event_handler.h"
+#include "mesh_packet.h"
+#include "timer_scheduler.h"
+#include "timeslot.h"
+#include "nrf_error.h"
+
+static uint32_t m_first_count;
+static uint32_t m_second_count;
+
+static void setup(void)
+{
+    host_hal_init(1);
+    event_handler_init();
+    mesh_packet_init();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_init());
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timeslot_init(NRF_CLOCK_LFCLKSRC_XTAL_20_PPM));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timeslot_resume());
+    m_first_count = 0;
+    m_second_count = 0;
+}
+
+static void timer_evt_push(timer_callback_t cb)
+{
+    async_event_t evt;
+    evt.type = EVENT_TYPE_TIMER;
+    evt.callback.timer.cb = cb;
+    evt.callback.timer.timestamp = timer_now();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, event_handler_push(&evt));
+}
+
+static void second_timer_cb(timestamp_t timestamp)
+{
+    m_second_count++;
+}
+
+/** The timeslot ends while the event executes, and a new one starts. */
+static void first_timer_cb(timestamp_t timestamp)
+{
+    m_first_count++;
+    event_handler_on_ts_end();
+    event_handler_on_ts_begin();
+    timer_evt_push(second_timer_cb);
+}
+
+static void test_ts_flush_during_event(void)
+{
+    setup();
+
+    timer_evt_push(first_timer_cb);
+    host_hal_process();
+    TEST_ASSERT_EQUAL(1, m_first_count);
+    /* the event pushed after the flush must not be lost */
+    TEST_ASSERT_EQUAL(1, m_second_count);
+
+    host_hal_process();
+    TEST_ASSERT_EQUAL(1, m_first_count);
+    TEST_ASSERT_EQUAL(1, m_second_count);
+}
+
+int main(void)
+{
+    TEST_RUN(test_ts_flush_during_event);
+    return 0;
+}
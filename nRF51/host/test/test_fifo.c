@@ -0,0 +1,180 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "host_hal.h"
+#include "fifo.h"
+#include "nrf_error.h"
+
+#define TEST_FIFO_LEN   (8)
+
+static uint32_t m_buffer[TEST_FIFO_LEN];
+static bool m_masked_during_copy;
+
+/** Element copy that records whether the fifo masked IRQs around it. */
+static void masking_memcpy(void* p_dest, const void* p_src)
+{
+    m_masked_during_copy = host_irq_is_masked();
+    memcpy(p_dest, p_src, sizeof(uint32_t));
+}
+
+static void fifo_setup(fifo_t* p_fifo, uint32_t array_len, bool spsc)
+{
+    memset(p_fifo, 0, sizeof(fifo_t));
+    p_fifo->elem_array = m_buffer;
+    p_fifo->elem_size = sizeof(uint32_t);
+    p_fifo->array_len = array_len;
+    p_fifo->memcpy_fptr = masking_memcpy;
+    p_fifo->spsc = spsc;
+    fifo_init(p_fifo);
+}
+
+static void test_push_pop_order(void)
+{
+    fifo_t fifo;
+    fifo_setup(&fifo, TEST_FIFO_LEN, false);
+    TEST_ASSERT(fifo_is_empty(&fifo));
+
+    for (uint32_t i = 0; i < TEST_FIFO_LEN; ++i)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, fifo_push(&fifo, &i));
+    }
+    TEST_ASSERT(fifo_is_full(&fifo));
+    uint32_t overflow = 0xFF;
+    TEST_ASSERT_EQUAL(NRF_ERROR_NO_MEM, fifo_push(&fifo, &overflow));
+    TEST_ASSERT_EQUAL(TEST_FIFO_LEN, fifo_get_len(&fifo));
+
+    uint32_t elem;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, fifo_peek_at(&fifo, &elem, 3));
+    TEST_ASSERT_EQUAL(3, elem);
+
+    for (uint32_t i = 0; i < TEST_FIFO_LEN; ++i)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, fifo_pop(&fifo, &elem));
+        TEST_ASSERT_EQUAL(i, elem);
+    }
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, fifo_pop(&fifo, &elem));
+}
+
+static void test_length_rounding(void)
+{
+    fifo_t fifo;
+    fifo_setup(&fifo, 6, false);
+    TEST_ASSERT_EQUAL(4, fifo.array_len);
+}
+
+static void test_wraparound(void)
+{
+    fifo_t fifo;
+    fifo_setup(&fifo, TEST_FIFO_LEN, false);
+
+    uint32_t next_push = 0;
+    uint32_t next_pop = 0;
+    for (uint32_t round = 0; round < 100; ++round)
+    {
+        for (uint32_t i = 0; i < 5; ++i, ++next_push)
+        {
+            TEST_ASSERT_EQUAL(NRF_SUCCESS, fifo_push(&fifo, &next_push));
+        }
+        for (uint32_t i = 0; i < 5; ++i, ++next_pop)
+        {
+            uint32_t elem;
+            TEST_ASSERT_EQUAL(NRF_SUCCESS, fifo_pop(&fifo, &elem));
+            TEST_ASSERT_EQUAL(next_pop, elem);
+        }
+    }
+    TEST_ASSERT(fifo_is_empty(&fifo));
+}
+
+static void test_reserve_commit_peek_release(void)
+{
+    fifo_t fifo;
+    fifo_setup(&fifo, TEST_FIFO_LEN, false);
+
+    uint32_t* p_elem = NULL;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, fifo_push_reserve(&fifo, (void**) &p_elem));
+    *p_elem = 0xABCD;
+    TEST_ASSERT(fifo_is_empty(&fifo));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, fifo_push_commit(&fifo));
+    TEST_ASSERT_EQUAL(1, fifo_get_len(&fifo));
+
+    uint32_t* p_popped = NULL;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, fifo_pop_peek_ptr(&fifo, (void**) &p_popped));
+    TEST_ASSERT(p_popped == p_elem);
+    TEST_ASSERT_EQUAL(0xABCD, *p_popped);
+    TEST_ASSERT_EQUAL(1, fifo_get_len(&fifo));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, fifo_pop_release(&fifo));
+    TEST_ASSERT(fifo_is_empty(&fifo));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NULL, fifo_pop_release(&fifo));
+}
+
+static void test_irq_masking(void)
+{
+    fifo_t fifo;
+    uint32_t elem = 1;
+
+    /* several producers, the fifo must mask IRQs while touching the queue */
+    fifo_setup(&fifo, TEST_FIFO_LEN, false);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, fifo_push(&fifo, &elem));
+    TEST_ASSERT(m_masked_during_copy);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, fifo_pop(&fifo, &elem));
+    TEST_ASSERT(m_masked_during_copy);
+    TEST_ASSERT(!host_irq_is_masked());
+
+    /* a caller that has masked IRQs itself must not get them unmasked */
+    uint32_t was_masked = __disable_irq();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, fifo_push(&fifo, &elem));
+    TEST_ASSERT(host_irq_is_masked());
+    if (!was_masked)
+    {
+        __enable_irq();
+    }
+
+    /* single producer, single consumer fifos run lock free */
+    fifo_setup(&fifo, TEST_FIFO_LEN, true);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, fifo_push(&fifo, &elem));
+    TEST_ASSERT(!m_masked_during_copy);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, fifo_pop(&fifo, &elem));
+    TEST_ASSERT(!m_masked_during_copy);
+}
+
+int main(void)
+{
+    host_hal_init(1);
+    TEST_RUN(test_push_pop_order);
+    TEST_RUN(test_length_rounding);
+    TEST_RUN(test_wraparound);
+    TEST_RUN(test_reserve_commit_peek_release);
+    TEST_RUN(test_irq_masking);
+    return 0;
+}
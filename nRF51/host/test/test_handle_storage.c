@@ -0,0 +1,230 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "host_test.h"
+#include "host_hal.h"
+#include "handle_storage.h"
+#include "mesh_packet.h"
+#include "event_handler.h"
+#include "timer.h"
+#include "rbc_mesh.h"
+#include "nrf_error.h"
+
+#define TEST_MIN_INTERVAL_US    (100000)
+
+static mesh_packet_t* packet_create(rbc_mesh_value_handle_t handle, uint16_t version)
+{
+    mesh_packet_t* p_packet = NULL;
+    uint8_t data[4] = {0x11, 0x22, 0x33, 0x44};
+    TEST_ASSERT(mesh_packet_acquire(&p_packet));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, mesh_packet_build(p_packet, handle, version, data, sizeof(data)));
+    return p_packet;
+}
+
+static void value_set(rbc_mesh_value_handle_t handle, uint16_t version)
+{
+    handle_info_t info;
+    info.version = version;
+    info.p_packet = packet_create(handle, version);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_info_set(handle, &info));
+    mesh_packet_ref_count_dec(info.p_packet); /* the storage holds its own reference */
+}
+
+static bool value_is_known(rbc_mesh_value_handle_t handle, uint16_t* p_version)
+{
+    handle_info_t info;
+    if (handle_storage_info_get(handle, &info) != NRF_SUCCESS)
+    {
+        return false;
+    }
+    if (info.p_packet != NULL)
+    {
+        mesh_packet_ref_count_dec(info.p_packet);
+    }
+    *p_version = info.version;
+    return true;
+}
+
+static void setup(void)
+{
+    host_hal_init(1);
+    event_handler_init();
+    mesh_packet_init();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_init(TEST_MIN_INTERVAL_US));
+}
+
+static void test_info_set_get(void)
+{
+    setup();
+
+    handle_info_t info;
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, handle_storage_info_get(1, &info));
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_ADDR, handle_storage_info_get(RBC_MESH_INVALID_HANDLE, &info));
+
+    for (uint16_t handle = 1; handle <= RBC_MESH_HANDLE_CACHE_ENTRIES; ++handle)
+    {
+        value_set(handle, handle + 100);
+    }
+    for (uint16_t handle = 1; handle <= RBC_MESH_HANDLE_CACHE_ENTRIES; ++handle)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_info_get(handle, &info));
+        TEST_ASSERT_EQUAL(handle + 100, info.version);
+        TEST_ASSERT(info.p_packet != NULL);
+        TEST_ASSERT_EQUAL(handle, mesh_packet_handle_get(info.p_packet));
+        /* one reference for the cache, one for us */
+        TEST_ASSERT_EQUAL(2, mesh_packet_ref_count_get(info.p_packet));
+        mesh_packet_ref_count_dec(info.p_packet);
+    }
+}
+
+static void test_eviction(void)
+{
+    setup();
+
+    for (uint16_t handle = 1; handle <= RBC_MESH_HANDLE_CACHE_ENTRIES; ++handle)
+    {
+        value_set(handle, 1);
+    }
+    /* updating a known handle doesn't allocate */
+    value_set(1, 2);
+    uint16_t version;
+    TEST_ASSERT(value_is_known(1, &version));
+    TEST_ASSERT_EQUAL(2, version);
+
+    /* a new handle takes over the oldest entry */
+    value_set(RBC_MESH_HANDLE_CACHE_ENTRIES + 1, 1);
+    TEST_ASSERT(!value_is_known(1, &version));
+    for (uint16_t handle = 2; handle <= RBC_MESH_HANDLE_CACHE_ENTRIES + 1; ++handle)
+    {
+        TEST_ASSERT(value_is_known(handle, &version));
+    }
+
+    /* evicted handles can come back */
+    value_set(1, 7);
+    TEST_ASSERT(value_is_known(1, &version));
+    TEST_ASSERT_EQUAL(7, version);
+    TEST_ASSERT(!value_is_known(2, &version));
+}
+
+static void test_persistent_not_evicted(void)
+{
+    setup();
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_flag_set(0x1234, HANDLE_FLAG_PERSISTENT, true));
+    value_set(0x1234, 5);
+    for (uint16_t handle = 1; handle <= 4 * RBC_MESH_HANDLE_CACHE_ENTRIES; ++handle)
+    {
+        value_set(handle, 1);
+    }
+
+    uint16_t version;
+    TEST_ASSERT(value_is_known(0x1234, &version));
+    TEST_ASSERT_EQUAL(5, version);
+
+    bool persistent = false;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_flag_get(0x1234, HANDLE_FLAG_PERSISTENT, &persistent));
+    TEST_ASSERT(persistent);
+}
+
+static void test_flags(void)
+{
+    setup();
+
+    bool value = true;
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_PARAM, handle_storage_flag_set(1, HANDLE_FLAG__MAX, true));
+    TEST_ASSERT_EQUAL(NRF_ERROR_INVALID_ADDR, handle_storage_flag_set(RBC_MESH_INVALID_HANDLE, HANDLE_FLAG_TX_EVENT, true));
+
+    value_set(1, 1);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_flag_get(1, HANDLE_FLAG_HIGH_PRIORITY, &value));
+    TEST_ASSERT(!value);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_flag_set(1, HANDLE_FLAG_HIGH_PRIORITY, true));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_flag_set(1, HANDLE_FLAG_TX_EVENT, true));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_flag_get(1, HANDLE_FLAG_HIGH_PRIORITY, &value));
+    TEST_ASSERT(value);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_flag_get(1, HANDLE_FLAG_TX_EVENT, &value));
+    TEST_ASSERT(value);
+
+    /* flags are cleared when the entry is reused for another handle */
+    for (uint16_t handle = 2; handle <= RBC_MESH_HANDLE_CACHE_ENTRIES + 1; ++handle)
+    {
+        value_set(handle, 1);
+    }
+    value_set(1, 1);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_flag_get(1, HANDLE_FLAG_HIGH_PRIORITY, &value));
+    TEST_ASSERT(!value);
+}
+
+static void test_tx_packets_get(void)
+{
+    setup();
+
+    value_set(1, 1);
+    value_set(2, 1);
+
+    /* nothing is due before the first half of I_min has passed */
+    mesh_packet_t* packets[RBC_MESH_DATA_CACHE_ENTRIES];
+    uint32_t count = RBC_MESH_DATA_CACHE_ENTRIES;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_tx_packets_get(timer_now(), packets, &count));
+    TEST_ASSERT_EQUAL(0, count);
+
+    bool found = false;
+    uint32_t timeout = handle_storage_next_timeout_get(&found);
+    TEST_ASSERT(found);
+    TEST_ASSERT(timeout >= TEST_MIN_INTERVAL_US / 2);
+    TEST_ASSERT(timeout < TEST_MIN_INTERVAL_US);
+
+    count = RBC_MESH_DATA_CACHE_ENTRIES;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_tx_packets_get(TEST_MIN_INTERVAL_US, packets, &count));
+    TEST_ASSERT_EQUAL(2, count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        rbc_mesh_value_handle_t handle = mesh_packet_handle_get(packets[i]);
+        TEST_ASSERT(handle == 1 || handle == 2);
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_transmitted(handle, TEST_MIN_INTERVAL_US));
+        mesh_packet_ref_count_dec(packets[i]);
+    }
+
+    /* the interval has doubled, nothing is due until the next one */
+    count = RBC_MESH_DATA_CACHE_ENTRIES;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, handle_storage_tx_packets_get(TEST_MIN_INTERVAL_US + 1, packets, &count));
+    TEST_ASSERT_EQUAL(0, count);
+}
+
+int main(void)
+{
+    TEST_RUN(test_info_set_get);
+    TEST_RUN(test_eviction);
+    TEST_RUN(test_persistent_not_evicted);
+    TEST_RUN(test_flags);
+    TEST_RUN(test_tx_packets_get);
+    return 0;
+}
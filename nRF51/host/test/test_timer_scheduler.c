@@ -0,0 +1,351 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "host_hal.h"
+#include "timer_scheduler.h"
+#include "event_handler.h"
+#include "mesh_packet.h"
+#include "timeslot.h"
+#include "nrf_error.h"
+
+/** Time in us the scheduler may fire early or late to group timers. */
+#define TEST_TIMER_MARGIN   (100)
+#define TEST_FIRES_MAX      (32)
+
+typedef struct
+{
+    timestamp_t timestamps[TEST_FIRES_MAX];
+    uint32_t count;
+} fire_log_t;
+
+static void timer_sch_cb(timestamp_t timestamp, void* p_context)
+{
+    fire_log_t* p_log = (fire_log_t*) p_context;
+    TEST_ASSERT(p_log->count < TEST_FIRES_MAX);
+    p_log->timestamps[p_log->count++] = timer_now();
+}
+
+static void timer_evt_init(timer_event_t* p_evt, fire_log_t* p_log, timestamp_t timestamp, timestamp_t interval)
+{
+    memset(p_evt, 0, sizeof(timer_event_t));
+    memset(p_log, 0, sizeof(fire_log_t));
+    p_evt->timestamp = timestamp;
+    p_evt->interval = interval;
+    p_evt->cb = timer_sch_cb;
+    p_evt->p_context = p_log;
+}
+
+static void assert_fired_at(const fire_log_t* p_log, uint32_t index, timestamp_t timestamp)
+{
+    TEST_ASSERT(index < p_log->count);
+    /* compare through the difference, the timestamps may wrap around */
+    int32_t diff = (int32_t) (p_log->timestamps[index] - timestamp);
+    TEST_ASSERT(diff >= -TEST_TIMER_MARGIN);
+    TEST_ASSERT(diff <= TEST_TIMER_MARGIN);
+}
+
+static void setup_at(timestamp_t start_time)
+{
+    host_hal_init(1);
+    host_timer_init(start_time);
+    event_handler_init();
+    mesh_packet_init();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_init());
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timeslot_init(NRF_CLOCK_LFCLKSRC_XTAL_20_PPM));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timeslot_resume());
+}
+
+static void setup(void)
+{
+    setup_at(0);
+}
+
+static void test_single_shot_order(void)
+{
+    setup();
+
+    timer_event_t evt_late, evt_early;
+    fire_log_t log_late, log_early;
+    timer_evt_init(&evt_late, &log_late, 10000, TIMER_EVENT_INTERVAL_SINGLE_SHOT);
+    timer_evt_init(&evt_early, &log_early, 5000, TIMER_EVENT_INTERVAL_SINGLE_SHOT);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evt_late));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evt_early));
+
+    host_hal_run(4000);
+    TEST_ASSERT_EQUAL(0, log_early.count);
+    host_hal_run(2000);
+    TEST_ASSERT_EQUAL(1, log_early.count);
+    TEST_ASSERT_EQUAL(0, log_late.count);
+    assert_fired_at(&log_early, 0, 5000);
+
+    host_hal_run(20000);
+    TEST_ASSERT_EQUAL(1, log_early.count);
+    TEST_ASSERT_EQUAL(1, log_late.count);
+    assert_fired_at(&log_late, 0, 10000);
+}
+
+static void test_periodic(void)
+{
+    setup();
+
+    timer_event_t evt;
+    fire_log_t log;
+    timer_evt_init(&evt, &log, 3000, 3000);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evt));
+
+    host_hal_run(19000);
+    TEST_ASSERT_EQUAL(6, log.count);
+    for (uint32_t i = 0; i < log.count; ++i)
+    {
+        assert_fired_at(&log, i, 3000 * (i + 1));
+    }
+
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_abort(&evt));
+    host_hal_run(20000);
+    TEST_ASSERT_EQUAL(6, log.count);
+}
+
+static void test_abort_reschedule(void)
+{
+    setup();
+
+    timer_event_t evt_abort, evt_move;
+    fire_log_t log_abort, log_move;
+    timer_evt_init(&evt_abort, &log_abort, 15000, TIMER_EVENT_INTERVAL_SINGLE_SHOT);
+    timer_evt_init(&evt_move, &log_move, 7000, TIMER_EVENT_INTERVAL_SINGLE_SHOT);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evt_abort));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evt_move));
+
+    host_hal_run(5000);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_abort(&evt_abort));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_reschedule(&evt_move, 17000));
+
+    host_hal_run(10000);
+    TEST_ASSERT_EQUAL(0, log_move.count);
+    host_hal_run(10000);
+    TEST_ASSERT_EQUAL(0, log_abort.count);
+    TEST_ASSERT_EQUAL(1, log_move.count);
+    assert_fired_at(&log_move, 0, 17000);
+}
+
+static void test_many_timers(void)
+{
+    setup();
+
+    /* timers scheduled in reverse order fire in timestamp order */
+    static timer_event_t evts[TEST_FIRES_MAX];
+    fire_log_t log;
+    memset(&log, 0, sizeof(log));
+    for (uint32_t i = 0; i < TEST_FIRES_MAX; ++i)
+    {
+        fire_log_t dummy;
+        timer_evt_init(&evts[i], &dummy, 1000 * (TEST_FIRES_MAX - i), TIMER_EVENT_INTERVAL_SINGLE_SHOT);
+        evts[i].p_context = &log;
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evts[i]));
+    }
+
+    host_hal_run(1000 * (TEST_FIRES_MAX + 1));
+    TEST_ASSERT_EQUAL(TEST_FIRES_MAX, log.count);
+    for (uint32_t i = 0; i < TEST_FIRES_MAX; ++i)
+    {
+        assert_fired_at(&log, i, 1000 * (i + 1));
+    }
+}
+
+static void test_far_timers(void)
+{
+    /* With the timing wheel, each of these starts out on a different level,
+       and cascades down through the levels below it before firing. */
+    static const timestamp_t offsets[] = {8525, 262921, 8389842, 268439777};
+    const timestamp_t start = 0x12345;
+    timer_event_t evts[4];
+    fire_log_t logs[4];
+    setup_at(start);
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        timer_evt_init(&evts[i], &logs[i], start + offsets[i], TIMER_EVENT_INTERVAL_SINGLE_SHOT);
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evts[i]));
+    }
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        host_hal_run(start + offsets[i] - 1000 - timer_now());
+        TEST_ASSERT_EQUAL(0, logs[i].count);
+        host_hal_run(2000);
+        TEST_ASSERT_EQUAL(1, logs[i].count);
+        assert_fired_at(&logs[i], 0, start + offsets[i]);
+    }
+}
+
+static void test_cascade_of_only_timer(void)
+{
+    setup();
+
+    /* evt_first fires just before the slot evt_last is in starts, within the
+       grouping margin of it. That slot is then the only one left, and its
+       events must be moved down without the wheel starting over at the
+       current time. */
+    timer_event_t evt_first, evt_last;
+    fire_log_t log_first, log_last;
+    timer_evt_init(&evt_first, &log_first, 249845, TIMER_EVENT_INTERVAL_SINGLE_SHOT);
+    timer_evt_init(&evt_last, &log_last, 250960, TIMER_EVENT_INTERVAL_SINGLE_SHOT);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evt_first));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evt_last));
+
+    host_hal_run(260000);
+    TEST_ASSERT_EQUAL(1, log_first.count);
+    TEST_ASSERT_EQUAL(1, log_last.count);
+    assert_fired_at(&log_first, 0, 249845);
+    assert_fired_at(&log_last, 0, 250960);
+}
+
+static void test_wraparound(void)
+{
+    const timestamp_t start = 0xF0000000;
+    setup_at(start);
+
+    timer_event_t evt_near, evt_wrapped, evt_periodic;
+    fire_log_t log_near, log_wrapped, log_periodic;
+    timer_evt_init(&evt_near, &log_near, start + 1000, TIMER_EVENT_INTERVAL_SINGLE_SHOT);
+    timer_evt_init(&evt_wrapped, &log_wrapped, start + 0x20000000, TIMER_EVENT_INTERVAL_SINGLE_SHOT);
+    timer_evt_init(&evt_periodic, &log_periodic, 0xFFFFF000, 3000);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evt_wrapped));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evt_near));
+
+    host_hal_run(2000);
+    TEST_ASSERT_EQUAL(1, log_near.count);
+    assert_fired_at(&log_near, 0, start + 1000);
+
+    /* periodic timer across the wrap of the timestamp */
+    host_hal_run(0xFFFFE000 - timer_now());
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evt_periodic));
+    host_hal_run(12000);
+    TEST_ASSERT_EQUAL(3, log_periodic.count);
+    for (uint32_t i = 0; i < log_periodic.count; ++i)
+    {
+        assert_fired_at(&log_periodic, i, 0xFFFFF000 + 3000 * i);
+    }
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_abort(&evt_periodic));
+    TEST_ASSERT_EQUAL(0, log_wrapped.count);
+
+    host_hal_run((start + 0x20000000) - 1000 - timer_now());
+    TEST_ASSERT_EQUAL(0, log_wrapped.count);
+    host_hal_run(2000);
+    TEST_ASSERT_EQUAL(1, log_wrapped.count);
+    assert_fired_at(&log_wrapped, 0, start + 0x20000000);
+    TEST_ASSERT_EQUAL(3, log_periodic.count);
+}
+
+static void test_overdue(void)
+{
+    setup();
+
+    timer_event_t evt_far, evt_overdue, evt_idle_overdue;
+    fire_log_t log_far, log_overdue, log_idle_overdue;
+    timer_evt_init(&evt_far, &log_far, 10000000, TIMER_EVENT_INTERVAL_SINGLE_SHOT);
+    timer_evt_init(&evt_overdue, &log_overdue, 60000, TIMER_EVENT_INTERVAL_SINGLE_SHOT);
+    timer_evt_init(&evt_idle_overdue, &log_idle_overdue, 20000000, TIMER_EVENT_INTERVAL_SINGLE_SHOT);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evt_far));
+
+    /* timers scheduled in the past fire right away, also when the scheduler
+       hasn't had anything to do since long before their timestamp. */
+    host_hal_run(100000);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evt_overdue));
+    host_hal_run(1);
+    TEST_ASSERT_EQUAL(1, log_overdue.count);
+    assert_fired_at(&log_overdue, 0, 100000);
+
+    host_hal_run(20500000 - timer_now());
+    TEST_ASSERT_EQUAL(1, log_far.count);
+    assert_fired_at(&log_far, 0, 10000000);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evt_idle_overdue));
+    host_hal_run(1);
+    TEST_ASSERT_EQUAL(1, log_idle_overdue.count);
+    assert_fired_at(&log_idle_overdue, 0, 20500000);
+    TEST_ASSERT_EQUAL(1, log_overdue.count);
+}
+
+static void test_abort_reschedule_far(void)
+{
+    setup();
+
+    /* all of these start out sharing a slot with the timing wheel */
+    timer_event_t evts[6];
+    fire_log_t logs[6];
+    static const timestamp_t timestamps[] = {300000, 301000, 310000, 302000, 303000, 304000};
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        timer_evt_init(&evts[i], &logs[i], timestamps[i], TIMER_EVENT_INTERVAL_SINGLE_SHOT);
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_schedule(&evts[i]));
+    }
+
+    /* before the slot is moved down */
+    host_hal_run(100000);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_abort(&evts[4]));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_reschedule(&evts[5], 250000));
+
+    /* after it has been moved down, as the first timer fired */
+    host_hal_run(200050);
+    TEST_ASSERT_EQUAL(1, logs[5].count);
+    assert_fired_at(&logs[5], 0, 250000);
+    TEST_ASSERT_EQUAL(1, logs[0].count);
+    assert_fired_at(&logs[0], 0, 300000);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_abort(&evts[3]));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_reschedule(&evts[1], 309000));
+
+    host_hal_run(20000);
+    TEST_ASSERT_EQUAL(0, logs[3].count);
+    TEST_ASSERT_EQUAL(0, logs[4].count);
+    TEST_ASSERT_EQUAL(1, logs[1].count);
+    assert_fired_at(&logs[1], 0, 309000);
+    TEST_ASSERT_EQUAL(1, logs[2].count);
+    assert_fired_at(&logs[2], 0, 310000);
+    TEST_ASSERT_EQUAL(1, logs[0].count);
+    TEST_ASSERT_EQUAL(1, logs[5].count);
+}
+
+int main(void)
+{
+    TEST_RUN(test_single_shot_order);
+    TEST_RUN(test_periodic);
+    TEST_RUN(test_abort_reschedule);
+    TEST_RUN(test_many_timers);
+    TEST_RUN(test_far_timers);
+    TEST_RUN(test_cascade_of_only_timer);
+    TEST_RUN(test_wraparound);
+    TEST_RUN(test_overdue);
+    TEST_RUN(test_abort_reschedule_far);
+    return 0;
+}
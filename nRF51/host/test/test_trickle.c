@@ -0,0 +1,287 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+
+/**
+ * Trickle conformance test. Runs a large number of trickle instances with
+ * random profiles through random sequences of timeouts, consistent and
+ * inconsistent RXs, and checks every step against the rules in IETF RFC6206
+ * section 4.2, as implemented in trickle.c:
+ *
+ * - I stays within [I_min, I_max], and doubles (up to I_max) when an interval
+ *   expires.
+ * - t is picked in [I/2, I) of the interval it's ordered for.
+ * - c is reset at the start of every interval, and counts consistent RXs.
+ * - A timeout transmits if and only if c < k.
+ * - An inconsistent RX resets I to I_min, unless it already is I_min.
+ *
+ * Everything is driven from a PRNG seeded through the host HAL, so a failure
+ * can be reproduced by running with the same seed. Usage:
+ *   test_trickle [instance count] [seed]
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "host_test.h"
+#include "host_hal.h"
+#include "trickle.h"
+#include "rand.h"
+#include "timer.h"
+
+#define TEST_INSTANCE_COUNT_DEFAULT (1000000)
+#define TEST_STEPS_PER_INSTANCE     (24)
+#define TEST_GLOBAL_I_MIN           (100000)
+#define TEST_GLOBAL_I_MAX           (2048)
+#define TEST_GLOBAL_K               (3)
+#define TEST_INTERVAL_LIMIT         (1UL << 30) /* see TRICKLE_INTERVAL_LIMIT */
+
+typedef struct
+{
+    uint32_t i_min;
+    uint32_t i_max;
+    uint8_t k;
+} profile_t;
+
+typedef struct
+{
+    uint64_t steps;
+    uint64_t tx;
+    uint64_t suppressed;
+    uint64_t rx_consistent;
+    uint64_t rx_inconsistent;
+    uint64_t resets;
+    uint64_t t_count;
+    double t_offset_sum; /* sum of (t - interval start) / I */
+} stats_t;
+
+static prng_t m_prng;
+static stats_t m_stats;
+
+static uint32_t random_range(uint32_t min, uint32_t max)
+{
+    return min + rand_prng_get(&m_prng) % (max - min + 1);
+}
+
+/** Pick a random profile, or the global one for a quarter of the instances. */
+static void profile_pick(trickle_t* p_trickle, profile_t* p_profile)
+{
+    trickle_params_t params = {0, 0, 0};
+    if (random_range(0, 3) != 0)
+    {
+        params.i_min_ms = random_range(1, 5000);
+        params.i_max = random_range(1, TRICKLE_I_MAX_DOUBLINGS_MAX);
+        params.k = random_range(1, 6);
+    }
+    trickle_params_set(p_trickle, &params);
+
+    if (params.i_min_ms == 0)
+    {
+        p_profile->i_min = TEST_GLOBAL_I_MIN;
+        p_profile->i_max = TEST_GLOBAL_I_MIN * TEST_GLOBAL_I_MAX;
+        p_profile->k = TEST_GLOBAL_K;
+    }
+    else
+    {
+        p_profile->i_min = params.i_min_ms * 1000UL;
+        p_profile->i_max = TEST_INTERVAL_LIMIT;
+        if (((uint64_t) p_profile->i_min << params.i_max) < TEST_INTERVAL_LIMIT)
+        {
+            p_profile->i_max = p_profile->i_min << params.i_max;
+        }
+        p_profile->k = params.k;
+    }
+}
+
+static uint32_t interval_next(const profile_t* p_profile, uint32_t i)
+{
+    return ((uint64_t) i * 2 > p_profile->i_max) ? p_profile->i_max : i * 2;
+}
+
+/** Check the invariants that hold between all steps. */
+static void invariants_check(const trickle_t* p_trickle, const profile_t* p_profile, uint32_t time_now)
+{
+    TEST_ASSERT(p_trickle->i_relative >= p_profile->i_min);
+    TEST_ASSERT(p_trickle->i_relative <= p_profile->i_max);
+    /* the next timeout is in the future, and no more than two intervals away */
+    TEST_ASSERT(!TIMER_OLDER_THAN(p_trickle->t, time_now));
+    TEST_ASSERT((uint64_t) (p_trickle->t - time_now) < 2ULL * p_trickle->i_relative);
+}
+
+/** Check that t was picked in [I/2, I) of the interval starting at the given time. */
+static void t_check(const trickle_t* p_trickle, uint32_t interval_start)
+{
+    uint32_t offset = p_trickle->t - interval_start;
+    TEST_ASSERT(offset >= p_trickle->i_relative / 2);
+    TEST_ASSERT(offset < p_trickle->i_relative);
+    m_stats.t_offset_sum += (double) offset / p_trickle->i_relative;
+    m_stats.t_count++;
+}
+
+/** Check the state after an interval may have been started, at the given time. */
+static void interval_check(const trickle_t* p_before, const trickle_t* p_after, const profile_t* p_profile, uint32_t time_now)
+{
+    if (TIMER_OLDER_THAN(time_now, p_before->i))
+    {
+        TEST_ASSERT_EQUAL(p_before->i, p_after->i);
+        TEST_ASSERT_EQUAL(p_before->i_relative, p_after->i_relative);
+    }
+    else
+    {
+        TEST_ASSERT_EQUAL(interval_next(p_profile, p_before->i_relative), p_after->i_relative);
+        TEST_ASSERT_EQUAL((uint32_t) (time_now + p_after->i_relative), p_after->i);
+    }
+}
+
+static void reset_check(const trickle_t* p_trickle, const profile_t* p_profile, uint32_t time_now)
+{
+    TEST_ASSERT_EQUAL(p_profile->i_min, p_trickle->i_relative);
+    TEST_ASSERT_EQUAL((uint32_t) (time_now + p_profile->i_min), p_trickle->i);
+    TEST_ASSERT_EQUAL(0, p_trickle->c);
+    t_check(p_trickle, time_now);
+    m_stats.resets++;
+}
+
+static void step_timeout(trickle_t* p_trickle, const profile_t* p_profile, uint32_t time_now)
+{
+    trickle_t before = *p_trickle;
+    bool do_tx;
+    trickle_tx_timeout(p_trickle, &do_tx, time_now);
+    interval_check(&before, p_trickle, p_profile, time_now);
+
+    /* a new interval starts with c = 0 */
+    uint8_t c = (TIMER_OLDER_THAN(time_now, before.i) ? before.c : 0);
+    TEST_ASSERT_EQUAL(c, p_trickle->c);
+    TEST_ASSERT_EQUAL(c < p_profile->k, do_tx);
+
+    if (do_tx)
+    {
+        trickle_tx_register(p_trickle, time_now);
+        m_stats.tx++;
+    }
+    else
+    {
+        m_stats.suppressed++;
+    }
+    /* the next t is ordered in the following interval */
+    t_check(p_trickle, p_trickle->i);
+}
+
+static void step_rx_consistent(trickle_t* p_trickle, const profile_t* p_profile, uint32_t time_now)
+{
+    trickle_t before = *p_trickle;
+    trickle_rx_consistent(p_trickle, time_now);
+    interval_check(&before, p_trickle, p_profile, time_now);
+
+    uint8_t c = (TIMER_OLDER_THAN(time_now, before.i) ? before.c : 0);
+    TEST_ASSERT_EQUAL((c + 1 == TRICKLE_C_DISABLED) ? c : c + 1, p_trickle->c);
+    TEST_ASSERT_EQUAL(before.t, p_trickle->t);
+    m_stats.rx_consistent++;
+}
+
+static void step_rx_inconsistent(trickle_t* p_trickle, const profile_t* p_profile, uint32_t time_now)
+{
+    trickle_t before = *p_trickle;
+    trickle_rx_inconsistent(p_trickle, time_now);
+    if (before.i_relative > p_profile->i_min)
+    {
+        reset_check(p_trickle, p_profile, time_now);
+    }
+    else
+    {
+        TEST_ASSERT_EQUAL(before.i, p_trickle->i);
+        TEST_ASSERT_EQUAL(before.t, p_trickle->t);
+        TEST_ASSERT_EQUAL(before.c, p_trickle->c);
+    }
+    m_stats.rx_inconsistent++;
+}
+
+static void instance_run(void)
+{
+    trickle_t trickle = {0};
+    profile_t profile;
+    profile_pick(&trickle, &profile);
+
+    /* start anywhere, to cover timer wraparound */
+    uint32_t time_now = rand_prng_get(&m_prng);
+    trickle_timer_reset(&trickle, time_now);
+    reset_check(&trickle, &profile, time_now);
+    invariants_check(&trickle, &profile, time_now);
+
+    for (uint32_t step = 0; step < TEST_STEPS_PER_INSTANCE; ++step)
+    {
+        uint32_t action = random_range(0, 99);
+        if (action < 40)
+        {
+            time_now += random_range(0, trickle.t - time_now);
+            step_rx_consistent(&trickle, &profile, time_now);
+        }
+        else if (action < 43)
+        {
+            time_now += random_range(0, trickle.t - time_now);
+            step_rx_inconsistent(&trickle, &profile, time_now);
+        }
+        else
+        {
+            time_now = trickle.t;
+            step_timeout(&trickle, &profile, time_now);
+        }
+        invariants_check(&trickle, &profile, time_now);
+        m_stats.steps++;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t instance_count = (argc > 1 ? strtoul(argv[1], NULL, 0) : TEST_INSTANCE_COUNT_DEFAULT);
+    uint32_t seed = (argc > 2 ? strtoul(argv[2], NULL, 0) : 1);
+
+    host_hal_init(seed);
+    rand_prng_seed(&m_prng);
+    trickle_setup(TEST_GLOBAL_I_MIN, TEST_GLOBAL_I_MAX, TEST_GLOBAL_K);
+
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        instance_run();
+    }
+
+    /* t is uniform in [I/2, I) */
+    double t_offset_mean = m_stats.t_offset_sum / m_stats.t_count;
+    TEST_ASSERT(t_offset_mean > 0.745 && t_offset_mean < 0.755);
+
+    printf("seed %u: %u instances, %llu steps, %llu TX, %llu suppressed, "
+           "%llu consistent RX, %llu inconsistent RX, %llu resets, mean t %.4f I\n",
+           seed, instance_count,
+           (unsigned long long) m_stats.steps, (unsigned long long) m_stats.tx,
+           (unsigned long long) m_stats.suppressed, (unsigned long long) m_stats.rx_consistent,
+           (unsigned long long) m_stats.rx_inconsistent, (unsigned long long) m_stats.resets,
+           t_offset_mean);
+    return 0;
+}
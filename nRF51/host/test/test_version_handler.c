@@ -0,0 +1,285 @@
+/***********************************************************************************
+  Copyright (c) Nordic Semiconductor ASA
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification,
+  are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+  ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+  ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "host_hal.h"
+#include "version_handler.h"
+#include "transport_control.h"
+#include "timer_scheduler.h"
+#include "event_handler.h"
+#include "mesh_packet.h"
+#include "mesh_stats.h"
+#include "timeslot.h"
+#include "rbc_mesh.h"
+#include "nrf_error.h"
+
+#define TEST_ACCESS_ADDR        (RBC_MESH_ACCESS_ADDRESS_BLE_ADV)
+#define TEST_CHANNEL            (38)
+#define TEST_MIN_INTERVAL_US    (100000)
+
+/** Same bring-up as rbc_mesh_init(), minus the SoftDevice. */
+static void setup(void)
+{
+    host_hal_init(1);
+    mesh_stats_init();
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timer_sch_init());
+    event_handler_init();
+    mesh_packet_init();
+    tc_init(TEST_ACCESS_ADDR, TEST_CHANNEL, RBC_MESH_RADIO_MODE_BLE_1MBIT);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, vh_init(TEST_MIN_INTERVAL_US, TEST_ACCESS_ADDR, TEST_CHANNEL, RBC_MESH_TXPOWER_0dBm));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timeslot_init(NRF_CLOCK_LFCLKSRC_XTAL_20_PPM));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, timeslot_resume());
+}
+
+/** Build a packet as transmitted by another device. */
+static void remote_packet_build(mesh_packet_t* p_packet, rbc_mesh_value_handle_t handle, uint16_t version, uint8_t* p_data, uint8_t length)
+{
+    memset(p_packet, 0, sizeof(mesh_packet_t));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, mesh_packet_build(p_packet, handle, version, p_data, length));
+    memcpy(p_packet->addr, "\x01\x02\x03\x04\x05\x06", BLE_GAP_ADDR_LEN);
+    p_packet->header.addr_type = 1;
+}
+
+/** Find the latest transmission of the given handle in the TX log. */
+static mesh_adv_data_t* tx_log_find(rbc_mesh_value_handle_t handle, uint32_t* p_tx_count)
+{
+    static mesh_packet_t packet;
+    uint32_t count = 0;
+    mesh_adv_data_t* p_found = NULL;
+    for (uint32_t i = 0; i < host_radio_tx_count_get(); ++i)
+    {
+        const host_radio_tx_t* p_tx = host_radio_tx_get(i);
+        if (p_tx == NULL)
+        {
+            continue;
+        }
+        memcpy(&packet, &p_tx->packet, sizeof(packet));
+        for (mesh_adv_data_t* p_adv = mesh_packet_adv_data_get(&packet);
+             p_adv != NULL;
+             p_adv = mesh_packet_adv_data_next(&packet, p_adv))
+        {
+            if (p_adv->handle == handle)
+            {
+                TEST_ASSERT_EQUAL(TEST_CHANNEL, p_tx->channel);
+                p_found = p_adv;
+                count++;
+            }
+        }
+    }
+    if (p_tx_count != NULL)
+    {
+        *p_tx_count = count;
+    }
+    return p_found;
+}
+
+static void test_local_update_tx(void)
+{
+    setup();
+
+    uint8_t data[] = {1, 2, 3, 4, 5};
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, vh_tx_event_set(1, true));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, vh_local_update(1, data, sizeof(data)));
+    host_hal_run(TEST_MIN_INTERVAL_US / 2 - 1);
+    TEST_ASSERT(tx_log_find(1, NULL) == NULL);
+
+    host_hal_run(TEST_MIN_INTERVAL_US / 2 + 1);
+    uint32_t tx_count;
+    mesh_adv_data_t* p_adv = tx_log_find(1, &tx_count);
+    TEST_ASSERT(p_adv != NULL);
+    TEST_ASSERT_EQUAL(1, tx_count);
+    TEST_ASSERT_EQUAL(MESH_UUID, p_adv->mesh_uuid);
+    TEST_ASSERT_EQUAL(MESH_PACKET_ADV_OVERHEAD + sizeof(data), p_adv->adv_data_length);
+    TEST_ASSERT(memcmp(p_adv->data, data, sizeof(data)) == 0);
+
+    rbc_mesh_event_t evt;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, rbc_mesh_event_get(&evt));
+    TEST_ASSERT_EQUAL(RBC_MESH_EVENT_TYPE_TX, evt.type);
+    TEST_ASSERT_EQUAL(1, evt.params.tx.value_handle);
+    TEST_ASSERT_EQUAL(sizeof(data), evt.params.tx.data_len);
+    rbc_mesh_event_release(&evt);
+
+    /* the trickle interval doubles, with one transmission in each */
+    host_hal_run(2 * TEST_MIN_INTERVAL_US + 4 * TEST_MIN_INTERVAL_US);
+    tx_log_find(1, &tx_count);
+    TEST_ASSERT_EQUAL(3, tx_count);
+}
+
+static void test_rx_new_value(void)
+{
+    setup();
+
+    uint8_t data[] = {0xAA, 0xBB, 0xCC};
+    mesh_packet_t packet;
+    remote_packet_build(&packet, 7, 3, data, sizeof(data));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, host_radio_rx(&packet, true, 40));
+
+    rbc_mesh_event_t evt;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, rbc_mesh_event_get(&evt));
+    TEST_ASSERT_EQUAL(RBC_MESH_EVENT_TYPE_NEW_VAL, evt.type);
+    TEST_ASSERT_EQUAL(7, evt.params.rx.value_handle);
+    TEST_ASSERT_EQUAL(sizeof(data), evt.params.rx.data_len);
+    TEST_ASSERT(memcmp(evt.params.rx.p_data, data, sizeof(data)) == 0);
+    rbc_mesh_event_release(&evt);
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, rbc_mesh_event_get(&evt));
+
+    uint8_t value[RBC_MESH_VALUE_MAX_LEN];
+    uint16_t length = sizeof(value);
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, vh_value_get(7, value, &length));
+    TEST_ASSERT_EQUAL(sizeof(data), length);
+    TEST_ASSERT(memcmp(value, data, sizeof(data)) == 0);
+
+    /* the same version again is consistent, and not reported */
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, host_radio_rx(&packet, true, 40));
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, rbc_mesh_event_get(&evt));
+
+    /* a newer version is an update */
+    data[0] = 0x11;
+    remote_packet_build(&packet, 7, 4, data, sizeof(data));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, host_radio_rx(&packet, true, 40));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, rbc_mesh_event_get(&evt));
+    TEST_ASSERT_EQUAL(RBC_MESH_EVENT_TYPE_UPDATE_VAL, evt.type);
+    TEST_ASSERT_EQUAL(0x11, evt.params.rx.p_data[0]);
+    rbc_mesh_event_release(&evt);
+
+    /* and the device starts relaying it */
+    host_hal_run(TEST_MIN_INTERVAL_US);
+    mesh_adv_data_t* p_adv = tx_log_find(7, NULL);
+    TEST_ASSERT(p_adv != NULL);
+    TEST_ASSERT_EQUAL(4, p_adv->version);
+    TEST_ASSERT_EQUAL(0x11, p_adv->data[0]);
+}
+
+static void test_rx_crc_fail(void)
+{
+    setup();
+
+    uint8_t data[] = {0x12};
+    mesh_packet_t packet;
+    remote_packet_build(&packet, 9, 1, data, sizeof(data));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, host_radio_rx(&packet, false, 40));
+
+    rbc_mesh_event_t evt;
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, rbc_mesh_event_get(&evt));
+    uint8_t value[RBC_MESH_VALUE_MAX_LEN];
+    uint16_t length = sizeof(value);
+    TEST_ASSERT(vh_value_get(9, value, &length) != NRF_SUCCESS);
+
+    /* the radio keeps listening */
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, host_radio_rx(&packet, true, 40));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, rbc_mesh_event_get(&evt));
+    rbc_mesh_event_release(&evt);
+}
+
+/** Receive the packet @p count times, checking that the duplicate filter recognizes it. */
+static void rx_duplicates(mesh_packet_t* p_packet, uint32_t count)
+{
+    tc_rx_filter_stats_t stats_before;
+    tc_rx_filter_stats_get(&stats_before);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, host_radio_rx(p_packet, true, 40));
+    }
+    tc_rx_filter_stats_t stats;
+    tc_rx_filter_stats_get(&stats);
+    TEST_ASSERT_EQUAL(stats_before.filtered + count, stats.filtered);
+}
+
+static void test_rx_duplicates_counted_in_interval(void)
+{
+    setup();
+
+    uint8_t data[] = {0x42, 0x43};
+    mesh_packet_t packet;
+    remote_packet_build(&packet, 7, 1, data, sizeof(data));
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, host_radio_rx(&packet, true, 40));
+    rbc_mesh_event_t evt;
+    TEST_ASSERT_EQUAL(NRF_SUCCESS, rbc_mesh_event_get(&evt));
+    rbc_mesh_event_release(&evt);
+
+    /* duplicates early in the first interval suppress its transmission,
+       which is in the second half of it. */
+    rx_duplicates(&packet, 3);
+    host_hal_run(TEST_MIN_INTERVAL_US - 1000);
+    uint32_t tx_count;
+    tx_log_find(7, &tx_count);
+    TEST_ASSERT_EQUAL(0, tx_count);
+
+    /* duplicates at the end of the interval belong to it, and must not
+       suppress the transmission in the next one. */
+    rx_duplicates(&packet, 3);
+    host_hal_run(1000 + 2 * TEST_MIN_INTERVAL_US);
+    tx_log_find(7, &tx_count);
+    TEST_ASSERT_EQUAL(1, tx_count);
+    TEST_ASSERT_EQUAL(NRF_ERROR_NOT_FOUND, rbc_mesh_event_get(&evt));
+}
+
+static void test_packet_pool_balanced(void)
+{
+    setup();
+
+    /* run a busy exchange, and check that every packet is given back */
+    uint8_t data[4] = {0};
+    for (uint16_t round = 0; round < 50; ++round)
+    {
+        data[0] = round;
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, vh_local_update(1 + (round % 3), data, sizeof(data)));
+
+        mesh_packet_t packet;
+        remote_packet_build(&packet, 100 + (round % 5), round + 1, data, sizeof(data));
+        TEST_ASSERT_EQUAL(NRF_SUCCESS, host_radio_rx(&packet, true, 40));
+        host_hal_run(TEST_MIN_INTERVAL_US / 4);
+
+        rbc_mesh_event_t evt;
+        while (rbc_mesh_event_get(&evt) == NRF_SUCCESS)
+        {
+            rbc_mesh_event_release(&evt);
+        }
+    }
+
+    mesh_packet_pool_stats_t stats;
+    mesh_packet_pool_stats_get(&stats);
+    TEST_ASSERT_EQUAL(0, stats.acquire_failures);
+    /* one packet per stored value, and one for the radio's RX buffer */
+    TEST_ASSERT_EQUAL(3 + 5 + 1, stats.in_use);
+}
+
+int main(void)
+{
+    TEST_RUN(test_local_update_tx);
+    TEST_RUN(test_rx_new_value);
+    TEST_RUN(test_rx_crc_fail);
+    TEST_RUN(test_rx_duplicates_counted_in_interval);
+    TEST_RUN(test_packet_pool_balanced);
+    return 0;
+}
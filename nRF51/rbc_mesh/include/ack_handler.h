@@ -0,0 +1,58 @@
+/***********************************************************************************
+Copyright (c) Nordic Semiconductor ASA
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef _ACK_HANDLER_H__
+#define _ACK_HANDLER_H__
+#include "rbc_mesh.h"
+#include "mesh_packet.h"
+#include "transport_control.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+* @file Acknowledged writes. A device set up as a sink acknowledges the value
+*   versions it receives with compact handle bitmaps, and devices waiting for
+*   an acknowledgement disable their value once it arrives.
+*/
+
+void ack_handler_init(const tc_tx_config_t* p_tx_config);
+
+void ack_handler_sink_set(bool is_sink);
+
+/** @brief: Update a value, and wait for a sink to acknowledge the new version. */
+uint32_t ack_handler_local_update(rbc_mesh_value_handle_t handle, uint8_t* data, uint16_t length);
+
+/** @brief: Let the sink acknowledge the given value version. Executed in APP_LOW. */
+void ack_handler_value_rx(rbc_mesh_value_handle_t handle, uint16_t version);
+
+/** @brief: Process an acknowledgement packet. Executed in APP_LOW. */
+void ack_handler_rx(mesh_adv_data_t* p_adv_data, uint32_t timestamp);
+
+#endif /* _ACK_HANDLER_H__ */
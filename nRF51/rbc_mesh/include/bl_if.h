@@ -167,6 +167,7 @@ struct bl_cmd
         {
             dfu_packet_t* p_dfu_packet;
             uint32_t length;
+            bool from_serial;
         } rx;
         struct
         {
@@ -61,6 +61,9 @@ uint32_t dfu_jump_to_bootloader(void);
 * @param[in] p_packet A pointer to a DFU packet.
 * @param[in] length The length of the DFU packet.
 *
+* @note The packet is treated as coming from the serial interface, which makes
+*       this device the source of DFU repair segments.
+*
 * @return NRF_SUCCESS The packet was successfully handled by the DFU module.
 * @return NRF_ERROR_BUSY The dfu module can't accept the request at the moment.
 * @return NRF_ERROR_NOT_AVAILABLE The dfu functionality is not available.
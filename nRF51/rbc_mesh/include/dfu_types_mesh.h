@@ -92,9 +92,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define DFU_PACKET_LEN_STATE_BL     (2 + 1 + 1 + 4 + DFU_FWID_LEN_BL)
 #define DFU_PACKET_LEN_STATE_APP    (2 + 1 + 1 + 4 + DFU_FWID_LEN_APP)
 #define DFU_PACKET_LEN_START        (2 + 2 + 4 + 4 + 4 + 2 + 1)
+#define DFU_PACKET_LEN_START_COMPRESSED (DFU_PACKET_LEN_START + 4)
 #define DFU_PACKET_LEN_DATA         (2 + 2 + 4 + SEGMENT_LENGTH)
 #define DFU_PACKET_LEN_DATA_REQ     (2 + 2 + 4)
 #define DFU_PACKET_LEN_DATA_RSP     (2 + 2 + 4 + SEGMENT_LENGTH)
+#define DFU_PACKET_LEN_DATA_REPAIR  (2 + 2 + 4 + 1 + SEGMENT_LENGTH)
 
 #define DFU_PACKET_ADV_OVERHEAD     (1 /* adv_type */ + 2 /* UUID */) /* overhead inside adv data */
 #define DFU_PACKET_OVERHEAD         (MESH_PACKET_BLE_OVERHEAD + 1 + DFU_PACKET_ADV_OVERHEAD) /* dfu packet total overhead */
@@ -116,6 +118,7 @@ typedef uint16_t seq_t;
 
 typedef enum
 {
+    DFU_PACKET_TYPE_DATA_REPAIR = 0xFFF9,
     DFU_PACKET_TYPE_DATA_RSP    = 0xFFFA,
     DFU_PACKET_TYPE_DATA_REQ    = 0xFFFB,
     DFU_PACKET_TYPE_DATA        = 0xFFFC,
@@ -187,7 +190,9 @@ typedef struct __attribute((packed))
             uint8_t single_bank : 1;
             uint8_t first       : 1;
             uint8_t last        : 1;
-            uint8_t _rfu        : 4;
+            uint8_t compressed  : 1;
+            uint8_t _rfu        : 3;
+            uint32_t compressed_length; /* in words, only present in compressed transfers */
         } start;
         struct __attribute((packed))
         {
@@ -206,9 +211,24 @@ typedef struct __attribute((packed))
             uint32_t transaction_id;
             uint8_t data[SEGMENT_LENGTH];
         } rsp_data;
+        struct __attribute((packed))
+        {
+            uint16_t segment; /* first segment in the block */
+            uint32_t transaction_id;
+            uint8_t block_size; /* number of segments in the block */
+            uint8_t data[SEGMENT_LENGTH]; /* XOR of all segments in the block */
+        } repair_data;
     } payload;
 } dfu_packet_t;
 
+/** First segment of the stream in delta transfers. */
+typedef struct __attribute((packed))
+{
+    app_id_t source_fwid;   /**< Version of the application the patch was made against. */
+    uint16_t _rfu;
+    uint32_t source_length; /**< Number of bytes of the installed application the patch copies from. */
+} dfu_delta_header_t;
+
 typedef enum
 {
     BL_INFO_TYPE_INVALID            = 0x00,
@@ -258,7 +278,8 @@ typedef enum
     DFU_END_ERROR_MBR_CALL_FAILED,
     DFU_END_ERROR_INVALID_TRANSFER,
     DFU_END_ERROR_BANK_IN_BOOTLOADER_AREA,
-    DFU_END_ERROR_BANK_AND_DESTINATION_OVERLAP    /**< When copying the finished bank to its intended destination, it will have to overwrite itself. */
+    DFU_END_ERROR_BANK_AND_DESTINATION_OVERLAP,   /**< When copying the finished bank to its intended destination, it will have to overwrite itself. */
+    DFU_END_ERROR_INVALID_DELTA_SOURCE            /**< The installed application isn't the one the delta transfer was made against. */
 } dfu_end_t;
 
 typedef enum
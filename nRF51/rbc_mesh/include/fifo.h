@@ -44,13 +44,38 @@ typedef struct
   uint32_t head;
   uint32_t tail;
   fifo_memcpy memcpy_fptr; /* must be a valid function or NULL */
+  bool spsc; /* single producer, single consumer. Set before fifo_init() to access the queue without masking interrupts. */
 } fifo_t;
 
+/**
+* @brief Initialize the queue. All fields except head and tail must be set
+*   before calling.
+*
+* @note In spsc mode, the queue only orders its accesses with memory barriers,
+*   and doesn't disable interrupts. All pushes must then happen in the same
+*   context, and all pops, peeks and flushes in the same context.
+*/
 void fifo_init(fifo_t* p_fifo);
 uint32_t fifo_push(fifo_t* p_fifo, const void* p_elem);
 uint32_t fifo_pop(fifo_t* p_fifo, void* p_elem);
 uint32_t fifo_peek_at(fifo_t* p_fifo, void* p_elem, uint32_t elem);
 uint32_t fifo_peek(fifo_t* p_fifo, void* p_elem);
+
+/**
+* Zero-copy access. The reserve/commit pair lets a producer build an element
+*   directly in the queue, and the peek_ptr/release pair lets a consumer work
+*   on the first element in place. An element is not visible to the consumer
+*   until it is committed, and its slot is not reused until it is released.
+*
+* @warning Only one reservation and one peeked element may be outstanding at a
+*   time. If several contexts push to (or pop from) the same queue, the caller
+*   must make sure they can't interrupt each other between the two calls.
+*/
+uint32_t fifo_push_reserve(fifo_t* p_fifo, void** pp_elem);
+uint32_t fifo_push_commit(fifo_t* p_fifo);
+uint32_t fifo_pop_peek_ptr(fifo_t* p_fifo, void** pp_elem);
+uint32_t fifo_pop_release(fifo_t* p_fifo);
+
 void fifo_flush(fifo_t* p_fifo);
 uint32_t fifo_get_len(fifo_t* p_fifo);
 bool fifo_is_full(fifo_t* p_fifo);
@@ -35,6 +35,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdbool.h>
 #include "timer.h"
 #include "mesh_packet.h"
+#include "trickle.h"
 
 
 #define MESH_VALUE_LOLLIPOP_LIMIT       (200)
@@ -50,6 +51,7 @@ typedef enum
     HANDLE_FLAG_PERSISTENT,
     HANDLE_FLAG_TX_EVENT,
     HANDLE_FLAG_DISABLED,
+    HANDLE_FLAG_HIGH_PRIORITY,
     HANDLE_FLAG__MAX
 } handle_flag_t;
 
@@ -68,6 +70,19 @@ uint32_t handle_storage_info_set(uint16_t handle, handle_info_t* p_info);
 
 uint32_t handle_storage_local_packet_push(mesh_packet_t* p_packet);
 
+/**
+* Store a locally built packet as the value of its handle, with the version
+*   following the current one. The version field of the packet is updated.
+*   MUST BE CALLED FROM EVENT HANDLER CONTEXT
+*/
+uint32_t handle_storage_local_packet_set(mesh_packet_t* p_packet);
+
+/**
+* Replace the packet transmitted for the given handle, without changing its
+*   version or trickle state. MUST BE CALLED FROM EVENT HANDLER CONTEXT
+*/
+uint32_t handle_storage_packet_set(uint16_t handle, mesh_packet_t* p_packet);
+
 /** MUST BE CALLED FROM EVENT HANDLER CONTEXT */
 uint32_t handle_storage_flag_set(uint16_t handle, handle_flag_t flag, bool value);
 
@@ -75,6 +90,12 @@ uint32_t handle_storage_flag_set_async(uint16_t handle, handle_flag_t flag, bool
 
 uint32_t handle_storage_flag_get(uint16_t handle, handle_flag_t flag, bool* p_value);
 
+/**
+* Set the trickle profile of the given handle. The profile follows the handle
+*   for as long as it stays in the handle cache.
+*/
+uint32_t handle_storage_trickle_params_set(uint16_t handle, const trickle_params_t* p_params);
+
 uint32_t handle_storage_rx_consistent(uint16_t handle, uint32_t timestamp);
 
 uint32_t handle_storage_rx_inconsistent(uint16_t handle, uint32_t timestamp);
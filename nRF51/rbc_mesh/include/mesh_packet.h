@@ -44,6 +44,15 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define MESH_PACKET_BLE_OVERHEAD            (BLE_GAP_ADDR_LEN)                                                      /* overhead before advertisement payload */
 #define MESH_PACKET_ADV_OVERHEAD            (1 /* adv_type */ + 2 /* UUID */ + 2 /* handle */ + 2 /* version */)    /* overhead inside adv data */
 #define MESH_PACKET_OVERHEAD                (MESH_PACKET_BLE_OVERHEAD + 1 + MESH_PACKET_ADV_OVERHEAD)               /* mesh packet total overhead */
+
+#define MESH_SEGMENT_OVERHEAD               (1 /* index */ + 1 /* count */)                                         /* overhead inside the value of a large value segment */
+#define MESH_SEGMENT_DATA_MAX_LEN           (RBC_MESH_VALUE_MAX_LEN - MESH_SEGMENT_OVERHEAD)                        /* large value bytes carried by each segment */
+#define MESH_SEGMENT_COUNT_MAX              ((RBC_MESH_LARGE_VALUE_MAX_LEN + MESH_SEGMENT_DATA_MAX_LEN - 1) / MESH_SEGMENT_DATA_MAX_LEN)
+
+#define MESH_ACK_HANDLE                     (0xFFF0)                                                                /* framework handle carrying value acknowledgements */
+#define MESH_ACK_BITMAP_LEN                 (4)                                                                     /* bytes of handle bitmap in each acknowledgement */
+#define MESH_ACK_OVERHEAD                   (2 /* handle base */ + MESH_ACK_BITMAP_LEN)                             /* overhead inside the value of an acknowledgement */
+#define MESH_ACK_ENTRIES_MAX                (RBC_MESH_VALUE_MAX_LEN - MESH_ACK_OVERHEAD)                            /* acknowledged handles per acknowledgement */
 /******************************************************************************
 * Public typedefs
 ******************************************************************************/
@@ -82,6 +91,26 @@ typedef __packed_armcc struct
     dfu_packet_t            dfu_packet;
 } __packed_gcc mesh_dfu_adv_data_t;
 
+/** Value of a mesh_adv_data_t for large value handles. All segments but the last carry MESH_SEGMENT_DATA_MAX_LEN bytes. */
+typedef __packed_armcc struct
+{
+    uint8_t                 index;
+    uint8_t                 count;
+    uint8_t                 data[MESH_SEGMENT_DATA_MAX_LEN];
+} __packed_gcc mesh_segment_t;
+
+/**
+* Value of a mesh_adv_data_t for MESH_ACK_HANDLE. Bit n in the bitmap
+* acknowledges handle_base + n, and the version tags hold the lowest byte of
+* the acknowledged version of each handle with its bit set, in bitmap order.
+*/
+typedef __packed_armcc struct
+{
+    rbc_mesh_value_handle_t handle_base;
+    uint8_t                 bitmap[MESH_ACK_BITMAP_LEN];
+    uint8_t                 version_tags[MESH_ACK_ENTRIES_MAX];
+} __packed_gcc mesh_ack_t;
+
 typedef __packed_armcc struct
 {
     ble_packet_header_t header;
@@ -89,11 +118,21 @@ typedef __packed_armcc struct
     uint8_t payload[BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH];
 } __packed_gcc mesh_packet_t;
 
+typedef struct
+{
+    uint32_t in_use;                /** Number of packets currently acquired */
+    uint32_t high_watermark;        /** Highest number of packets acquired at the same time */
+    uint32_t acquire_failures;      /** Number of acquire attempts on an empty pool */
+} mesh_packet_pool_stats_t;
+
 /******************************************************************************
 * Interface functions
 ******************************************************************************/
 void mesh_packet_init(void);
 
+/** Get usage statistics for the packet pool. */
+void mesh_packet_pool_stats_get(mesh_packet_pool_stats_t* p_stats);
+
 void mesh_packet_on_ts_begin(void);
 
 bool mesh_packet_acquire(mesh_packet_t** pp_packet);
@@ -115,12 +154,26 @@ uint32_t mesh_packet_build(mesh_packet_t* p_packet,
         uint8_t* data,
         uint8_t length);
 
+/** Build a mesh packet without any adv data, ready for mesh_packet_adv_data_append() */
+uint32_t mesh_packet_build_empty(mesh_packet_t* p_packet);
+
+/** Append a copy of the given adv data to the end of the packet payload, if it fits */
+uint32_t mesh_packet_adv_data_append(mesh_packet_t* p_packet, const mesh_adv_data_t* p_adv_data);
+
+/** Make p_dst a packet from the same sender as p_src, carrying only the given adv data */
+uint32_t mesh_packet_adv_data_extract(mesh_packet_t* p_dst, const mesh_packet_t* p_src, const mesh_adv_data_t* p_adv_data);
+
 uint32_t mesh_packet_adv_data_sanitize(mesh_packet_t* p_packet);
 
+/** Get the first mesh adv data in the packet */
 mesh_adv_data_t* mesh_packet_adv_data_get(mesh_packet_t* p_packet);
 
+/** Get the mesh adv data following p_prev in the packet, or the first if p_prev is NULL */
+mesh_adv_data_t* mesh_packet_adv_data_next(mesh_packet_t* p_packet, mesh_adv_data_t* p_prev);
+
 rbc_mesh_value_handle_t mesh_packet_handle_get(mesh_packet_t* p_packet);
 
+/** Check whether the packet carries anything but a single mesh adv data at the start of the payload */
 bool mesh_packet_has_additional_data(mesh_packet_t* p_packet);
 
 /** Fill address field with local addr, and sanitize adv-data */
@@ -0,0 +1,55 @@
+/***********************************************************************************
+Copyright (c) Nordic Semiconductor ASA
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#ifndef _MESH_STATS_H__
+#define _MESH_STATS_H__
+
+#include <stdint.h>
+#include "rbc_mesh.h"
+
+/**
+* @file Registry of the framework runtime statistics. Counters are bumped
+*   where things happen, while statistics kept by other modules are sampled
+*   when a snapshot is taken.
+*/
+
+/** @brief Reset all statistics. */
+void mesh_stats_init(void);
+
+/** @brief Count one occurrence of the given statistic. */
+void mesh_stats_inc(rbc_mesh_stat_t stat);
+
+/** @brief Raise a high watermark statistic to the given value, if it's higher. */
+void mesh_stats_max_set(rbc_mesh_stat_t stat, uint32_t value);
+
+/** @brief Take a snapshot of all statistics. */
+void mesh_stats_get(rbc_mesh_stats_t* p_stats);
+
+#endif /* _MESH_STATS_H__ */
@@ -32,6 +32,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define _RADIO_CONTROL_H__
 #include <stdint.h>
 #include <stdbool.h>
+#include "rbc_mesh.h"
 /** @brief callbacks for after radio event is complete */
 typedef void (*radio_rx_cb_t)(uint8_t* p_data, bool success, uint32_t crc, uint8_t rssi);
 typedef void (*radio_tx_cb_t)(uint8_t* p_data);
@@ -46,6 +47,13 @@ typedef enum
     RADIO_EVENT_TYPE_RX_PREEMPTABLE /**< Will be aborted when a new event comes in */
 } radio_event_type_t;
 
+/** Radio event priority classes. */
+typedef enum
+{
+    RADIO_EVENT_PRIORITY_NORMAL,    /**< Executed in the order they were queued. */
+    RADIO_EVENT_PRIORITY_HIGH       /**< Latency critical, queued in front of normal priority events. */
+} radio_event_priority_t;
+
 /**
 * @brief executable radio event type
 */
@@ -58,6 +66,7 @@ typedef struct
     radio_event_type_t event_type;  /**< RX/TX */
     uint8_t channel;                /**< Channel to execute event on */
     uint8_t tx_power;               /**< Transmit power for TX events */
+    radio_event_priority_t priority; /**< Priority class, see @ref radio_order() */
 } radio_event_t;
 
 /**
@@ -84,9 +93,22 @@ void radio_init(radio_idle_cb_t idle_cb,
 */
 void radio_alt_aa_set(uint32_t access_address);
 
+/**
+* @brief Set the radio mode. Takes effect from the next call to radio_init().
+*
+* @param[in] radio_mode Radio mode. RBC_MESH_RADIO_MODE_BLE_2MBIT is only
+*   available on nRF52, and is ignored on other chips.
+*/
+void radio_mode_set(rbc_mesh_radio_mode_t radio_mode);
+
 /**
 * @brief Schedule a radio event (tx/rx)
 *
+* @details High priority events are queued in front of normal priority
+*   events that haven't started yet, except regular RX events. To avoid
+*   starving normal priority traffic, an event is only overtaken a limited
+*   number of times.
+*
 * @param[in] radio_event pointer to user-created radio event to be queued.
 *   Is copied into queue, may be stack allocated
 */
@@ -111,6 +111,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     #define PIN_OUT(val,bitcount)
 #endif
 
-#define CHECK_FP(fp) if ((uint32_t)fp < 0x18000UL || (uint32_t)fp > 0x20000000UL){APP_ERROR_CHECK(NRF_ERROR_INVALID_ADDR);}
+#if defined(HOST)
+    #define CHECK_FP(fp) if ((fp) == NULL){APP_ERROR_CHECK(NRF_ERROR_INVALID_ADDR);}
+#else
+    #define CHECK_FP(fp) if ((uint32_t)fp < 0x18000UL || (uint32_t)fp > 0x20000000UL){APP_ERROR_CHECK(NRF_ERROR_INVALID_ADDR);}
+#endif
 
 #endif /* _RBC_MESH_COMMON_H__ */
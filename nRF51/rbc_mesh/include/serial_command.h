@@ -50,11 +50,13 @@ typedef __packed_armcc enum
     SERIAL_CMD_OPCODE_FLAG_SET              = 0x76,
     SERIAL_CMD_OPCODE_FLAG_GET              = 0x77,
     SERIAL_CMD_OPCODE_DFU                   = 0x78,
+    SERIAL_CMD_OPCODE_TRICKLE_PARAMS_SET    = 0x79,
 
     SERIAL_CMD_OPCODE_VALUE_GET             = 0x7A,
     SERIAL_CMD_OPCODE_BUILD_VERSION_GET     = 0x7B,
     SERIAL_CMD_OPCODE_ACCESS_ADDR_GET       = 0x7C,
     SERIAL_CMD_OPCODE_CHANNEL_GET           = 0x7D,
+    SERIAL_CMD_OPCODE_STATS_GET             = 0x7E,
     SERIAL_CMD_OPCODE_INTERVAL_GET          = 0x7F,    
 } __packed_gcc serial_cmd_opcode_t;
 
@@ -106,6 +108,19 @@ typedef __packed_armcc struct
     rbc_mesh_value_handle_t handle;
 } __packed_gcc serial_cmd_params_value_get_t;
 
+typedef __packed_armcc struct 
+{
+    rbc_mesh_value_handle_t handle;
+    uint16_t i_min_ms;
+    uint8_t i_max;
+    uint8_t k;
+} __packed_gcc serial_cmd_params_trickle_params_set_t;
+
+typedef __packed_armcc struct 
+{
+    uint8_t first_stat;
+} __packed_gcc serial_cmd_params_stats_get_t;
+
 typedef __packed_armcc struct 
 {
     dfu_packet_t packet;
@@ -128,6 +143,8 @@ typedef __packed_armcc struct
         serial_cmd_params_value_enable_t    value_enable;
         serial_cmd_params_value_disable_t   value_disable;
         serial_cmd_params_value_get_t       value_get;
+        serial_cmd_params_trickle_params_set_t trickle_params_set;
+        serial_cmd_params_stats_get_t       stats_get;
         serial_cmd_params_dfu_t             dfu;
     } __packed_gcc params;
 } __packed_gcc  serial_cmd_t;
@@ -94,6 +94,15 @@ typedef __packed_armcc struct
     uint8_t data[RBC_MESH_VALUE_MAX_LEN];
 } __packed_gcc serial_evt_cmd_rsp_params_val_get_t;
 
+/** Number of statistics that fit in one stats get response. */
+#define SERIAL_EVT_STATS_PER_RSP    (6)
+
+typedef __packed_armcc struct
+{
+    uint8_t first_stat;
+    uint32_t stats[SERIAL_EVT_STATS_PER_RSP];
+} __packed_gcc serial_evt_cmd_rsp_params_stats_t;
+
 typedef __packed_armcc struct
 {
     uint16_t packet_type;
@@ -117,6 +126,7 @@ typedef __packed_armcc struct
         serial_evt_cmd_rsp_params_flag_get_t flag;
         serial_evt_cmd_rsp_params_int_min_t int_min;
         serial_evt_cmd_rsp_params_val_get_t val_get;
+        serial_evt_cmd_rsp_params_stats_t stats;
         serial_evt_cmd_rsp_params_dfu_t dfu;
     } __packed_gcc response;        
 } __packed_gcc serial_evt_params_cmd_rsp_t;
@@ -37,6 +37,12 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /**
  * @defgroup TIMER_SCHEDULER Asynchronous event scheduler.
  * Scalable event scheduling on the high frequency timer.
+ *
+ * By default, events are kept in a sorted linked list, making scheduling
+ * and rescheduling O(n) in the number of pending events. Define
+ * TIMER_SCH_TIMING_WHEEL to keep them in a hierarchical timing wheel instead,
+ * with O(1) scheduling and abortion, at the cost of some RAM for the wheel
+ * slots.
  * @{
  */
 
@@ -59,6 +65,9 @@ typedef struct timer_event
     timestamp_t         interval;  /**< Interval in us between each fire for periodic timers, or 0 if single-shot */
     void *              p_context; /**< Pointer to data passed on to the callback. */
     struct timer_event* p_next;    /**< Pointer to next event in linked list. Only for internal usage. */
+#ifdef TIMER_SCH_TIMING_WHEEL
+    struct timer_event** pp_prev;  /**< Pointer to the link pointing to this event, or NULL if not scheduled. Only for internal usage. */
+#endif
 } timer_event_t;
 
 /**
@@ -33,7 +33,16 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "nrf.h"
 
-#if defined(__CC_ARM)
+#if defined(HOST)
+
+/* Host build (see host/), IRQ masking is emulated by the host HAL */
+    #define __packed_armcc
+    #define __packed_gcc __attribute__((packed))
+
+    #define _DISABLE_IRQS(_was_masked) _was_masked = __disable_irq()
+    #define _ENABLE_IRQS(_was_masked) if (!_was_masked) { __enable_irq(); }
+
+#elif defined(__CC_ARM)
 
 /* ARMCC and GCC have different ordering for packed typedefs, must separate macros */
     #define __packed_gcc
@@ -32,6 +32,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define _TRANSPORT_CONTROL_H__
 #include <stdint.h>
 #include "mesh_packet.h"
+#include "radio_control.h"
 #include "ble.h"
 #ifdef NRF51
 #include "nrf51.h"
@@ -55,8 +56,35 @@ typedef struct
     uint8_t             first_channel;      /**< Channel offset in the channel map. */
     uint8_t             channel_map;        /**< Bitmap for channels to transmit on. */
     rbc_mesh_txpower_t  tx_power;           /**< Transmit power. */
+    radio_event_priority_t priority;        /**< Radio queue priority class. */
 } tc_tx_config_t;
 
+/** Duplicate filter statistics. */
+typedef struct
+{
+    uint32_t filtered;              /**< Number of packets recognized as duplicates in the radio callback. */
+    uint32_t passed;                /**< Number of mesh value packets passed on for processing. */
+} tc_rx_filter_stats_t;
+
+/** Receive backoff controller states. */
+typedef enum
+{
+    TC_RX_BACKOFF_STATE_NORMAL,     /**< Listening whenever the radio is idle. */
+    TC_RX_BACKOFF_STATE_THROTTLED,  /**< Listening for one packet per RBC_MESH_RX_BACKOFF_DUTY_CYCLE processed packets. */
+    TC_RX_BACKOFF_STATE_SUSPENDED   /**< A packet was dropped, not listening until the queue has drained. */
+} tc_rx_backoff_state_t;
+
+/** Receive backoff controller status. */
+typedef struct
+{
+    tc_rx_backoff_state_t state;        /**< Current controller state. */
+    uint32_t packets_queued;            /**< Received packets waiting for processing. */
+    uint32_t queue_drops;               /**< Received packets dropped because the event queue was full. */
+    uint32_t throttle_count;            /**< Number of times the controller started throttling. */
+    uint32_t suspend_count;             /**< Number of times the controller suspended reception. */
+    uint32_t avg_processing_time_us;    /**< Running average of the time spent processing a packet. */
+    uint32_t avg_queue_time_us;         /**< Running average of the time packets wait for processing. */
+} tc_rx_backoff_status_t;
 
 /** @brief Function pointer type for packet peek callback. */
 typedef void (*packet_peek_cb_t)(mesh_packet_t* p_packet,
@@ -65,10 +93,22 @@ typedef void (*packet_peek_cb_t)(mesh_packet_t* p_packet,
                                  uint8_t rssi);
 
 
-void tc_init(uint32_t access_address, uint8_t channel);
+void tc_init(uint32_t access_address, uint8_t channel, rbc_mesh_radio_mode_t radio_mode);
 
 void tc_radio_params_set(uint32_t access_address, uint8_t channel);
 
+/**
+* @brief Set the advertising channels to receive on. The receiver starts on
+*   the first channel in the map, and moves on to the next one every
+*   dwell_time_us.
+*
+* @param[in] channel_map Bitmap of advertising channels, with bit 0 for
+*   channel 37. An empty map makes the receiver stay on the mesh channel.
+* @param[in] dwell_time_us Time to listen on each channel. Ignored if there's
+*   less than two channels in the map.
+*/
+void tc_rx_channel_map_set(uint8_t channel_map, uint32_t dwell_time_us);
+
 void tc_on_ts_begin(void);
 
 /**
@@ -85,6 +125,20 @@ uint32_t tc_tx(mesh_packet_t* p_packet, const tc_tx_config_t* p_tx_config);
 
 void tc_packet_handler(uint8_t* data, uint32_t crc, uint32_t timestamp, uint8_t rssi);
 
+/**
+* @brief Let the duplicate filter recognize the given value version as one
+*   the device already has. Executed in APP_LOW.
+*
+* @param[in] p_adv_data Mesh adv data of the value, as it is stored.
+*/
+void tc_rx_filter_add(mesh_adv_data_t* p_adv_data);
+
+/** @brief Get duplicate filter statistics. */
+void tc_rx_filter_stats_get(tc_rx_filter_stats_t* p_stats);
+
+/** @brief Get the state and counters of the receive backoff controller. */
+void tc_rx_backoff_status_get(tc_rx_backoff_status_t* p_status);
+
 /**
 * @brief Set packet peek function pointer. Every received packet will be
 *   passed to the peek function before being processed by the stack -
@@ -96,7 +150,8 @@ void tc_packet_handler(uint8_t* data, uint32_t crc, uint32_t timestamp, uint8_t
 *   users should not store any direct pointers to it. Also note that the
 *   function is called from APP_LOW priority, which means it takes away from
 *   stack-internal processing time. Excessive usage may lead to starvation of
-*   internal functionality, and potentially packet drops.
+*   internal functionality, and potentially packet drops. The duplicate filter
+*   is bypassed while a peek function is set, to let it see every packet.
 *
 * @param[in] packet_peek_cb Function pointer to a packet-peek function.
 */
@@ -44,6 +44,19 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #define TRICKLE_C_DISABLED  (0xFF)
+#define TRICKLE_I_MAX_DOUBLINGS_MAX     (30) /* Highest number of I_min doublings allowed in a trickle profile */
+
+/**
+* @brief trickle profile. Zero fields fall back to the global values given in
+*   trickle_setup(), so that instances without a profile follow changes to
+*   the global interval.
+*/
+typedef __packed_armcc struct
+{
+    uint16_t        i_min_ms;       /* Minimum interval in milliseconds. 0 for the global I_min */
+    uint8_t         i_max;          /* Number of doublings of I_min allowed before reaching I_max. 0 for the global I_max */
+    uint8_t         k;              /* Redundancy constant. 0 for the global k */
+} __packed_gcc trickle_params_t;
 
 /**
 * @brief trickle instance type. Contains all values necessary for maintaining
@@ -55,6 +68,7 @@ typedef __packed_armcc struct
     uint32_t        i;              /* Absolute value of i. Equals g_trickle_time (at set time) + i_relative */
     uint32_t        i_relative;     /* Relative value of i. Represents the actual i value in IETF RFC6206 */
     uint8_t         c;              /* Consistent messages counter */
+    trickle_params_t params;        /* Instance specific profile */
 } __packed_gcc trickle_t;
 
 
@@ -64,6 +78,12 @@ typedef __packed_armcc struct
 */
 void trickle_setup(uint32_t i_min, uint32_t i_max, uint8_t k);
 
+/**
+* @brief Set the profile of the given trickle algorithm instance. Takes effect
+*   on the next timer reset.
+*/
+void trickle_params_set(trickle_t* trickle, const trickle_params_t* p_params);
+
 /**
 * @brief Register a consistent RX on the given trickle algorithm instance.
 *   Increments the instance's C value.
@@ -33,6 +33,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "rbc_mesh.h"
 #include "ble_gap.h"
 #include "mesh_packet.h"
+#include "trickle.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -45,9 +46,12 @@ uint32_t vh_min_interval_set(uint32_t min_interval_us);
 
 void vh_tx_power_set(rbc_mesh_txpower_t tx_power);
 
+/** @brief: Set the channels every value transmission is repeated on. */
+void vh_tx_channels_set(uint8_t first_channel, uint8_t channel_map);
+
 uint32_t vh_rx(mesh_packet_t* p_packet, uint32_t timestamp, uint8_t rssi);
 
-uint32_t vh_local_update(rbc_mesh_value_handle_t handle, uint8_t* data, uint8_t length);
+uint32_t vh_local_update(rbc_mesh_value_handle_t handle, uint8_t* data, uint16_t length);
 
 uint32_t vh_on_timeslot_begin(void);
 
@@ -56,10 +60,15 @@ uint32_t vh_order_update(uint32_t time_now);
 /** @brief: Make copy of payload for given handle. */
 uint32_t vh_value_get(rbc_mesh_value_handle_t handle, uint8_t* data, uint16_t* length);
 
+/** @brief: Check whether the given handle is in the large value range. */
+bool vh_value_is_large(rbc_mesh_value_handle_t handle);
+
 uint32_t vh_tx_event_set(rbc_mesh_value_handle_t handle, bool do_tx_event);
 
 uint32_t vh_tx_event_flag_get(rbc_mesh_value_handle_t handle, bool* is_doing_tx_event);
 
+uint32_t vh_high_priority_set(rbc_mesh_value_handle_t handle, bool high_priority);
+
 uint32_t vh_value_enable(rbc_mesh_value_handle_t handle);
 
 uint32_t vh_value_disable(rbc_mesh_value_handle_t handle);
@@ -68,6 +77,8 @@ uint32_t vh_value_is_enabled(rbc_mesh_value_handle_t handle, bool* p_is_enabled)
 
 uint32_t vh_value_persistence_set(rbc_mesh_value_handle_t handle, bool persistent);
 
+uint32_t vh_value_trickle_params_set(rbc_mesh_value_handle_t handle, const trickle_params_t* p_params);
+
 uint32_t vh_value_persistence_get(rbc_mesh_value_handle_t handle, bool* p_persistent);
 
 #endif /* _VERSION_HANDLER_H__ */
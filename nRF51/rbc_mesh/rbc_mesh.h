@@ -45,8 +45,12 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define RBC_MESH_INTERVAL_MIN_MIN_MS                (5) /**< Lowest min-interval allowed. */
 #define RBC_MESH_INTERVAL_MIN_MAX_MS                (60000) /**< Highest min-interval allowed. */
 #define RBC_MESH_VALUE_MAX_LEN                      (23) /**< Longest legal payload. */
+#define RBC_MESH_ADV_CHANNEL_MAP_ALL                (0x07) /**< Channel map with all three advertising channels, 37, 38 and 39. */
+#define RBC_MESH_CHANNEL_DWELL_TIME_MIN_MS          (5) /**< Shortest time allowed to listen on a channel before moving on. */
+#define RBC_MESH_CHANNEL_DWELL_TIME_MAX_MS          (60000) /**< Longest time allowed to listen on a channel before moving on. */
 #define RBC_MESH_INVALID_HANDLE                     (0xFFFF) /**< Designated "invalid" handle, may never be used */
 #define RBC_MESH_APP_MAX_HANDLE                     (0xFFEF) /**< Upper limit to application defined handles. The last 16 handles are reserved for mesh-maintenance. */
+#define RBC_MESH_LARGE_VALUE_MAX_LEN                (512) /**< Longest legal payload for large values. */
 
 #define RBC_MESH_GPREGRET_CODE_GO_TO_APP            (0x00) /**< Retention register code for immediately starting application when entering bootloader. The default behavior. */
 #define RBC_MESH_GPREGRET_CODE_FORCED_REBOOT        (0x01) /**< Retention register code for telling the bootloader it's been started on purpose */
@@ -97,6 +101,32 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
     #define RBC_MESH_INTERNAL_EVENT_QUEUE_LENGTH    (8)
 #endif
 
+/**
+* @brief Receive backoff thresholds. When RBC_MESH_RX_BACKOFF_HIGH_WATERMARK
+*   received packets wait in the internal event queue, the framework only
+*   listens for one new packet per RBC_MESH_RX_BACKOFF_DUTY_CYCLE processed
+*   packets, until the queue has drained to RBC_MESH_RX_BACKOFF_LOW_WATERMARK
+*   packets. If the queue overflows, the framework stops listening until it
+*   has drained.
+*/
+#ifndef RBC_MESH_RX_BACKOFF_HIGH_WATERMARK
+    #define RBC_MESH_RX_BACKOFF_HIGH_WATERMARK      ((RBC_MESH_INTERNAL_EVENT_QUEUE_LENGTH * 3) / 4)
+#endif
+
+/** @brief Number of queued packets at which the receive backoff ends. */
+#ifndef RBC_MESH_RX_BACKOFF_LOW_WATERMARK
+    #define RBC_MESH_RX_BACKOFF_LOW_WATERMARK       (RBC_MESH_INTERNAL_EVENT_QUEUE_LENGTH / 4)
+#endif
+
+/** @brief Number of processed packets per reception while backing off. */
+#ifndef RBC_MESH_RX_BACKOFF_DUTY_CYCLE
+    #define RBC_MESH_RX_BACKOFF_DUTY_CYCLE          (2)
+#endif
+
+#if (RBC_MESH_RX_BACKOFF_LOW_WATERMARK >= RBC_MESH_RX_BACKOFF_HIGH_WATERMARK)
+    #error "The receive backoff low watermark must be below the high watermark"
+#endif
+
 /** @brief Size of packet pool. Only accounts for one packet in the app-space at a time. */
 #ifndef RBC_MESH_PACKET_POOL_SIZE
     #define RBC_MESH_PACKET_POOL_SIZE               (RBC_MESH_DATA_CACHE_ENTRIES +\
@@ -106,6 +136,59 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
                                                      3)
 #endif
 
+/**
+* @brief Number of large values. Large values are kept in the
+*   RBC_MESH_LARGE_VALUE_COUNT handles starting at
+*   RBC_MESH_LARGE_VALUE_HANDLE_BASE, and may be up to
+*   RBC_MESH_LARGE_VALUE_MAX_LEN bytes long. They are split into segments that
+*   share a single trickle instance, and are reassembled by the receivers before
+*   being reported. Each large value takes RBC_MESH_LARGE_VALUE_MAX_LEN bytes of
+*   RAM, and all devices in the network must use the same configuration.
+*/
+#ifndef RBC_MESH_LARGE_VALUE_COUNT
+    #define RBC_MESH_LARGE_VALUE_COUNT              (0)
+#endif
+
+/** @brief First large value handle. Defaults to the top of the application handle range. */
+#ifndef RBC_MESH_LARGE_VALUE_HANDLE_BASE
+    #define RBC_MESH_LARGE_VALUE_HANDLE_BASE        (RBC_MESH_APP_MAX_HANDLE + 1 - RBC_MESH_LARGE_VALUE_COUNT)
+#endif
+
+#if (RBC_MESH_LARGE_VALUE_HANDLE_BASE + RBC_MESH_LARGE_VALUE_COUNT > RBC_MESH_APP_MAX_HANDLE + 1)
+    #error "Large value handles must be application handles"
+#endif
+
+/**
+* @brief Number of received values an acknowledgement sink can hold before
+*   it has to send its pending acknowledgements.
+*/
+#ifndef RBC_MESH_ACK_SINK_ENTRIES
+    #define RBC_MESH_ACK_SINK_ENTRIES               (16)
+#endif
+
+/** @brief Number of acknowledged writes a device may wait for at the same time. */
+#ifndef RBC_MESH_ACK_AWAIT_ENTRIES
+    #define RBC_MESH_ACK_AWAIT_ENTRIES              (4)
+#endif
+
+/**
+* @brief Time an acknowledgement sink waits after a reception before it sends
+*   its acknowledgements, letting it cover several values in one packet.
+*/
+#ifndef RBC_MESH_ACK_DELAY_US
+    #define RBC_MESH_ACK_DELAY_US                   (10000)
+#endif
+
+/**
+* @brief Number of entries in the duplicate filter. Received packets that
+*   carry a version the device already has are recognized with this cache
+*   in the radio callback, and are counted without having their contents
+*   processed. Must be power of two.
+*/
+#ifndef RBC_MESH_RX_FILTER_ENTRIES
+    #define RBC_MESH_RX_FILTER_ENTRIES              (16)
+#endif
+
 #if (RBC_MESH_HANDLE_CACHE_ENTRIES < RBC_MESH_DATA_CACHE_ENTRIES)
     #error "The number of handle cache entries cannot be lower than the number of data entries"
 #endif
@@ -132,6 +215,7 @@ typedef enum
     RBC_MESH_EVENT_TYPE_DFU_START,              /**< The dfu module has started its target role. Parameters in dfu.start sub-structure. */
     RBC_MESH_EVENT_TYPE_DFU_END,                /**< The dfu module has ended its target role. Paramters in dfu.end sub-structure. */
     RBC_MESH_EVENT_TYPE_DFU_BANK_AVAILABLE,     /**< The dfu module found a bank available for flashing. Parameters in dfu.bank sub-structure. */
+    RBC_MESH_EVENT_TYPE_ACKED,                  /**< A value set with @ref rbc_mesh_value_set_acked() was acknowledged by a sink, and is no longer broadcast. Parameters in tx sub-structure, p_data is NULL. */
 } rbc_mesh_event_type_t;
 
 /** @brief The various states of the mesh framework. */
@@ -151,8 +235,8 @@ typedef struct
         struct
         {
             rbc_mesh_value_handle_t value_handle;   /**< Handle of the value the event is generated for. */
-            uint8_t* p_data;                        /**< Current data array contained at the event handle location. */
-            uint8_t data_len;                       /**< Length of data array. */
+            uint8_t* p_data;                        /**< Current data array contained at the event handle location. NULL for large values, use @ref rbc_mesh_value_get() to read them. */
+            uint16_t data_len;                      /**< Length of data array. */
             int8_t rssi;                            /**< RSSI of received data, in range of -100dBm to ~-40dBm. */
             ble_gap_addr_t ble_adv_addr;            /**< Advertisement address of the device we got the update from. */
             uint16_t version_delta;                 /**< Version number increase since last update. */
@@ -161,8 +245,8 @@ typedef struct
         struct
         {
             rbc_mesh_value_handle_t value_handle;   /**< Handle of the value the event is generated for. */
-            uint8_t* p_data;                        /**< Data array transmitted. */
-            uint8_t data_len;                       /**< Length of data array. */
+            uint8_t* p_data;                        /**< Data array transmitted. NULL for large values. */
+            uint16_t data_len;                      /**< Length of data array. */
             uint32_t timestamp_us;                  /** Timestamp of the sent packet. */
         } tx;
         union
@@ -209,6 +293,43 @@ typedef struct
     } params;
 } rbc_mesh_event_t;
 
+/** @brief Runtime statistics, indexes into @ref rbc_mesh_stats_t::stats. */
+typedef enum
+{
+    RBC_MESH_STAT_RX_OK,                            /**< Received packets with a valid CRC. */
+    RBC_MESH_STAT_RX_CRC_FAIL,                      /**< Received packets with an invalid CRC. */
+    RBC_MESH_STAT_RX_QUEUE_DROP,                    /**< Received packets dropped because the internal event queue was full. */
+    RBC_MESH_STAT_RX_DUPLICATE,                     /**< Received packets recognized as duplicates in the radio callback. */
+    RBC_MESH_STAT_RX_THROTTLE,                      /**< Number of times the receive backoff started throttling reception. */
+    RBC_MESH_STAT_RX_SUSPEND,                       /**< Number of times the receive backoff suspended reception. */
+    RBC_MESH_STAT_TX,                               /**< Transmitted packets. */
+    RBC_MESH_STAT_TRICKLE_TX,                       /**< Trickle timeouts that led to a transmission. */
+    RBC_MESH_STAT_TRICKLE_SUPPRESSED,               /**< Trickle timeouts where the transmission was suppressed by consistent receptions. */
+    RBC_MESH_STAT_INTERNAL_QUEUE_HIGH_WATERMARK,    /**< Highest number of events in an internal event queue. */
+    RBC_MESH_STAT_APP_QUEUE_HIGH_WATERMARK,         /**< Highest number of events in the application event queue. */
+    RBC_MESH_STAT_APP_QUEUE_DROP,                   /**< Application events dropped because the application event queue was full. */
+    RBC_MESH_STAT_PACKET_POOL_IN_USE,               /**< Packets currently allocated from the packet pool. */
+    RBC_MESH_STAT_PACKET_POOL_HIGH_WATERMARK,       /**< Highest number of packets allocated at the same time. */
+    RBC_MESH_STAT_PACKET_POOL_ACQUIRE_FAIL,         /**< Packet allocations that failed because the pool was empty. */
+    RBC_MESH_STAT_EVT_TIMER,                        /**< Internal timer events processed. */
+    RBC_MESH_STAT_EVT_TIMER_SCH,                    /**< Internal scheduler events processed. */
+    RBC_MESH_STAT_EVT_GENERIC,                      /**< Internal generic events processed. */
+    RBC_MESH_STAT_EVT_PACKET,                       /**< Internal packet events processed. */
+    RBC_MESH_STAT_EVT_SET_FLAG,                     /**< Internal set flag events processed. */
+    RBC_MESH_STAT_APP_EVT_NEW_VAL,                  /**< RBC_MESH_EVENT_TYPE_NEW_VAL events queued for the application. */
+    RBC_MESH_STAT_APP_EVT_UPDATE_VAL,               /**< RBC_MESH_EVENT_TYPE_UPDATE_VAL events queued for the application. */
+    RBC_MESH_STAT_APP_EVT_CONFLICTING_VAL,          /**< RBC_MESH_EVENT_TYPE_CONFLICTING_VAL events queued for the application. */
+    RBC_MESH_STAT_APP_EVT_TX,                       /**< RBC_MESH_EVENT_TYPE_TX events queued for the application. */
+    RBC_MESH_STAT_APP_EVT_ACKED,                    /**< RBC_MESH_EVENT_TYPE_ACKED events queued for the application. */
+    RBC_MESH_STAT_COUNT                             /**< Number of statistics, not a statistic. */
+} rbc_mesh_stat_t;
+
+/** @brief Snapshot of the framework runtime statistics. */
+typedef struct
+{
+    uint32_t stats[RBC_MESH_STAT_COUNT];    /**< Statistics, indexed by @ref rbc_mesh_stat_t. */
+} rbc_mesh_stats_t;
+
 /** Radio TX power enum */
 typedef enum
 {
@@ -222,6 +343,13 @@ typedef enum
     RBC_MESH_TXPOWER_Neg4dBm  = 0xFCUL, /**< -4dBm. */
 } rbc_mesh_txpower_t;
 
+/** @brief Radio modes for the mesh traffic. */
+typedef enum
+{
+    RBC_MESH_RADIO_MODE_BLE_1MBIT, /**< Regular BLE 1Mbit mode. */
+    RBC_MESH_RADIO_MODE_BLE_2MBIT  /**< BLE 2Mbit mode. Only available on nRF52. */
+} rbc_mesh_radio_mode_t;
+
 /**
 * @brief Initialization parameter struct for the rbc_mesh_init() function.
 *
@@ -243,6 +371,11 @@ typedef enum
 * @param[in] lfclksrc The LF-clock source parameter supplied to the
 *    softdevice_enable function.
 * @param[in] tx_power The transmit power used in the mesh. See @rbc_mesh_tx_power_t.
+* @param[in] radio_mode The radio mode used for all mesh traffic. See
+*    @rbc_mesh_radio_mode_t. The 2Mbit mode halves the time each packet
+*    spends on air, but is only available on nRF52, and makes the mesh
+*    invisible to regular 1Mbit BLE devices. All nodes in the mesh must use the
+*    same mode.
 */
 typedef struct
 {
@@ -255,6 +388,7 @@ typedef struct
 	nrf_clock_lfclksrc_t lfclksrc;
 #endif
     rbc_mesh_txpower_t tx_power;
+    rbc_mesh_radio_mode_t radio_mode;
 } rbc_mesh_init_params_t;
 
 typedef enum
@@ -298,6 +432,7 @@ typedef void (*rbc_mesh_packet_peek_cb_t)(rbc_mesh_packet_peek_params_t* p_peek_
 * @return NRF_SUCCESS the initialization is successful
 * @return NRF_ERROR_INVALID_PARAM a parameter does not meet its required range.
 * @return NRF_ERROR_INVALID_STATE the framework has already been initialized.
+* @return NRF_ERROR_NOT_SUPPORTED the radio mode isn't available on this chip.
 * @return NRF_ERROR_SOFTDEVICE_NOT_ENABLED the Softdevice has not been enabled.
 */
 uint32_t rbc_mesh_init(rbc_mesh_init_params_t init_params);
@@ -347,7 +482,8 @@ uint32_t rbc_mesh_stop(void);
 *
 * @param[in] handle The handle of the value we want to update.
 * @param[in] data Databuffer to be copied into the value slot
-* @param[in] len Length of the provided data. Must not exceed RBC_VALUE_MAX_LEN.
+* @param[in] len Length of the provided data. Must not exceed RBC_VALUE_MAX_LEN,
+*   or RBC_MESH_LARGE_VALUE_MAX_LEN for large value handles.
 *
 * @return NRF_SUCCESS if the value has been successfully updated.
 * @return NRF_ERROR_INVALID_STATE if the framework has not been initialized.
@@ -357,6 +493,53 @@ uint32_t rbc_mesh_stop(void);
 */
 uint32_t rbc_mesh_value_set(rbc_mesh_value_handle_t handle, uint8_t* data, uint16_t len);
 
+/**
+* @brief Set the contents of the data array pointed to by the provided handle,
+*   and stop broadcasting it once an acknowledgement sink has received it.
+*
+* @details Works like @ref rbc_mesh_value_set(), but the value is disabled as
+*   soon as a node set up with @ref rbc_mesh_ack_sink_set() acknowledges the
+*   new version, and an RBC_MESH_EVENT_TYPE_ACKED event is generated. This
+*   frees the air for other values in networks where many devices report to
+*   a single collector. A sink acknowledges many handles in a single packet.
+*
+* @note Acknowledgements are not relayed, so the sink has to be within radio
+*   range of the device. Values that don't get acknowledged are broadcast
+*   like any other value.
+* @note A regular @ref rbc_mesh_value_set() on the handle cancels the wait for
+*   the acknowledgement.
+*
+* @param[in] handle The handle of the value we want to update.
+* @param[in] data Databuffer to be copied into the value slot
+* @param[in] len Length of the provided data. Must not exceed RBC_VALUE_MAX_LEN,
+*   or RBC_MESH_LARGE_VALUE_MAX_LEN for large value handles.
+*
+* @return NRF_SUCCESS if the value has been successfully updated.
+* @return NRF_ERROR_INVALID_STATE if the framework has not been initialized.
+* @return NRF_ERROR_INVALID_ADDR if the handle is outside the range provided
+*    in @ref rbc_mesh_init.
+* @return NRF_ERROR_INVALID_LENGTH if len exceeds RBC_VALUE_MAX_LEN.
+* @return NRF_ERROR_NO_MEM if the device is already waiting for
+*    RBC_MESH_ACK_AWAIT_ENTRIES other acknowledgements.
+*/
+uint32_t rbc_mesh_value_set_acked(rbc_mesh_value_handle_t handle, uint8_t* data, uint16_t len);
+
+/**
+* @brief Set whether the device should act as an acknowledgement sink.
+*
+* @details A sink acknowledges every new or consistent value version it
+*   receives, making devices that set the value with
+*   @ref rbc_mesh_value_set_acked() stop broadcasting it. The
+*   acknowledgements are collected for RBC_MESH_ACK_DELAY_US and sent as
+*   compact handle bitmaps, covering several values in each packet.
+*
+* @param[in] is_sink Whether the device should acknowledge received values.
+*
+* @return NRF_SUCCESS the sink configuration has been set successfully.
+* @return NRF_ERROR_INVALID_STATE the framework has not been initialized.
+*/
+uint32_t rbc_mesh_ack_sink_set(bool is_sink);
+
 /**
 * @brief Start broadcasting the handle-value pair. If the handle has not been
 *   assigned a value yet, it will start broadcasting a version 0 value with
@@ -436,17 +619,76 @@ uint32_t rbc_mesh_persistence_set(rbc_mesh_value_handle_t handle, bool persisten
 */
 uint32_t rbc_mesh_tx_event_set(rbc_mesh_value_handle_t handle, bool do_tx_event);
 
+/**
+* @brief Set whether transmissions of the given handle should be queued in
+*   front of the other values.
+*
+* @details High priority values are put on air ahead of normal priority
+*   values that are already waiting in the radio queue, the same way as DFU
+*   responses and acknowledgements. Advertisements carrying several values are
+*   sent with high priority if any of the values has the flag. The flag is
+*   set to 0 by default.
+*
+* @note Only latency critical handles should have this flag set, as the
+*   radio only lets a limited number of high priority events overtake
+*   each normal priority event.
+* @note The flag is kept in the handle cache, and will be forgotten if the
+*   handle is evicted from it. Set the handle persistent with
+*   @ref rbc_mesh_persistence_set() to keep the flag.
+*
+* @param[in] handle Handle to change the high priority flag for.
+* @param[in] high_priority Whether the handle should be sent with high priority.
+*
+* @return NRF_SUCCESS the priority has been set successfully.
+* @return NRF_ERROR_INVALID_STATE the framework has not been initialized.
+* @return NRF_ERROR_INVALID_ADDR the handle is invalid.
+*/
+uint32_t rbc_mesh_high_priority_set(rbc_mesh_value_handle_t handle, bool high_priority);
+
+/**
+* @brief Set the trickle propagation profile of the given handle.
+*
+* @details By default, all handles share the interval_min_ms given in the
+*   @ref rbc_mesh_init_params_t at initialization. Latency critical handles may be given
+*   a shorter minimum interval, while handles carrying bulk data may be
+*   allowed to back off further, reducing the total airtime in the network.
+*   Setting a parameter to 0 makes the handle use the framework default for
+*   that parameter. Changing the profile restarts the handle's propagation.
+*
+* @note The profile is kept in the handle cache, and will be forgotten if the
+*   handle is evicted from it. Set the handle persistent with
+*   @ref rbc_mesh_persistence_set() to keep the profile.
+*
+* @param[in] handle Handle to set the trickle profile for.
+* @param[in] i_min_ms Minimum transmit interval in ms. Must be between
+*   RBC_MESH_INTERVAL_MIN_MIN_MS and RBC_MESH_INTERVAL_MIN_MAX_MS, or 0.
+* @param[in] i_max Number of times the interval may double before reaching
+*   the maximum interval. Can not exceed 30.
+* @param[in] k Redundancy constant. Number of consistent packets received
+*   within an interval before the transmission is suppressed.
+*
+* @return NRF_SUCCESS the trickle profile has been set successfully.
+* @return NRF_ERROR_INVALID_STATE the framework has not been initialized.
+* @return NRF_ERROR_INVALID_ADDR the handle is invalid.
+* @return NRF_ERROR_INVALID_PARAM one of the parameters is out of range.
+* @return NRF_ERROR_NO_MEM the handle cache is full of persistent values.
+*/
+uint32_t rbc_mesh_value_trickle_params_set(rbc_mesh_value_handle_t handle, uint16_t i_min_ms, uint8_t i_max, uint8_t k);
+
 /**
 * @brief Get the contents of the data array pointed to by the provided handle
 *
 * @param[in] handle The handle of the value we want to update.
 * @param[out] data Databuffer to be copied into the value slot. Must be at least
-*    RBC_VALUE_MAX_LEN long.
-* @param[out] len Length of the copied data. Will not exceed RBC_VALUE_MAX_LEN.
+*    RBC_VALUE_MAX_LEN long, or as long as the value for large value handles.
+* @param[in,out] len Size of the data buffer. Set to the length of the copied
+*    data when returned.
 *
 * @return NRF_SUCCESS the value has been successfully fetched.
 * @return NRF_ERROR_INVALID_STATE the framework has not been initialized.
 * @return NRF_ERROR_INVALID_ADDR the handle is invalid.
+* @return NRF_ERROR_INVALID_LENGTH the value doesn't fit in the data buffer.
+* @return NRF_ERROR_BUSY a newer version of the large value is being received.
 */
 uint32_t rbc_mesh_value_get(rbc_mesh_value_handle_t handle,
     uint8_t* data,
@@ -517,6 +759,52 @@ uint32_t rbc_mesh_tx_event_flag_get(rbc_mesh_value_handle_t handle, bool* is_doi
 */
 void rbc_mesh_tx_power_set(rbc_mesh_txpower_t tx_power);
 
+/**
+* @brief Spread the mesh traffic over several advertising channels.
+*
+* @details Every transmission is repeated on all channels in the map, while
+*   the receiver hops between them, listening on each channel for
+*   dwell_time_ms before moving on to the next one in the map. Devices
+*   listening on different channels no longer compete for the same air, and
+*   packets lost to a collision on one channel may still get through on the
+*   others. All devices in the mesh should use the same channel map, but
+*   there's no need to synchronize their hopping. A map with a single
+*   channel makes the mesh stay on that channel, and an empty map returns
+*   to the channel given in @ref rbc_mesh_init().
+*
+* @note Transmitting on several channels multiplies the radio time spent on
+*   each transmission, and should be weighed against the interval_min_ms
+*   and trickle parameters of the mesh.
+*
+* @param[in] channel_map Bitmap of advertising channels to use, with bit 0
+*   for channel 37, bit 1 for channel 38 and bit 2 for channel 39. See
+*   @ref RBC_MESH_ADV_CHANNEL_MAP_ALL.
+* @param[in] dwell_time_ms Time to listen on each channel. Must be between
+*   RBC_MESH_CHANNEL_DWELL_TIME_MIN_MS and RBC_MESH_CHANNEL_DWELL_TIME_MAX_MS
+*   if there's more than one channel in the map, ignored otherwise.
+*
+* @return NRF_SUCCESS The channel map was set.
+* @return NRF_ERROR_INVALID_STATE The framework has not been initialized.
+* @return NRF_ERROR_INVALID_PARAM The channel map contains other channels than
+*   the advertising channels, or the dwell time is out of range.
+*/
+uint32_t rbc_mesh_channel_map_set(uint8_t channel_map, uint32_t dwell_time_ms);
+
+/**
+* @brief Get a snapshot of the framework runtime statistics.
+*
+* @details The counters start at 0 when the framework is initialized, and
+*   wrap around at 2^32. They're meant for monitoring a running network, and
+*   may miss a few counts while the snapshot is taken.
+*
+* @param[out] p_stats Structure to copy the statistics to.
+*
+* @return NRF_SUCCESS The statistics were copied.
+* @return NRF_ERROR_INVALID_STATE The framework has not been initialized.
+* @return NRF_ERROR_NULL p_stats is a NULL pointer.
+*/
+uint32_t rbc_mesh_stats_get(rbc_mesh_stats_t* p_stats);
+
 /**
 * @brief Event handler to be called upon Softdevice BLE event arrival.
 *
@@ -605,7 +893,8 @@ void rbc_mesh_event_release(rbc_mesh_event_t* p_evt);
 *   users should not store any direct pointers to it. Also note that the
 *   function is called from APP_LOW priority, which means it takes away from
 *   stack-internal processing time. Excessive usage may lead to starvation of
-*   internal functionality, and potentially packet drops.
+*   internal functionality, and potentially packet drops. The duplicate filter
+*   is bypassed while a peek function is set, to let it see every packet.
 *
 * @param[in] packet_peek_cb Function pointer to a packet-peek function.
 */
@@ -0,0 +1,370 @@
+/***********************************************************************************
+Copyright (c) Nordic Semiconductor ASA
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "ack_handler.h"
+
+#include "version_handler.h"
+#include "handle_storage.h"
+#include "transport_control.h"
+#include "timer.h"
+#include "timer_scheduler.h"
+#include "event_handler.h"
+#include "mesh_packet.h"
+#include "rbc_mesh.h"
+
+#include "nrf_error.h"
+#include <string.h>
+
+/* event push isn't present in the API header file. */
+extern uint32_t rbc_mesh_event_push(rbc_mesh_event_t* p_evt);
+
+/******************************************************************************
+* Static typedefs
+******************************************************************************/
+/** Value version received by the sink, waiting to be acknowledged. */
+typedef struct
+{
+    rbc_mesh_value_handle_t handle;
+    uint16_t version;
+} sink_entry_t;
+
+/** Local value waiting for an acknowledgement. */
+typedef struct
+{
+    rbc_mesh_value_handle_t handle; /**< Handle of the value, RBC_MESH_INVALID_HANDLE if the entry is free. */
+    uint16_t version;               /**< Version to be acknowledged. */
+    uint8_t updates_pending;        /**< Local updates that haven't reached the handle storage yet. */
+} await_entry_t;
+
+/******************************************************************************
+* Static globals
+******************************************************************************/
+static const tc_tx_config_t*    mp_tx_config;
+static bool                     m_is_sink;
+static sink_entry_t             m_sink_entries[RBC_MESH_ACK_SINK_ENTRIES];
+static uint32_t                 m_sink_entry_count;
+static timer_event_t            m_ack_timer_evt;
+static bool                     m_ack_timer_scheduled;
+static await_entry_t            m_await_entries[RBC_MESH_ACK_AWAIT_ENTRIES];
+
+/******************************************************************************
+* Static functions
+******************************************************************************/
+/** Send one acknowledgement, covering as many pending entries as possible. */
+static void ack_tx(void)
+{
+    mesh_ack_t ack;
+    uint32_t tag_count = 0;
+
+    memset(&ack, 0, sizeof(ack));
+    ack.handle_base = m_sink_entries[0].handle;
+    for (uint32_t i = 1; i < m_sink_entry_count; ++i)
+    {
+        if (m_sink_entries[i].handle < ack.handle_base)
+        {
+            ack.handle_base = m_sink_entries[i].handle;
+        }
+    }
+
+    /* the version tags must be in bitmap order */
+    for (uint32_t bit = 0; bit < MESH_ACK_BITMAP_LEN * 8 && tag_count < MESH_ACK_ENTRIES_MAX; ++bit)
+    {
+        for (uint32_t i = 0; i < m_sink_entry_count; ++i)
+        {
+            if (m_sink_entries[i].handle == ack.handle_base + bit)
+            {
+                ack.bitmap[bit / 8] |= (1 << (bit % 8));
+                ack.version_tags[tag_count++] = (uint8_t) m_sink_entries[i].version;
+                m_sink_entries[i] = m_sink_entries[--m_sink_entry_count];
+                break;
+            }
+        }
+    }
+
+    mesh_packet_t* p_packet = NULL;
+    if (!mesh_packet_acquire(&p_packet))
+    {
+        /* the senders will keep retransmitting, and get acknowledged later */
+        return;
+    }
+    if (mesh_packet_build(p_packet,
+                MESH_ACK_HANDLE,
+                0,
+                (uint8_t*) &ack,
+                MESH_ACK_OVERHEAD + tag_count) == NRF_SUCCESS)
+    {
+        /* acknowledgements go out in front of the value traffic they end */
+        tc_tx_config_t tx_config = *mp_tx_config;
+        tx_config.priority = RADIO_EVENT_PRIORITY_HIGH;
+        (void) tc_tx(p_packet, &tx_config);
+    }
+    mesh_packet_ref_count_dec(p_packet);
+}
+
+static void ack_tx_all(void)
+{
+    while (m_sink_entry_count > 0)
+    {
+        ack_tx();
+    }
+}
+
+static void ack_timeout(uint32_t timestamp, void* p_context)
+{
+    m_ack_timer_scheduled = false;
+    ack_tx_all();
+}
+
+static await_entry_t* await_entry_get(rbc_mesh_value_handle_t handle)
+{
+    for (uint32_t i = 0; i < RBC_MESH_ACK_AWAIT_ENTRIES; ++i)
+    {
+        if (m_await_entries[i].handle == handle)
+        {
+            return &m_await_entries[i];
+        }
+    }
+    return NULL;
+}
+
+/** Check whether the handle storage has moved past the version the entry waits for. */
+static bool await_entry_is_stale(const await_entry_t* p_entry)
+{
+    if (p_entry->updates_pending > 0)
+    {
+        return false;
+    }
+
+    handle_info_t info;
+    if (handle_storage_info_get(p_entry->handle, &info) != NRF_SUCCESS)
+    {
+        return true;
+    }
+    mesh_packet_ref_count_dec(info.p_packet);
+    return (info.version != p_entry->version);
+}
+
+/** Start waiting for the new version, once the local update has reached the handle storage. */
+static void await_update_done(void* p_context)
+{
+    await_entry_t* p_entry = (await_entry_t*) p_context;
+
+    p_entry->updates_pending--;
+
+    handle_info_t info;
+    if (handle_storage_info_get(p_entry->handle, &info) != NRF_SUCCESS)
+    {
+        if (p_entry->updates_pending == 0)
+        {
+            p_entry->handle = RBC_MESH_INVALID_HANDLE;
+        }
+        return;
+    }
+    mesh_packet_ref_count_dec(info.p_packet);
+    p_entry->version = info.version;
+}
+
+static void acked(await_entry_t* p_entry, uint32_t timestamp)
+{
+    rbc_mesh_event_t evt;
+    evt.type = RBC_MESH_EVENT_TYPE_ACKED;
+    evt.params.tx.value_handle = p_entry->handle;
+    evt.params.tx.p_data = NULL;
+    evt.params.tx.data_len = 0;
+    evt.params.tx.timestamp_us = timestamp;
+
+    (void) handle_storage_flag_set(p_entry->handle, HANDLE_FLAG_DISABLED, true);
+    p_entry->handle = RBC_MESH_INVALID_HANDLE;
+
+    rbc_mesh_event_push(&evt);
+}
+
+/******************************************************************************
+* Interface functions
+******************************************************************************/
+void ack_handler_init(const tc_tx_config_t* p_tx_config)
+{
+    mp_tx_config = p_tx_config;
+    m_is_sink = false;
+    m_sink_entry_count = 0;
+    m_ack_timer_scheduled = false;
+
+    m_ack_timer_evt.p_next = NULL;
+    m_ack_timer_evt.cb = ack_timeout;
+    m_ack_timer_evt.interval = 0;
+    m_ack_timer_evt.p_context = NULL;
+
+    for (uint32_t i = 0; i < RBC_MESH_ACK_AWAIT_ENTRIES; ++i)
+    {
+        m_await_entries[i].handle = RBC_MESH_INVALID_HANDLE;
+        m_await_entries[i].updates_pending = 0;
+    }
+}
+
+void ack_handler_sink_set(bool is_sink)
+{
+    event_handler_critical_section_begin();
+    m_is_sink = is_sink;
+    m_sink_entry_count = 0;
+    event_handler_critical_section_end();
+}
+
+uint32_t ack_handler_local_update(rbc_mesh_value_handle_t handle, uint8_t* data, uint16_t length)
+{
+    event_handler_critical_section_begin();
+
+    await_entry_t* p_entry = await_entry_get(handle);
+    if (p_entry == NULL)
+    {
+        p_entry = await_entry_get(RBC_MESH_INVALID_HANDLE);
+    }
+    if (p_entry == NULL)
+    {
+        /* make room by dropping entries that have been overwritten since */
+        for (uint32_t i = 0; i < RBC_MESH_ACK_AWAIT_ENTRIES; ++i)
+        {
+            if (await_entry_is_stale(&m_await_entries[i]))
+            {
+                m_await_entries[i].handle = RBC_MESH_INVALID_HANDLE;
+                p_entry = &m_await_entries[i];
+            }
+        }
+    }
+    if (p_entry == NULL)
+    {
+        event_handler_critical_section_end();
+        return NRF_ERROR_NO_MEM;
+    }
+
+    uint32_t error_code = vh_local_update(handle, data, length);
+    if (error_code == NRF_SUCCESS)
+    {
+        /* the update is processed asynchronously, learn the new version after it */
+        async_event_t evt;
+        evt.type = EVENT_TYPE_GENERIC;
+        evt.callback.generic.cb = await_update_done;
+        evt.callback.generic.p_context = p_entry;
+        error_code = event_handler_push(&evt);
+    }
+
+    if (error_code == NRF_SUCCESS)
+    {
+        p_entry->handle = handle;
+        p_entry->updates_pending++;
+    }
+
+    event_handler_critical_section_end();
+    return error_code;
+}
+
+void ack_handler_value_rx(rbc_mesh_value_handle_t handle, uint16_t version)
+{
+    if (!m_is_sink)
+    {
+        return;
+    }
+
+    sink_entry_t* p_entry = NULL;
+    for (uint32_t i = 0; i < m_sink_entry_count; ++i)
+    {
+        if (m_sink_entries[i].handle == handle)
+        {
+            p_entry = &m_sink_entries[i];
+            break;
+        }
+    }
+
+    if (p_entry == NULL)
+    {
+        if (m_sink_entry_count == RBC_MESH_ACK_SINK_ENTRIES)
+        {
+            ack_tx_all();
+        }
+        p_entry = &m_sink_entries[m_sink_entry_count++];
+        p_entry->handle = handle;
+    }
+    p_entry->version = version;
+
+    if (!m_ack_timer_scheduled)
+    {
+        m_ack_timer_evt.timestamp = timer_now() + RBC_MESH_ACK_DELAY_US;
+        if (timer_sch_schedule(&m_ack_timer_evt) == NRF_SUCCESS)
+        {
+            m_ack_timer_scheduled = true;
+        }
+        else
+        {
+            ack_tx_all();
+        }
+    }
+}
+
+void ack_handler_rx(mesh_adv_data_t* p_adv_data, uint32_t timestamp)
+{
+    if (p_adv_data->adv_data_length < MESH_PACKET_ADV_OVERHEAD + MESH_ACK_OVERHEAD)
+    {
+        return;
+    }
+
+    mesh_ack_t* p_ack = (mesh_ack_t*) p_adv_data->data;
+    const uint32_t tag_count = p_adv_data->adv_data_length - MESH_PACKET_ADV_OVERHEAD - MESH_ACK_OVERHEAD;
+    uint32_t tag_index = 0;
+
+    for (uint32_t bit = 0; bit < MESH_ACK_BITMAP_LEN * 8 && tag_index < tag_count; ++bit)
+    {
+        if ((p_ack->bitmap[bit / 8] & (1 << (bit % 8))) == 0)
+        {
+            continue;
+        }
+
+        const uint8_t version_tag = p_ack->version_tags[tag_index++];
+        const uint32_t handle = p_ack->handle_base + bit;
+        if (handle > RBC_MESH_APP_MAX_HANDLE)
+        {
+            break;
+        }
+
+        await_entry_t* p_entry = await_entry_get(handle);
+        if (p_entry == NULL || p_entry->updates_pending > 0)
+        {
+            continue;
+        }
+
+        if (await_entry_is_stale(p_entry))
+        {
+            /* the value has been overwritten since the acked write */
+            p_entry->handle = RBC_MESH_INVALID_HANDLE;
+        }
+        else if ((uint8_t) p_entry->version == version_tag)
+        {
+            acked(p_entry, timestamp);
+        }
+    }
+}
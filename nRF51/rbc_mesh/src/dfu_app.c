@@ -269,6 +269,7 @@ uint32_t dfu_init(void)
     m_tx_config.first_channel = 37;
     m_tx_config.channel_map = (1 << 0) | (1 << 1) | (1 << 2); /* 37, 38, 39 */
     m_tx_config.tx_power = RBC_MESH_TXPOWER_0dBm;
+    m_tx_config.priority = RADIO_EVENT_PRIORITY_HIGH; /* DFU responses are time critical */
 
 
     mesh_flash_init(flash_op_complete);
@@ -362,7 +363,8 @@ uint32_t dfu_rx(dfu_packet_t* p_packet, uint32_t length)
     {
         .type = BL_CMD_TYPE_RX,
         .params.rx.p_dfu_packet = p_packet,
-        .params.rx.length = length
+        .params.rx.length = length,
+        .params.rx.from_serial = true
     };
 
     return dfu_cmd_send(&rx_cmd);
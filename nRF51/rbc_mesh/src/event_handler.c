@@ -37,6 +37,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "nrf_soc.h"
 #include "toolchain.h"
 #include "handle_storage.h"
+#include "mesh_stats.h"
 #include <string.h>
 #include "rbc_mesh.h"
 
@@ -54,23 +55,6 @@ static async_event_t g_async_evt_fifo_buffer_ts[RBC_MESH_INTERNAL_EVENT_QUEUE_LE
 static bool g_is_initialized;
 static uint32_t g_critical = 0;
 
-
-#if defined(WITH_ACK_MASTER)
-static uint32_t event_handler_counter[5] __attribute__((at(0x200031D0)))={0};
-#endif
-
-#if defined(WITHOUT_ACK_MASTER)
-static uint32_t event_handler_counter[5]__attribute__((at(0x200028B8)))={0};
-#endif
-
-#if defined(WITH_ACK_SLAVE)
-static uint32_t event_handler_counter[5] __attribute__((at(0x200028CC))) ={0};
-#endif
-
-#if defined(WITHOUT_ACK_SLAVE)
-static uint32_t event_handler_counter[5] __attribute__((at(0x200028B4)))={0};
-#endif
-
 /**
 * @brief execute asynchronous event, based on type
 */
@@ -82,48 +66,31 @@ static void async_event_execute(async_event_t* p_evt)
         case EVENT_TYPE_TIMER:
             CHECK_FP(p_evt->callback.timer.cb);
             p_evt->callback.timer.cb(p_evt->callback.timer.timestamp);
-        
-            #if defined(WITH_ACK_MASTER) || defined (WITHOUT_ACK_MASTER)||defined(WITH_ACK_SLAVE)||defined(WITHOUT_ACK_SLAVE)
-		    event_handler_counter[0]++;
-            #endif
+            mesh_stats_inc(RBC_MESH_STAT_EVT_TIMER);
             break;
         case EVENT_TYPE_GENERIC:
             CHECK_FP(p_evt->callback.generic.cb);
             p_evt->callback.generic.cb(p_evt->callback.generic.p_context);
-        
-            #if defined(WITH_ACK_MASTER) || defined (WITHOUT_ACK_MASTER)||defined(WITH_ACK_SLAVE)||defined(WITHOUT_ACK_SLAVE)
-		    event_handler_counter[1]++;
-            #endif
-        
+            mesh_stats_inc(RBC_MESH_STAT_EVT_GENERIC);
             break;
         case EVENT_TYPE_PACKET:
             tc_packet_handler(p_evt->callback.packet.payload,
                               p_evt->callback.packet.crc,
                               p_evt->callback.packet.timestamp,
                               p_evt->callback.packet.rssi);
-        
-            #if defined(WITH_ACK_MASTER) || defined (WITHOUT_ACK_MASTER)||defined(WITH_ACK_SLAVE)||defined(WITHOUT_ACK_SLAVE)
-		    event_handler_counter[2]++;
-            #endif
-        
+            mesh_stats_inc(RBC_MESH_STAT_EVT_PACKET);
             break;
         case EVENT_TYPE_SET_FLAG:
             handle_storage_flag_set(p_evt->callback.set_flag.handle,
                                     (handle_flag_t) p_evt->callback.set_flag.flag,
                                     p_evt->callback.set_flag.value);
-            #if defined(WITH_ACK_MASTER) || defined (WITHOUT_ACK_MASTER)||defined(WITH_ACK_SLAVE)||defined(WITHOUT_ACK_SLAVE)
-			event_handler_counter[3]++;
-            #endif
-        
+            mesh_stats_inc(RBC_MESH_STAT_EVT_SET_FLAG);
             break;
         case EVENT_TYPE_TIMER_SCH:
             CHECK_FP(p_evt->callback.timer_sch.cb);
             p_evt->callback.timer_sch.cb(p_evt->callback.timer_sch.timestamp,
                                          p_evt->callback.timer_sch.p_context);
-        
-            #if defined(WITH_ACK_MASTER) || defined (WITHOUT_ACK_MASTER)||defined(WITH_ACK_SLAVE)||defined(WITHOUT_ACK_SLAVE)
-		    event_handler_counter[4]++;
-            #endif
+            mesh_stats_inc(RBC_MESH_STAT_EVT_TIMER_SCH);
             break;
         default:
             break;
@@ -131,6 +98,27 @@ static void async_event_execute(async_event_t* p_evt)
 }
 
 static bool event_fifo_pop(fifo_t* evt_fifo)
+{
+    SET_PIN(PIN_SWI0);
+    async_event_t* p_evt;
+    uint32_t error_code = fifo_pop_peek_ptr(evt_fifo, (void**) &p_evt);
+    if (error_code == NRF_SUCCESS)
+    {
+        /* execute in place, this queue is never flushed, so the slot isn't
+           reused before it's released */
+        async_event_execute(p_evt);
+        fifo_pop_release(evt_fifo);
+        CLEAR_PIN(PIN_SWI0);
+        return true;
+    }
+    CLEAR_PIN(PIN_SWI0);
+    return false;
+}
+
+/* The timeslot queue is flushed when the timeslot ends, which may happen
+   while one of its events executes. Events are copied out before they're
+   executed, so that a release can't skip an event pushed after the flush. */
+static bool event_fifo_ts_pop(fifo_t* evt_fifo)
 {
     SET_PIN(PIN_SWI0);
     async_event_t evt;
@@ -158,7 +146,7 @@ void QDEC_IRQHandler(void)
 
         if (timeslot_is_in_ts()) /* in timeslot */
         {
-            got_evt |= event_fifo_pop(&g_async_evt_fifo_ts);
+            got_evt |= event_fifo_ts_pop(&g_async_evt_fifo_ts);
         }
 
         if (!got_evt)
@@ -226,6 +214,7 @@ uint32_t event_handler_push(async_event_t* p_evt)
     {
         return result;
     }
+    mesh_stats_max_set(RBC_MESH_STAT_INTERNAL_QUEUE_HIGH_WATERMARK, fifo_get_len(p_fifo));
 
     /* trigger IRQ */
     NVIC_SetPendingIRQ(EVENT_HANDLER_IRQ);
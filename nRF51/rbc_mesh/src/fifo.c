@@ -38,6 +38,13 @@
 #define FIFO_ELEM_AT(p_fifo, index) ((uint8_t*) ((uint8_t*) p_fifo->elem_array) + (p_fifo->elem_size) * (index))
 #define FIFO_IS_FULL(p_fifo) (p_fifo->tail + p_fifo->array_len == p_fifo->head)
 #define FIFO_IS_EMPTY(p_fifo) (p_fifo->tail == p_fifo->head)
+
+/* Only queues with several producers or consumers need to mask interrupts.
+   The barriers make sure an element is written before the head is moved past
+   it, and read before the tail is moved past it. */
+#define FIFO_LOCK(p_fifo, was_masked) do { if (!(p_fifo)->spsc) { _DISABLE_IRQS(was_masked); } } while (0)
+#define FIFO_UNLOCK(p_fifo, was_masked) do { if (!(p_fifo)->spsc) { _ENABLE_IRQS(was_masked); } } while (0)
+#define FIFO_BARRIER() __DMB()
 /*****************************************************************************
  * Interface functions
  *****************************************************************************/
@@ -58,13 +65,14 @@ uint32_t fifo_push(fifo_t* p_fifo, const void* p_elem)
     {
         return NRF_ERROR_NULL;
     }
-    uint32_t was_masked;
-    _DISABLE_IRQS(was_masked);
+    uint32_t was_masked = 0;
+    FIFO_LOCK(p_fifo, was_masked);
     if (FIFO_IS_FULL(p_fifo))
     {
-        _ENABLE_IRQS(was_masked);
+        FIFO_UNLOCK(p_fifo, was_masked);
         return NRF_ERROR_NO_MEM;
     }
+    FIFO_BARRIER();
 
     void* p_dest = FIFO_ELEM_AT(p_fifo, p_fifo->head & (p_fifo->array_len - 1));
 
@@ -73,20 +81,22 @@ uint32_t fifo_push(fifo_t* p_fifo, const void* p_elem)
     else
         memcpy(p_dest, p_elem, p_fifo->elem_size);
 
+    FIFO_BARRIER();
     ++p_fifo->head;
-    _ENABLE_IRQS(was_masked);
+    FIFO_UNLOCK(p_fifo, was_masked);
     return NRF_SUCCESS;
 }
 
 uint32_t fifo_pop(fifo_t* p_fifo, void* p_elem)
 {
-    uint32_t was_masked;
-    _DISABLE_IRQS(was_masked);
+    uint32_t was_masked = 0;
+    FIFO_LOCK(p_fifo, was_masked);
     if (FIFO_IS_EMPTY(p_fifo))
     {
-        _ENABLE_IRQS(was_masked);
+        FIFO_UNLOCK(p_fifo, was_masked);
         return NRF_ERROR_NULL;
     }
+    FIFO_BARRIER();
 
     if (p_elem != NULL)
     {
@@ -102,9 +112,10 @@ uint32_t fifo_pop(fifo_t* p_fifo, void* p_elem)
         }
     }
 
+    FIFO_BARRIER();
     ++p_fifo->tail;
 
-    _ENABLE_IRQS(was_masked);
+    FIFO_UNLOCK(p_fifo, was_masked);
     return NRF_SUCCESS;
 }
 
@@ -114,13 +125,14 @@ uint32_t fifo_peek_at(fifo_t* p_fifo, void* p_elem, uint32_t elem)
     {
         return NRF_ERROR_NULL;
     }
-    uint32_t was_masked;
-    _DISABLE_IRQS(was_masked);
+    uint32_t was_masked = 0;
+    FIFO_LOCK(p_fifo, was_masked);
     if (fifo_get_len(p_fifo) <= elem)
     {
-        _ENABLE_IRQS(was_masked);
+        FIFO_UNLOCK(p_fifo, was_masked);
         return NRF_ERROR_NULL;
     }
+    FIFO_BARRIER();
 
     void* p_src = FIFO_ELEM_AT(p_fifo, (p_fifo->tail + elem) & (p_fifo->array_len - 1));
 
@@ -129,7 +141,7 @@ uint32_t fifo_peek_at(fifo_t* p_fifo, void* p_elem, uint32_t elem)
     else
         memcpy(p_elem, p_src, p_fifo->elem_size);
 
-    _ENABLE_IRQS(was_masked);
+    FIFO_UNLOCK(p_fifo, was_masked);
     return NRF_SUCCESS;
 }
 
@@ -138,6 +150,76 @@ uint32_t fifo_peek(fifo_t* p_fifo, void* p_elem)
     return fifo_peek_at(p_fifo, p_elem, 0);
 }
 
+uint32_t fifo_push_reserve(fifo_t* p_fifo, void** pp_elem)
+{
+    if (pp_elem == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    uint32_t was_masked = 0;
+    FIFO_LOCK(p_fifo, was_masked);
+    if (FIFO_IS_FULL(p_fifo))
+    {
+        FIFO_UNLOCK(p_fifo, was_masked);
+        return NRF_ERROR_NO_MEM;
+    }
+    FIFO_BARRIER();
+
+    *pp_elem = FIFO_ELEM_AT(p_fifo, p_fifo->head & (p_fifo->array_len - 1));
+    FIFO_UNLOCK(p_fifo, was_masked);
+    return NRF_SUCCESS;
+}
+
+uint32_t fifo_push_commit(fifo_t* p_fifo)
+{
+    uint32_t was_masked = 0;
+    FIFO_LOCK(p_fifo, was_masked);
+    if (FIFO_IS_FULL(p_fifo))
+    {
+        FIFO_UNLOCK(p_fifo, was_masked);
+        return NRF_ERROR_NO_MEM;
+    }
+    FIFO_BARRIER();
+    ++p_fifo->head;
+    FIFO_UNLOCK(p_fifo, was_masked);
+    return NRF_SUCCESS;
+}
+
+uint32_t fifo_pop_peek_ptr(fifo_t* p_fifo, void** pp_elem)
+{
+    if (pp_elem == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    uint32_t was_masked = 0;
+    FIFO_LOCK(p_fifo, was_masked);
+    if (FIFO_IS_EMPTY(p_fifo))
+    {
+        FIFO_UNLOCK(p_fifo, was_masked);
+        return NRF_ERROR_NULL;
+    }
+    FIFO_BARRIER();
+
+    *pp_elem = FIFO_ELEM_AT(p_fifo, p_fifo->tail & (p_fifo->array_len - 1));
+    FIFO_UNLOCK(p_fifo, was_masked);
+    return NRF_SUCCESS;
+}
+
+uint32_t fifo_pop_release(fifo_t* p_fifo)
+{
+    uint32_t was_masked = 0;
+    FIFO_LOCK(p_fifo, was_masked);
+    if (FIFO_IS_EMPTY(p_fifo))
+    {
+        FIFO_UNLOCK(p_fifo, was_masked);
+        return NRF_ERROR_NULL;
+    }
+    FIFO_BARRIER();
+    ++p_fifo->tail;
+    FIFO_UNLOCK(p_fifo, was_masked);
+    return NRF_SUCCESS;
+}
+
 void fifo_flush(fifo_t* p_fifo)
 {
     p_fifo->tail = p_fifo->head;
@@ -48,9 +48,44 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define CACHE_TASK_FIFO_SIZE            (8)
 
+#define TX_HEAP_INDEX_INVALID           (RBC_MESH_DATA_CACHE_ENTRIES)
+#define TX_HEAP_PARENT(heap_index)      (((heap_index) - 1) >> 1)
+#define TX_HEAP_LEFT(heap_index)        (2 * (heap_index) + 1)
+#define TX_HEAP_T(heap_index)           (m_data_cache[m_tx_heap[heap_index]].trickle.t)
+
 #define HANDLE_CACHE_ITERATE(index)     do { index = m_handle_cache[index].index_next; } while (0)
 #define HANDLE_CACHE_ITERATE_BACK(index)     do { index = m_handle_cache[index].index_prev; } while (0)
 
+/* The handle index is an open addressing hash table with linear probing,
+   mapping handles to handle cache entries. Kept at a load factor of at most
+   0.5 to keep the probe sequences short. */
+#if   (RBC_MESH_HANDLE_CACHE_ENTRIES <= 8)
+    #define HANDLE_INDEX_BITS           (4)
+#elif (RBC_MESH_HANDLE_CACHE_ENTRIES <= 16)
+    #define HANDLE_INDEX_BITS           (5)
+#elif (RBC_MESH_HANDLE_CACHE_ENTRIES <= 32)
+    #define HANDLE_INDEX_BITS           (6)
+#elif (RBC_MESH_HANDLE_CACHE_ENTRIES <= 64)
+    #define HANDLE_INDEX_BITS           (7)
+#elif (RBC_MESH_HANDLE_CACHE_ENTRIES <= 128)
+    #define HANDLE_INDEX_BITS           (8)
+#elif (RBC_MESH_HANDLE_CACHE_ENTRIES <= 256)
+    #define HANDLE_INDEX_BITS           (9)
+#elif (RBC_MESH_HANDLE_CACHE_ENTRIES <= 512)
+    #define HANDLE_INDEX_BITS           (10)
+#elif (RBC_MESH_HANDLE_CACHE_ENTRIES <= 1024)
+    #define HANDLE_INDEX_BITS           (11)
+#elif (RBC_MESH_HANDLE_CACHE_ENTRIES <= 2048)
+    #define HANDLE_INDEX_BITS           (12)
+#else
+    #error "Handle cache too large for the handle index"
+#endif
+
+#define HANDLE_INDEX_SLOTS              (1UL << HANDLE_INDEX_BITS)
+#define HANDLE_INDEX_MASK               (HANDLE_INDEX_SLOTS - 1)
+/* Fibonacci hashing, use the upper bits of the product. */
+#define HANDLE_INDEX_HASH(handle)       (((uint32_t) ((uint32_t) (handle) * 2654435769UL)) >> (32 - HANDLE_INDEX_BITS))
+
 /*****************************************************************************
 * Local Typedefs
 *****************************************************************************/
@@ -62,13 +97,16 @@ typedef struct
     uint16_t                tx_event   : 1;     /** TX event flag */
     uint16_t                index_prev : 15;    /** linked list index prev */
     uint16_t                persistent : 1;     /** Persistent flag */
-    uint16_t                data_entry;         /** index of the associated data entry */
+    uint16_t                data_entry : 15;    /** index of the associated data entry */
+    uint16_t                high_priority : 1;  /** High priority flag, transmissions are queued in front of other values */
+    trickle_params_t        trickle_params;     /** trickle profile, applied to the data entry when allocated */
 } handle_entry_t;
 
 typedef struct
 {
     trickle_t trickle;
     mesh_packet_t* p_packet;
+    uint16_t heap_index;                        /** position in the TX heap, or TX_HEAP_INDEX_INVALID */
 } data_entry_t;
 
 /******************************************************************************
@@ -78,6 +116,9 @@ static handle_entry_t   m_handle_cache[RBC_MESH_HANDLE_CACHE_ENTRIES];
 static data_entry_t     m_data_cache[RBC_MESH_DATA_CACHE_ENTRIES];
 static uint32_t         m_handle_cache_head;
 static uint32_t         m_handle_cache_tail;
+static uint16_t         m_handle_index[HANDLE_INDEX_SLOTS]; /** handle -> handle cache index, HANDLE_CACHE_ENTRY_INVALID if empty */
+static uint16_t         m_tx_heap[RBC_MESH_DATA_CACHE_ENTRIES]; /** binary min-heap of data entries with a pending transmission, keyed on trickle.t */
+static uint16_t         m_tx_heap_size;
 
 /*****************************************************************************
 * Static Functions
@@ -94,6 +135,85 @@ static void version_increment(uint16_t* version)
     }
 }
 
+static void tx_heap_swap(uint16_t heap_index_a, uint16_t heap_index_b)
+{
+    uint16_t data_index = m_tx_heap[heap_index_a];
+    m_tx_heap[heap_index_a] = m_tx_heap[heap_index_b];
+    m_tx_heap[heap_index_b] = data_index;
+    m_data_cache[m_tx_heap[heap_index_a]].heap_index = heap_index_a;
+    m_data_cache[m_tx_heap[heap_index_b]].heap_index = heap_index_b;
+}
+
+static void tx_heap_sift_up(uint16_t heap_index)
+{
+    while (heap_index > 0 &&
+           TIMER_OLDER_THAN(TX_HEAP_T(heap_index), TX_HEAP_T(TX_HEAP_PARENT(heap_index))))
+    {
+        tx_heap_swap(heap_index, TX_HEAP_PARENT(heap_index));
+        heap_index = TX_HEAP_PARENT(heap_index);
+    }
+}
+
+static void tx_heap_sift_down(uint16_t heap_index)
+{
+    while (TX_HEAP_LEFT(heap_index) < m_tx_heap_size)
+    {
+        uint16_t child = TX_HEAP_LEFT(heap_index);
+        if (child + 1 < m_tx_heap_size &&
+            TIMER_OLDER_THAN(TX_HEAP_T(child + 1), TX_HEAP_T(child)))
+        {
+            child++;
+        }
+        if (!TIMER_OLDER_THAN(TX_HEAP_T(child), TX_HEAP_T(heap_index)))
+        {
+            break;
+        }
+        tx_heap_swap(heap_index, child);
+        heap_index = child;
+    }
+}
+
+static void tx_heap_remove(uint16_t data_index)
+{
+    uint16_t heap_index = m_data_cache[data_index].heap_index;
+    if (heap_index == TX_HEAP_INDEX_INVALID)
+    {
+        return;
+    }
+    m_data_cache[data_index].heap_index = TX_HEAP_INDEX_INVALID;
+
+    if (heap_index != --m_tx_heap_size)
+    {
+        /* fill the hole with the last element, and restore the heap property */
+        m_tx_heap[heap_index] = m_tx_heap[m_tx_heap_size];
+        m_data_cache[m_tx_heap[heap_index]].heap_index = heap_index;
+        tx_heap_sift_up(heap_index);
+        tx_heap_sift_down(m_data_cache[m_tx_heap[heap_index]].heap_index);
+    }
+}
+
+/** Reflect changes to the given data entry's trickle timer or packet in the
+  TX heap. Must be called whenever either of them are changed. */
+static void tx_heap_update(uint16_t data_index)
+{
+    data_entry_t* p_entry = &m_data_cache[data_index];
+    if (p_entry->p_packet == NULL || !trickle_is_enabled(&p_entry->trickle))
+    {
+        tx_heap_remove(data_index);
+    }
+    else if (p_entry->heap_index == TX_HEAP_INDEX_INVALID)
+    {
+        p_entry->heap_index = m_tx_heap_size;
+        m_tx_heap[m_tx_heap_size++] = data_index;
+        tx_heap_sift_up(p_entry->heap_index);
+    }
+    else
+    {
+        tx_heap_sift_up(p_entry->heap_index);
+        tx_heap_sift_down(p_entry->heap_index);
+    }
+}
+
 static void data_entry_free(data_entry_t* p_data_entry)
 {
     if (p_data_entry == NULL)
@@ -106,84 +226,109 @@ static void data_entry_free(data_entry_t* p_data_entry)
     }
     /* reset trickle params */
     trickle_enable(&p_data_entry->trickle);
+    tx_heap_update(p_data_entry - &m_data_cache[0]);
 }
 
-/** Allocate a new data entry. Will take the least recently updated entry if all are allocated.
+/** Allocate a new data entry for the given handle entry. Will take the least
+  recently updated entry if all are allocated.
   Returns the index of the resulting entry. */
-static uint16_t data_entry_allocate(void)
+static uint16_t data_entry_allocate(uint16_t handle_index)
 {
     for (uint32_t i = 0; i < RBC_MESH_DATA_CACHE_ENTRIES; ++i)
     {
         if (m_data_cache[i].p_packet == NULL)
         {
+            m_handle_cache[handle_index].data_entry = i;
+            trickle_params_set(&m_data_cache[i].trickle, &m_handle_cache[handle_index].trickle_params);
             trickle_timer_reset(&m_data_cache[i].trickle, 0);
+            tx_heap_update(i);
             return i;
         }
     }
 
     /* no unused entries, take the least recently updated (and disregard persistent handles) */
-    uint32_t handle_index = m_handle_cache_tail;
-    while (m_handle_cache[handle_index].data_entry == DATA_CACHE_ENTRY_INVALID ||
-           m_handle_cache[handle_index].persistent)
+    uint32_t victim_index = m_handle_cache_tail;
+    while (m_handle_cache[victim_index].data_entry == DATA_CACHE_ENTRY_INVALID ||
+           m_handle_cache[victim_index].persistent)
     {
-        HANDLE_CACHE_ITERATE_BACK(handle_index);
+        HANDLE_CACHE_ITERATE_BACK(victim_index);
 
-        if (handle_index == HANDLE_CACHE_ENTRY_INVALID)
+        if (victim_index == HANDLE_CACHE_ENTRY_INVALID)
         {
             return DATA_CACHE_ENTRY_INVALID;
         }
     }
 
-    uint32_t data_index = m_handle_cache[handle_index].data_entry;
+    uint32_t data_index = m_handle_cache[victim_index].data_entry;
     APP_ERROR_CHECK_BOOL(data_index < RBC_MESH_DATA_CACHE_ENTRIES);
 
     /* cleanup */
-    m_handle_cache[handle_index].data_entry = DATA_CACHE_ENTRY_INVALID;
+    m_handle_cache[victim_index].data_entry = DATA_CACHE_ENTRY_INVALID;
 
     data_entry_free(&m_data_cache[data_index]);
+    m_handle_cache[handle_index].data_entry = data_index;
+    trickle_params_set(&m_data_cache[data_index].trickle, &m_handle_cache[handle_index].trickle_params);
     trickle_timer_reset(&m_data_cache[data_index].trickle, 0);
+    tx_heap_update(data_index);
     return data_index;
 }
 
-/** Get the index of the handle entry representing the given handle.
-  Returns HANDLE_CACHE_ENTRY_INVALID if not found */
-static uint16_t handle_entry_get(rbc_mesh_value_handle_t handle, bool shortcut)
+/** Get the slot in the handle index holding the given handle, or the empty
+  slot where it would have been inserted. */
+static uint32_t handle_index_slot_get(rbc_mesh_value_handle_t handle)
 {
-    static uint16_t prev_index = HANDLE_CACHE_ENTRY_INVALID;
-    static uint16_t prev_handle = RBC_MESH_INVALID_HANDLE;
-
-    event_handler_critical_section_begin();
-
-    if (shortcut)
+    uint32_t slot = HANDLE_INDEX_HASH(handle);
+    while (m_handle_index[slot] != HANDLE_CACHE_ENTRY_INVALID &&
+           m_handle_cache[m_handle_index[slot]].handle != handle)
     {
-        /* shortcut when accessing the same element in succession. */
-        if (prev_handle == handle &&
-            prev_index < RBC_MESH_HANDLE_CACHE_ENTRIES &&
-            m_handle_cache[prev_index].handle == handle)
-        {
-            event_handler_critical_section_end();
-            return prev_index;
-        }
+        slot = (slot + 1) & HANDLE_INDEX_MASK;
     }
+    return slot;
+}
 
-    uint16_t i = m_handle_cache_head;
+static void handle_index_add(uint16_t index)
+{
+    uint32_t slot = handle_index_slot_get(m_handle_cache[index].handle);
+    m_handle_index[slot] = index;
+}
 
-    while (m_handle_cache[i].handle != handle)
+/** Remove the given handle entry from the index. Closes the gap by shifting
+  back the following entries in the probe sequence, so that no tombstones are
+  needed. */
+static void handle_index_remove(uint16_t index)
+{
+    uint32_t slot = handle_index_slot_get(m_handle_cache[index].handle);
+    if (m_handle_index[slot] != index)
     {
-        if (m_handle_cache_tail == i)
-        {
-            event_handler_critical_section_end();
-            return HANDLE_CACHE_ENTRY_INVALID; /* checked all entries */
-        }
-        HANDLE_CACHE_ITERATE(i);
+        return; /* not in the index */
     }
 
-    if (shortcut)
+    uint32_t next = slot;
+    while (true)
     {
-        prev_handle = handle;
-        prev_index = i;
+        next = (next + 1) & HANDLE_INDEX_MASK;
+        if (m_handle_index[next] == HANDLE_CACHE_ENTRY_INVALID)
+        {
+            break;
+        }
+        uint32_t home = HANDLE_INDEX_HASH(m_handle_cache[m_handle_index[next]].handle);
+        /* leave the entry if its home slot is cyclically in (slot, next] */
+        if ((slot <= next) ? (slot < home && home <= next) : (slot < home || home <= next))
+        {
+            continue;
+        }
+        m_handle_index[slot] = m_handle_index[next];
+        slot = next;
     }
+    m_handle_index[slot] = HANDLE_CACHE_ENTRY_INVALID;
+}
 
+/** Get the index of the handle entry representing the given handle.
+  Returns HANDLE_CACHE_ENTRY_INVALID if not found */
+static uint16_t handle_entry_get(rbc_mesh_value_handle_t handle)
+{
+    event_handler_critical_section_begin();
+    uint16_t i = m_handle_index[handle_index_slot_get(handle)];
     event_handler_critical_section_end();
     return i;
 }
@@ -194,7 +339,7 @@ static uint16_t handle_entry_get(rbc_mesh_value_handle_t handle, bool shortcut)
   is full of persistent handles */
 static uint16_t handle_entry_to_head(rbc_mesh_value_handle_t handle)
 {
-    uint16_t i = handle_entry_get(handle, true);
+    uint16_t i = handle_entry_get(handle);
     if (i == HANDLE_CACHE_ENTRY_INVALID)
     {
         i = m_handle_cache_tail;
@@ -207,9 +352,16 @@ static uint16_t handle_entry_to_head(rbc_mesh_value_handle_t handle)
             }
         }
         /* clean up old data */
+        if (m_handle_cache[i].handle != RBC_MESH_INVALID_HANDLE)
+        {
+            handle_index_remove(i);
+        }
         m_handle_cache[i].handle = handle;
+        handle_index_add(i);
         m_handle_cache[i].tx_event = 0;
+        m_handle_cache[i].high_priority = 0;
         m_handle_cache[i].version = 0;
+        memset(&m_handle_cache[i].trickle_params, 0, sizeof(trickle_params_t));
         if (m_handle_cache[i].data_entry != DATA_CACHE_ENTRY_INVALID)
         {
             data_entry_free(&m_data_cache[m_handle_cache[i].data_entry]);
@@ -252,24 +404,7 @@ static uint16_t handle_entry_to_head(rbc_mesh_value_handle_t handle)
 void local_packet_push(void* p_context)
 {
     mesh_packet_t* p_packet = (mesh_packet_t*) p_context;
-    mesh_adv_data_t* p_adv = mesh_packet_adv_data_get(p_packet);
-    if (p_adv != NULL)
-    {
-        handle_info_t info =
-        {
-            .version = p_adv->version,
-            .p_packet = p_packet
-        };
-        uint16_t handle_index = handle_entry_get(p_adv->handle, true);
-        if (handle_index != HANDLE_CACHE_ENTRY_INVALID)
-        {
-            info.version = m_handle_cache[handle_index].version;
-            version_increment(&info.version);
-        }
-        p_adv->version = info.version;
-
-        handle_storage_info_set(p_adv->handle, &info);
-    }
+    handle_storage_local_packet_set(p_packet);
     mesh_packet_ref_count_dec(p_packet); /* for the event queue */
 }
 
@@ -289,7 +424,9 @@ uint32_t handle_storage_init(uint32_t min_interval_us)
     for (uint32_t i = 0; i < RBC_MESH_DATA_CACHE_ENTRIES; ++i)
     {
         m_data_cache[i].p_packet = NULL;
+        m_data_cache[i].heap_index = TX_HEAP_INDEX_INVALID;
     }
+    m_tx_heap_size = 0;
 
     for (uint32_t i = 0; i < RBC_MESH_HANDLE_CACHE_ENTRIES; ++i)
     {
@@ -297,11 +434,18 @@ uint32_t handle_storage_init(uint32_t min_interval_us)
         m_handle_cache[i].version = 0;
         m_handle_cache[i].persistent = 0;
         m_handle_cache[i].tx_event = 0;
+        m_handle_cache[i].high_priority = 0;
         m_handle_cache[i].data_entry = DATA_CACHE_ENTRY_INVALID;
+        memset(&m_handle_cache[i].trickle_params, 0, sizeof(trickle_params_t));
         m_handle_cache[i].index_prev = i - 1;
         m_handle_cache[i].index_next = i + 1;
     }
 
+    for (uint32_t i = 0; i < HANDLE_INDEX_SLOTS; ++i)
+    {
+        m_handle_index[i] = HANDLE_CACHE_ENTRY_INVALID;
+    }
+
     m_handle_cache_head = 0;
     m_handle_cache_tail = RBC_MESH_HANDLE_CACHE_ENTRIES - 1;
     m_handle_cache[m_handle_cache_head].index_prev = HANDLE_CACHE_ENTRY_INVALID;
@@ -336,7 +480,7 @@ uint32_t handle_storage_info_get(uint16_t handle, handle_info_t* p_info)
     }
     event_handler_critical_section_begin();
 
-    uint16_t handle_index = handle_entry_get(handle, false);
+    uint16_t handle_index = handle_entry_get(handle);
     if (handle_index == HANDLE_CACHE_ENTRY_INVALID)
     {
         event_handler_critical_section_end();
@@ -367,7 +511,7 @@ uint32_t handle_storage_info_set(uint16_t handle, handle_info_t* p_info)
         return NRF_ERROR_INVALID_ADDR;
     }
 
-    uint16_t handle_index = handle_entry_get(handle, true);
+    uint16_t handle_index = handle_entry_get(handle);
     if (handle_index == HANDLE_CACHE_ENTRY_INVALID)
     {
         /* couldn't find an existing entry, allocate one */
@@ -382,12 +526,11 @@ uint32_t handle_storage_info_set(uint16_t handle, handle_info_t* p_info)
 
     if (data_index == DATA_CACHE_ENTRY_INVALID)
     {
-        data_index = data_entry_allocate();
+        data_index = data_entry_allocate(handle_index);
         if (data_index == DATA_CACHE_ENTRY_INVALID)
         {
             return NRF_ERROR_NO_MEM;
         }
-        m_handle_cache[handle_index].data_entry = data_index;
     }
     trickle_timer_reset(&m_data_cache[data_index].trickle, timer_now());
 
@@ -399,7 +542,8 @@ uint32_t handle_storage_info_set(uint16_t handle, handle_info_t* p_info)
 
     /* reference for the cache */
     mesh_packet_ref_count_inc(p_info->p_packet);
-    m_data_cache[m_handle_cache[handle_index].data_entry].p_packet = p_info->p_packet;
+    m_data_cache[data_index].p_packet = p_info->p_packet;
+    tx_heap_update(data_index);
     return NRF_SUCCESS;
 }
 
@@ -423,6 +567,70 @@ uint32_t handle_storage_local_packet_push(mesh_packet_t* p_packet)
     return error_code;
 }
 
+uint32_t handle_storage_local_packet_set(mesh_packet_t* p_packet)
+{
+    mesh_adv_data_t* p_adv = mesh_packet_adv_data_get(p_packet);
+    if (p_adv == NULL)
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    handle_info_t info =
+    {
+        .version = p_adv->version,
+        .p_packet = p_packet
+    };
+    uint16_t handle_index = handle_entry_get(p_adv->handle);
+    if (handle_index != HANDLE_CACHE_ENTRY_INVALID)
+    {
+        info.version = m_handle_cache[handle_index].version;
+        version_increment(&info.version);
+
+        /* local updates re-enable disabled values */
+        if (m_handle_cache[handle_index].data_entry != DATA_CACHE_ENTRY_INVALID)
+        {
+            trickle_enable(&m_data_cache[m_handle_cache[handle_index].data_entry].trickle);
+        }
+    }
+    p_adv->version = info.version;
+
+    return handle_storage_info_set(p_adv->handle, &info);
+}
+
+uint32_t handle_storage_packet_set(uint16_t handle, mesh_packet_t* p_packet)
+{
+    if (p_packet == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (handle == RBC_MESH_INVALID_HANDLE)
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+
+    uint16_t handle_index = handle_entry_get(handle);
+    if (handle_index == HANDLE_CACHE_ENTRY_INVALID)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    uint16_t data_index = m_handle_cache[handle_index].data_entry;
+    if (data_index == DATA_CACHE_ENTRY_INVALID)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    /* reference for the cache */
+    mesh_packet_ref_count_inc(p_packet);
+    if (m_data_cache[data_index].p_packet != NULL)
+    {
+        mesh_packet_ref_count_dec(m_data_cache[data_index].p_packet);
+    }
+    m_data_cache[data_index].p_packet = p_packet;
+
+    return NRF_SUCCESS;
+}
+
 uint32_t handle_storage_flag_set(uint16_t handle, handle_flag_t flag, bool value)
 {
     if (flag >= HANDLE_FLAG__MAX)
@@ -434,7 +642,7 @@ uint32_t handle_storage_flag_set(uint16_t handle, handle_flag_t flag, bool value
         return NRF_ERROR_INVALID_ADDR;
     }
 
-    uint16_t handle_index = handle_entry_get(handle, true);
+    uint16_t handle_index = handle_entry_get(handle);
 
     switch (flag)
     {
@@ -464,6 +672,19 @@ uint32_t handle_storage_flag_set(uint16_t handle, handle_flag_t flag, bool value
             m_handle_cache[handle_index].tx_event = value;
             break;
 
+        case HANDLE_FLAG_HIGH_PRIORITY:
+            if (handle_index == HANDLE_CACHE_ENTRY_INVALID)
+            {
+                handle_index = handle_entry_to_head(handle);
+
+                if (handle_index == HANDLE_CACHE_ENTRY_INVALID)
+                {
+                    return NRF_ERROR_NO_MEM;
+                }
+            }
+            m_handle_cache[handle_index].high_priority = value;
+            break;
+
         case HANDLE_FLAG_DISABLED:
             if (value)
             {
@@ -476,6 +697,7 @@ uint32_t handle_storage_flag_set(uint16_t handle, handle_flag_t flag, bool value
                     return NRF_SUCCESS; /* the value is already disabled */
                 }
                 trickle_disable(&m_data_cache[m_handle_cache[handle_index].data_entry].trickle);
+                tx_heap_update(m_handle_cache[handle_index].data_entry);
             }
             else
             {
@@ -507,8 +729,7 @@ uint32_t handle_storage_flag_set(uint16_t handle, handle_flag_t flag, bool value
                 {
                     if (m_handle_cache[handle_index].data_entry == DATA_CACHE_ENTRY_INVALID)
                     {
-                        m_handle_cache[handle_index].data_entry = data_entry_allocate();
-                        if (m_handle_cache[handle_index].data_entry == DATA_CACHE_ENTRY_INVALID)
+                        if (data_entry_allocate(handle_index) == DATA_CACHE_ENTRY_INVALID)
                         {
                             return NRF_ERROR_NO_MEM;
                         }
@@ -523,6 +744,7 @@ uint32_t handle_storage_flag_set(uint16_t handle, handle_flag_t flag, bool value
                         m_data_cache[m_handle_cache[handle_index].data_entry].p_packet = p_packet;
                     }
                     trickle_enable(&m_data_cache[m_handle_cache[handle_index].data_entry].trickle);
+                    tx_heap_update(m_handle_cache[handle_index].data_entry);
                 }
             }
             break;
@@ -560,7 +782,7 @@ uint32_t handle_storage_flag_get(uint16_t handle, handle_flag_t flag, bool* p_va
 
     event_handler_critical_section_begin();
 
-    uint16_t handle_index = handle_entry_get(handle, false);
+    uint16_t handle_index = handle_entry_get(handle);
     if (handle_index == HANDLE_CACHE_ENTRY_INVALID)
     {
         event_handler_critical_section_end();
@@ -575,6 +797,9 @@ uint32_t handle_storage_flag_get(uint16_t handle, handle_flag_t flag, bool* p_va
         case HANDLE_FLAG_TX_EVENT:
             *p_value = m_handle_cache[handle_index].tx_event;
             break;
+        case HANDLE_FLAG_HIGH_PRIORITY:
+            *p_value = m_handle_cache[handle_index].high_priority;
+            break;
         default:
             event_handler_critical_section_end();
             return NRF_ERROR_INVALID_PARAM;
@@ -584,6 +809,55 @@ uint32_t handle_storage_flag_get(uint16_t handle, handle_flag_t flag, bool* p_va
     return NRF_SUCCESS;
 }
 
+uint32_t handle_storage_trickle_params_set(uint16_t handle, const trickle_params_t* p_params)
+{
+    if (p_params == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (handle == RBC_MESH_INVALID_HANDLE)
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+    if ((p_params->i_min_ms != 0 &&
+        (p_params->i_min_ms < RBC_MESH_INTERVAL_MIN_MIN_MS ||
+         p_params->i_min_ms > RBC_MESH_INTERVAL_MIN_MAX_MS)) ||
+        p_params->i_max > TRICKLE_I_MAX_DOUBLINGS_MAX)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    event_handler_critical_section_begin();
+
+    uint16_t handle_index = handle_entry_get(handle);
+    if (handle_index == HANDLE_CACHE_ENTRY_INVALID)
+    {
+        handle_index = handle_entry_to_head(handle);
+        if (handle_index == HANDLE_CACHE_ENTRY_INVALID)
+        {
+            event_handler_critical_section_end();
+            return NRF_ERROR_NO_MEM;
+        }
+    }
+
+    m_handle_cache[handle_index].trickle_params = *p_params;
+
+    uint16_t data_index = m_handle_cache[handle_index].data_entry;
+    if (data_index != DATA_CACHE_ENTRY_INVALID)
+    {
+        /* restart propagation with the new profile */
+        trickle_params_set(&m_data_cache[data_index].trickle, p_params);
+        if (trickle_is_enabled(&m_data_cache[data_index].trickle))
+        {
+            trickle_timer_reset(&m_data_cache[data_index].trickle, timer_now());
+        }
+        tx_heap_update(data_index);
+    }
+
+    event_handler_critical_section_end();
+    return NRF_SUCCESS;
+}
+
 uint32_t handle_storage_rx_consistent(uint16_t handle, uint32_t timestamp)
 {
     if (handle == RBC_MESH_INVALID_HANDLE)
@@ -591,7 +865,7 @@ uint32_t handle_storage_rx_consistent(uint16_t handle, uint32_t timestamp)
         return NRF_ERROR_INVALID_ADDR;
     }
 
-    uint16_t handle_index = handle_entry_get(handle, true);
+    uint16_t handle_index = handle_entry_get(handle);
     if (handle_index == HANDLE_CACHE_ENTRY_INVALID)
     {
         return NRF_ERROR_NOT_FOUND;
@@ -616,7 +890,7 @@ uint32_t handle_storage_rx_inconsistent(uint16_t handle, uint32_t timestamp)
         return NRF_ERROR_INVALID_ADDR;
     }
 
-    uint16_t handle_index = handle_entry_get(handle, true);
+    uint16_t handle_index = handle_entry_get(handle);
     if (handle_index == HANDLE_CACHE_ENTRY_INVALID)
     {
         return NRF_ERROR_NOT_FOUND;
@@ -630,57 +904,58 @@ uint32_t handle_storage_rx_inconsistent(uint16_t handle, uint32_t timestamp)
     }
 
     trickle_rx_inconsistent(&m_data_cache[data_index].trickle, timestamp);
+    tx_heap_update(data_index);
 
     return NRF_SUCCESS;
 }
 uint32_t handle_storage_next_timeout_get(bool* p_found_value)
 {
-    uint32_t time_earliest = 0;
-    *p_found_value = false;
-    for (uint32_t i = 0; i < RBC_MESH_DATA_CACHE_ENTRIES; ++i)
+    *p_found_value = (m_tx_heap_size > 0);
+    if (m_tx_heap_size == 0)
     {
-        if (trickle_is_enabled(&m_data_cache[i].trickle) &&
-            m_data_cache[i].p_packet != NULL &&
-            (!(*p_found_value) || TIMER_OLDER_THAN(m_data_cache[i].trickle.t, time_earliest)))
-        {
-            *p_found_value = true;
-            time_earliest = m_data_cache[i].trickle.t;
-        }
+        return 0;
     }
-    return time_earliest;
+    return TX_HEAP_T(0);
 }
 
 uint32_t handle_storage_tx_packets_get(uint32_t time_now, mesh_packet_t** pp_packets, uint32_t* p_count)
 {
-    /* Continue where we left off */
-    static uint16_t data_index = 0;
-
     uint32_t count = 0;
+    uint16_t deferred = TX_HEAP_INDEX_INVALID;
 
-    for (uint32_t i = 0; i < RBC_MESH_DATA_CACHE_ENTRIES; ++i)
+    while (m_tx_heap_size > 0 &&
+           count < *p_count &&
+           !TIMER_OLDER_THAN(time_now, TX_HEAP_T(0)))
     {
-        while (data_index >= RBC_MESH_DATA_CACHE_ENTRIES)
-            data_index -= RBC_MESH_DATA_CACHE_ENTRIES;
-
-        if ((m_data_cache[data_index].p_packet != NULL) &&
-            (trickle_is_enabled(&m_data_cache[data_index].trickle)) &&
-            !TIMER_OLDER_THAN(time_now, m_data_cache[data_index].trickle.t))
+        uint16_t data_index = m_tx_heap[0];
+        bool do_tx = false;
+        trickle_tx_timeout(&m_data_cache[data_index].trickle, &do_tx, time_now);
+        if (do_tx)
         {
-            bool do_tx = false;
-            trickle_tx_timeout(&m_data_cache[data_index].trickle, &do_tx, time_now);
-            if (do_tx)
-            {
-                mesh_packet_ref_count_inc(m_data_cache[data_index].p_packet); /* return the packet with an additional reference */
-                pp_packets[count++] = m_data_cache[data_index].p_packet;
-                if (count == *p_count)
-                {
-                    /* packet array is full */
-                    data_index++;
-                    return NRF_SUCCESS;
-                }
-            }
+            mesh_packet_ref_count_inc(m_data_cache[data_index].p_packet); /* return the packet with an additional reference */
+            pp_packets[count++] = m_data_cache[data_index].p_packet;
+
+            /* The timeout won't move until the packet is reported as
+               transmitted, take it out of the heap until we're done. The
+               heap_index field is unused while out of the heap, and links
+               the deferred entries. */
+            tx_heap_remove(data_index);
+            m_data_cache[data_index].heap_index = deferred;
+            deferred = data_index;
         }
-        data_index++;
+        else
+        {
+            /* suppressed, the trickle instance has ordered a new timeout */
+            tx_heap_update(data_index);
+        }
+    }
+
+    while (deferred != TX_HEAP_INDEX_INVALID)
+    {
+        uint16_t data_index = deferred;
+        deferred = m_data_cache[data_index].heap_index;
+        m_data_cache[data_index].heap_index = TX_HEAP_INDEX_INVALID;
+        tx_heap_update(data_index);
     }
     *p_count = count;
 
@@ -694,7 +969,7 @@ uint32_t handle_storage_transmitted(uint16_t handle, uint32_t timestamp)
         return NRF_ERROR_INVALID_ADDR;
     }
 
-    uint16_t handle_index = handle_entry_get(handle, true);
+    uint16_t handle_index = handle_entry_get(handle);
     if (handle_index == HANDLE_CACHE_ENTRY_INVALID)
     {
         return NRF_ERROR_NOT_FOUND;
@@ -706,6 +981,7 @@ uint32_t handle_storage_transmitted(uint16_t handle, uint32_t timestamp)
         return NRF_ERROR_NOT_FOUND;
     }
     trickle_tx_register(&m_data_cache[data_index].trickle, timestamp);
+    tx_heap_update(data_index);
 
     return NRF_SUCCESS;
 }
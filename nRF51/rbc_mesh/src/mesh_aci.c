@@ -158,6 +158,7 @@ static void serial_command_handler(serial_cmd_t* p_serial_cmd)
                 init_params.access_addr = p_serial_cmd->params.init.access_addr;
                 init_params.channel = p_serial_cmd->params.init.channel;
                 init_params.interval_min_ms = p_serial_cmd->params.init.interval_min;
+                init_params.radio_mode = RBC_MESH_RADIO_MODE_BLE_1MBIT;
 #if (NORDIC_SDK_VERSION >= 11)
                 init_params.lfclksrc = defaultClockSource;
 #else
@@ -379,6 +380,28 @@ static void serial_command_handler(serial_cmd_t* p_serial_cmd)
 
             break;
 
+        case SERIAL_CMD_OPCODE_TRICKLE_PARAMS_SET:
+            serial_evt.opcode = SERIAL_EVT_OPCODE_CMD_RSP;
+            serial_evt.params.cmd_rsp.command_opcode = p_serial_cmd->opcode;
+            serial_evt.length = 3;
+
+            if (p_serial_cmd->length != sizeof(serial_cmd_params_trickle_params_set_t) + 1)
+            {
+                serial_evt.params.cmd_rsp.status = ACI_STATUS_ERROR_INVALID_LENGTH;
+            }
+            else
+            {
+                error_code = rbc_mesh_value_trickle_params_set(p_serial_cmd->params.trickle_params_set.handle,
+                        p_serial_cmd->params.trickle_params_set.i_min_ms,
+                        p_serial_cmd->params.trickle_params_set.i_max,
+                        p_serial_cmd->params.trickle_params_set.k);
+
+                serial_evt.params.cmd_rsp.status = error_code_translate(error_code);
+            }
+
+            serial_handler_event_send(&serial_evt);
+            break;
+
         case SERIAL_CMD_OPCODE_INTERVAL_GET:
             serial_evt.opcode = SERIAL_EVT_OPCODE_CMD_RSP;
             serial_evt.params.cmd_rsp.command_opcode = p_serial_cmd->opcode;
@@ -399,6 +422,42 @@ static void serial_command_handler(serial_cmd_t* p_serial_cmd)
             serial_handler_event_send(&serial_evt);
             break;
 
+        case SERIAL_CMD_OPCODE_STATS_GET:
+            serial_evt.opcode = SERIAL_EVT_OPCODE_CMD_RSP;
+            serial_evt.params.cmd_rsp.command_opcode = p_serial_cmd->opcode;
+            serial_evt.length = 3;
+
+            if (p_serial_cmd->length != sizeof(serial_cmd_params_stats_get_t) + 1)
+            {
+                serial_evt.params.cmd_rsp.status = ACI_STATUS_ERROR_INVALID_LENGTH;
+            }
+            else if (p_serial_cmd->params.stats_get.first_stat >= RBC_MESH_STAT_COUNT)
+            {
+                serial_evt.params.cmd_rsp.status = ACI_STATUS_ERROR_INVALID_PARAMETER;
+            }
+            else
+            {
+                rbc_mesh_stats_t stats;
+                error_code = rbc_mesh_stats_get(&stats);
+                serial_evt.params.cmd_rsp.status = error_code_translate(error_code);
+                if (error_code == NRF_SUCCESS)
+                {
+                    /* send as many stats as fit in the response, starting at the requested one */
+                    uint8_t first_stat = p_serial_cmd->params.stats_get.first_stat;
+                    uint32_t count = RBC_MESH_STAT_COUNT - first_stat;
+                    if (count > SERIAL_EVT_STATS_PER_RSP)
+                    {
+                        count = SERIAL_EVT_STATS_PER_RSP;
+                    }
+                    serial_evt.params.cmd_rsp.response.stats.first_stat = first_stat;
+                    memcpy(serial_evt.params.cmd_rsp.response.stats.stats, &stats.stats[first_stat], count * sizeof(uint32_t));
+                    serial_evt.length += 1 + count * sizeof(uint32_t);
+                }
+            }
+
+            serial_handler_event_send(&serial_evt);
+            break;
+
 #endif /* BOOTLOADER */
 
         case SERIAL_CMD_OPCODE_FLAG_SET:
@@ -503,6 +562,7 @@ static void serial_command_handler(serial_cmd_t* p_serial_cmd)
                 rx_cmd.type = BL_CMD_TYPE_RX;
                 rx_cmd.params.rx.p_dfu_packet = &p_serial_cmd->params.dfu.packet;
                 rx_cmd.params.rx.length = p_serial_cmd->length - SERIAL_PACKET_OVERHEAD;
+                rx_cmd.params.rx.from_serial = true;
                 error_code = bootloader_cmd_send(&rx_cmd);
 #elif defined(MESH_DFU)
                 error_code = dfu_rx(&p_serial_cmd->params.dfu.packet, p_serial_cmd->length - SERIAL_PACKET_OVERHEAD);
@@ -609,12 +669,19 @@ void mesh_aci_rbc_event_handler(rbc_mesh_event_t* evt)
             break;
     }
 
+    /* large values don't fit in serial events, and are reported without data */
+    uint8_t data_len = 0;
+    if (evt->params.rx.p_data != NULL && evt->params.rx.data_len <= RBC_MESH_VALUE_MAX_LEN)
+    {
+        data_len = evt->params.rx.data_len;
+    }
+
     /* serial overhead: opcode + handle = 3 */
-    serial_evt.length = 3 + evt->params.rx.data_len;
+    serial_evt.length = 3 + data_len;
 
     /* all event parameter types are the same, just use event_update for all */
     serial_evt.params.event_update.handle = evt->params.rx.value_handle;
-    memcpy(serial_evt.params.event_update.data, evt->params.rx.p_data, evt->params.rx.data_len);
+    memcpy(serial_evt.params.event_update.data, evt->params.rx.p_data, data_len);
 
     serial_handler_event_send(&serial_evt);
 }
@@ -31,13 +31,34 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "mesh_packet.h"
 #include "app_error.h"
 #include <string.h>
+#include <stdint.h>
+#include <stddef.h>
 
-#define PACKET_INDEX(p_packet) ((((uint32_t) p_packet) - ((uint32_t) &g_packet_pool[0])) / sizeof(mesh_packet_t))
+#define PACKET_INDEX(p_packet) (((uint32_t) (((uintptr_t) (p_packet)) - ((uintptr_t) &g_packet_pool[0]))) / sizeof(mesh_packet_t))
+#define PACKET_INDEX_INVALID    (0xFF)
+
+#if (RBC_MESH_PACKET_POOL_SIZE >= PACKET_INDEX_INVALID)
+    #error "The packet pool can not hold more than 254 packets"
+#endif
 /******************************************************************************
 * Static globals
 ******************************************************************************/
 static mesh_packet_t g_packet_pool[RBC_MESH_PACKET_POOL_SIZE];
 static uint8_t g_packet_refs[RBC_MESH_PACKET_POOL_SIZE];
+static uint8_t g_packet_free_next[RBC_MESH_PACKET_POOL_SIZE]; /** Next free packet in the free list, for packets without references */
+static uint8_t g_packet_free_head;
+static mesh_packet_pool_stats_t g_packet_pool_stats;
+/******************************************************************************
+* Static functions
+******************************************************************************/
+/** Put the packet at the given index back in the free list. Must be called
+  with IRQs disabled. */
+static void packet_free(uint32_t index)
+{
+    g_packet_free_next[index] = g_packet_free_head;
+    g_packet_free_head = index;
+    g_packet_pool_stats.in_use--;
+}
 /******************************************************************************
 * Interface functions
 ******************************************************************************/
@@ -47,26 +68,43 @@ void mesh_packet_init(void)
     {
         /* reset ref count field */
         g_packet_refs[i] = 0;
+        g_packet_free_next[i] = i + 1;
     }
+    g_packet_free_next[RBC_MESH_PACKET_POOL_SIZE - 1] = PACKET_INDEX_INVALID;
+    g_packet_free_head = 0;
+    memset(&g_packet_pool_stats, 0, sizeof(g_packet_pool_stats));
 }
 
 bool mesh_packet_acquire(mesh_packet_t** pp_packet)
 {
     uint32_t was_masked;
-    for (uint32_t i = 0; i < RBC_MESH_PACKET_POOL_SIZE; ++i)
+    _DISABLE_IRQS(was_masked);
+    uint32_t index = g_packet_free_head;
+    if (index == PACKET_INDEX_INVALID)
     {
-        _DISABLE_IRQS(was_masked);
-        if (g_packet_refs[i] == 0) /* no refs, free to use */
-        {
-            g_packet_refs[i] = 1;
-            *pp_packet = &g_packet_pool[i];
-            _ENABLE_IRQS(was_masked);
-            return true;
-        }
+        g_packet_pool_stats.acquire_failures++;
         _ENABLE_IRQS(was_masked);
+        APP_ERROR_CHECK(NRF_ERROR_NO_MEM);
+        return false;
+    }
+    g_packet_free_head = g_packet_free_next[index];
+    g_packet_refs[index] = 1;
+    if (++g_packet_pool_stats.in_use > g_packet_pool_stats.high_watermark)
+    {
+        g_packet_pool_stats.high_watermark = g_packet_pool_stats.in_use;
     }
-    APP_ERROR_CHECK(NRF_ERROR_NO_MEM);
-    return false;
+    _ENABLE_IRQS(was_masked);
+
+    *pp_packet = &g_packet_pool[index];
+    return true;
+}
+
+void mesh_packet_pool_stats_get(mesh_packet_pool_stats_t* p_stats)
+{
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    memcpy(p_stats, &g_packet_pool_stats, sizeof(mesh_packet_pool_stats_t));
+    _ENABLE_IRQS(was_masked);
 }
 
 mesh_packet_t* mesh_packet_get_aligned(void* p_buf_pointer)
@@ -119,10 +157,14 @@ bool mesh_packet_ref_count_dec(mesh_packet_t* p_packet)
         _ENABLE_IRQS(was_masked);
         return false;
     }
-    g_packet_refs[index]--;
+    bool has_refs = (--g_packet_refs[index] > 0);
+    if (!has_refs)
+    {
+        packet_free(index);
+    }
     _ENABLE_IRQS(was_masked);
 
-    return (g_packet_refs[index] > 0);
+    return has_refs;
 }
 
 uint8_t mesh_packet_ref_count_get(mesh_packet_t* p_packet)
@@ -198,6 +240,56 @@ uint32_t mesh_packet_build(mesh_packet_t* p_packet,
     return NRF_SUCCESS;
 }
 
+uint32_t mesh_packet_build_empty(mesh_packet_t* p_packet)
+{
+    if (p_packet == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    mesh_packet_set_local_addr(p_packet);
+
+    p_packet->header.length = MESH_PACKET_BLE_OVERHEAD;
+    p_packet->header.type = BLE_PACKET_TYPE_ADV_NONCONN_IND;
+
+    return NRF_SUCCESS;
+}
+
+uint32_t mesh_packet_adv_data_append(mesh_packet_t* p_packet, const mesh_adv_data_t* p_adv_data)
+{
+    if (p_packet == NULL || p_adv_data == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    const uint32_t payload_length = p_packet->header.length - MESH_PACKET_BLE_OVERHEAD;
+    const uint32_t adv_data_length = p_adv_data->adv_data_length + 1; /* length field in ad data is not considered */
+    if (p_packet->header.length < MESH_PACKET_BLE_OVERHEAD ||
+        payload_length + adv_data_length > BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    memcpy(&p_packet->payload[payload_length], p_adv_data, adv_data_length);
+    p_packet->header.length += adv_data_length;
+
+    return NRF_SUCCESS;
+}
+
+uint32_t mesh_packet_adv_data_extract(mesh_packet_t* p_dst, const mesh_packet_t* p_src, const mesh_adv_data_t* p_adv_data)
+{
+    if (p_dst == NULL || p_src == NULL || p_adv_data == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    /* keep the sender's header and address */
+    memcpy(p_dst, p_src, offsetof(mesh_packet_t, payload));
+    p_dst->header.length = MESH_PACKET_BLE_OVERHEAD;
+
+    return mesh_packet_adv_data_append(p_dst, p_adv_data);
+}
+
 uint32_t mesh_packet_adv_data_sanitize(mesh_packet_t* p_packet)
 {
     mesh_adv_data_t* p_mesh_adv_data = mesh_packet_adv_data_get(p_packet);
@@ -228,34 +320,51 @@ uint32_t mesh_packet_adv_data_sanitize(mesh_packet_t* p_packet)
 }
 
 mesh_adv_data_t* mesh_packet_adv_data_get(mesh_packet_t* p_packet)
+{
+    return mesh_packet_adv_data_next(p_packet, NULL);
+}
+
+mesh_adv_data_t* mesh_packet_adv_data_next(mesh_packet_t* p_packet, mesh_adv_data_t* p_prev)
 {
     if (p_packet == NULL)
     {
         return NULL;
     }
 
-    mesh_adv_data_t* p_mesh_adv_data = (mesh_adv_data_t*) &p_packet->payload[0];
     if (p_packet->header.length <= MESH_PACKET_BLE_OVERHEAD ||
         p_packet->header.length > MESH_PACKET_BLE_OVERHEAD + BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH)
     {
         return NULL;
     }
 
+    const uint8_t* p_end = &p_packet->payload[p_packet->header.length - MESH_PACKET_BLE_OVERHEAD];
+    uint8_t* p_ad = &p_packet->payload[0];
+    if (p_prev != NULL)
+    {
+        p_ad = ((uint8_t*) p_prev) + p_prev->adv_data_length + 1; /* length field in ad data is not considered */
+    }
+
     /* loop through all ad data structures */
-    while (p_mesh_adv_data->adv_data_type != MESH_ADV_DATA_TYPE ||
-           p_mesh_adv_data->mesh_uuid != MESH_UUID)
+    while (p_ad + offsetof(mesh_adv_data_t, handle) <= p_end)
     {
-        if (p_mesh_adv_data->adv_data_length + ((uint32_t) p_mesh_adv_data - (uint32_t) (p_packet->payload))
-               > p_packet->header.length - MESH_PACKET_BLE_OVERHEAD)
+        mesh_adv_data_t* p_mesh_adv_data = (mesh_adv_data_t*) p_ad;
+        if (p_mesh_adv_data->adv_data_length == 0 ||
+            p_ad + p_mesh_adv_data->adv_data_length + 1 > p_end)
         {
             /* invalid ad length */
             return NULL;
         }
-        p_mesh_adv_data += p_mesh_adv_data->adv_data_length + 1; /* length field in ad data is not considered */
+        if (p_mesh_adv_data->adv_data_type == MESH_ADV_DATA_TYPE &&
+            p_mesh_adv_data->adv_data_length >= offsetof(mesh_adv_data_t, handle) - 1 &&
+            p_mesh_adv_data->mesh_uuid == MESH_UUID)
+        {
+            /* The network packet overlaps with AD-data */
+            return p_mesh_adv_data;
+        }
+        p_ad += p_mesh_adv_data->adv_data_length + 1;
     }
 
-    /* The network packet overlaps with AD-data */
-    return (mesh_adv_data_t*) p_mesh_adv_data;
+    return NULL;
 }
 
 rbc_mesh_value_handle_t mesh_packet_handle_get(mesh_packet_t* p_packet)
@@ -275,17 +384,13 @@ rbc_mesh_value_handle_t mesh_packet_handle_get(mesh_packet_t* p_packet)
 bool mesh_packet_has_additional_data(mesh_packet_t* p_packet)
 {
     mesh_adv_data_t* p_mesh_adv_data = (mesh_adv_data_t*) &p_packet->payload[0];
-    while (((uint8_t*) p_mesh_adv_data) < &p_packet->payload[0] + (p_packet->header.length - 7))
+    if (mesh_packet_adv_data_get(p_packet) != p_mesh_adv_data)
     {
-        if (p_mesh_adv_data->adv_data_type != MESH_ADV_DATA_TYPE ||
-            p_mesh_adv_data->mesh_uuid != MESH_UUID)
-        {
-            return true;
-        }
-        p_mesh_adv_data += p_mesh_adv_data->adv_data_length + 1;
+        return true;
     }
 
-    return false;
+    return (p_packet->header.length >
+            MESH_PACKET_BLE_OVERHEAD + p_mesh_adv_data->adv_data_length + 1);
 }
 
 void mesh_packet_take_ownership(mesh_packet_t* p_packet)
@@ -302,7 +407,7 @@ void mesh_packet_take_ownership(mesh_packet_t* p_packet)
 
 mesh_packet_t* mesh_packet_get_start_pointer(void* p_content)
 {
-    uint32_t index = ((((uint32_t) p_content) - ((uint32_t) &g_packet_pool[0])) / sizeof(mesh_packet_t));
+    uint32_t index = PACKET_INDEX(p_content);
     if (index < RBC_MESH_PACKET_POOL_SIZE)
     {
         return &g_packet_pool[index];
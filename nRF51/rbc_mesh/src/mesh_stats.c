@@ -0,0 +1,95 @@
+/***********************************************************************************
+Copyright (c) Nordic Semiconductor ASA
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+  1. Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright notice, this
+  list of conditions and the following disclaimer in the documentation and/or
+  other materials provided with the distribution.
+
+  3. Neither the name of Nordic Semiconductor ASA nor the names of other
+  contributors to this software may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+************************************************************************************/
+
+#include "mesh_stats.h"
+
+#include "transport_control.h"
+#include "mesh_packet.h"
+#include "rbc_mesh_common.h"
+#include "toolchain.h"
+
+#include <string.h>
+
+/******************************************************************************
+* Static globals
+******************************************************************************/
+static uint32_t m_stats[RBC_MESH_STAT_COUNT];
+
+/******************************************************************************
+* Interface functions
+******************************************************************************/
+void mesh_stats_init(void)
+{
+    memset(m_stats, 0, sizeof(m_stats));
+}
+
+void mesh_stats_inc(rbc_mesh_stat_t stat)
+{
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    m_stats[stat]++;
+    _ENABLE_IRQS(was_masked);
+}
+
+void mesh_stats_max_set(rbc_mesh_stat_t stat, uint32_t value)
+{
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    if (value > m_stats[stat])
+    {
+        m_stats[stat] = value;
+    }
+    _ENABLE_IRQS(was_masked);
+}
+
+void mesh_stats_get(rbc_mesh_stats_t* p_stats)
+{
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    memcpy(p_stats->stats, m_stats, sizeof(m_stats));
+    _ENABLE_IRQS(was_masked);
+
+    /* sample the statistics kept by their own modules */
+    tc_rx_filter_stats_t filter_stats;
+    tc_rx_filter_stats_get(&filter_stats);
+    p_stats->stats[RBC_MESH_STAT_RX_DUPLICATE] = filter_stats.filtered;
+
+    tc_rx_backoff_status_t backoff_status;
+    tc_rx_backoff_status_get(&backoff_status);
+    p_stats->stats[RBC_MESH_STAT_RX_QUEUE_DROP] = backoff_status.queue_drops;
+    p_stats->stats[RBC_MESH_STAT_RX_THROTTLE] = backoff_status.throttle_count;
+    p_stats->stats[RBC_MESH_STAT_RX_SUSPEND] = backoff_status.suspend_count;
+
+    mesh_packet_pool_stats_t pool_stats;
+    mesh_packet_pool_stats_get(&pool_stats);
+    p_stats->stats[RBC_MESH_STAT_PACKET_POOL_IN_USE] = pool_stats.in_use;
+    p_stats->stats[RBC_MESH_STAT_PACKET_POOL_HIGH_WATERMARK] = pool_stats.high_watermark;
+    p_stats->stats[RBC_MESH_STAT_PACKET_POOL_ACQUIRE_FAIL] = pool_stats.acquire_failures;
+}
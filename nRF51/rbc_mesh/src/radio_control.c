@@ -32,7 +32,6 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "rbc_mesh_common.h"
 #include "timeslot.h"
 #include "trickle.h"
-#include "fifo.h"
 #include "nrf.h"
 #include "nrf_sdm.h"
 #include "app_error.h"
@@ -54,6 +53,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define PPI_CH_STOP_RX_ABORT            (TIMER_PPI_CH_START + 4)
 
+/** Number of times a normal priority event may be overtaken by high priority events before it's no longer moved. */
+#define RADIO_EVENT_OVERTAKE_MAX        (4)
+
+#define RADIO_QUEUE_INDEX(i)            ((m_radio_queue.head + (i)) & (RBC_MESH_RADIO_QUEUE_LENGTH - 1))
+
 #define DEBUG_RADIO_SET_STATE(state) do {\
     DEBUG_RADIO_CLEAR_PIN(PIN_RADIO_STATE_TX);\
     DEBUG_RADIO_CLEAR_PIN(PIN_RADIO_STATE_RX);\
@@ -72,6 +76,13 @@ typedef enum
     RADIO_STATE_NEVER_USED
 } radio_state_t;
 
+/** Radio queue entry. */
+typedef struct
+{
+    radio_event_t evt;
+    uint8_t overtaken_count; /**< Number of high priority events put in front of this one. */
+} radio_queue_entry_t;
+
 /*****************************************************************************
 * Static globals
 *****************************************************************************/
@@ -79,34 +90,112 @@ typedef enum
 /** Global radio state */
 static radio_state_t    m_radio_state = RADIO_STATE_NEVER_USED;
 
-static fifo_t           m_radio_fifo;
-static radio_event_t    m_radio_fifo_queue[RBC_MESH_RADIO_QUEUE_LENGTH];
+/** Radio event queue, ordered by priority. The head is the event in progress. */
+static struct
+{
+    radio_queue_entry_t entries[RBC_MESH_RADIO_QUEUE_LENGTH];
+    uint32_t head;
+    uint32_t length;
+} m_radio_queue;
 static radio_idle_cb_t  m_idle_cb;
 static radio_rx_cb_t    m_rx_cb;
 static radio_tx_cb_t    m_tx_cb;
 static uint32_t         m_alt_aa = RADIO_DEFAULT_ADDRESS;
+static rbc_mesh_radio_mode_t m_radio_mode = RBC_MESH_RADIO_MODE_BLE_1MBIT;
+/** The radio will ramp up for the next queued TX by itself when the current one ends. */
+static bool             m_tx_chained;
 /*****************************************************************************
 * Static functions
 *****************************************************************************/
+/** Get the event at the given position in the queue, or NULL if the queue is shorter. */
+static radio_event_t* radio_queue_peek(uint32_t index)
+{
+    if (index >= m_radio_queue.length)
+    {
+        return NULL;
+    }
+    return &m_radio_queue.entries[RADIO_QUEUE_INDEX(index)].evt;
+}
+
+static void radio_queue_pop(void)
+{
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    APP_ERROR_CHECK_BOOL(m_radio_queue.length > 0);
+    m_radio_queue.head = RADIO_QUEUE_INDEX(1);
+    m_radio_queue.length--;
+    _ENABLE_IRQS(was_masked);
+}
+
+/**
+* Queue the event behind all events of the same or higher priority. High
+* priority events overtake normal priority TX and preemptable RX events, but
+* never the event in progress, a TX chained to it, regular RX events or events
+* that have already been overtaken RADIO_EVENT_OVERTAKE_MAX times.
+*/
+static uint32_t radio_queue_insert(const radio_event_t* p_evt)
+{
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    if (m_radio_queue.length == RBC_MESH_RADIO_QUEUE_LENGTH)
+    {
+        _ENABLE_IRQS(was_masked);
+        return NRF_ERROR_NO_MEM;
+    }
+
+    uint32_t first_movable = 0;
+    if (m_radio_state == RADIO_STATE_RX ||
+        m_radio_state == RADIO_STATE_TX)
+    {
+        first_movable = (m_tx_chained ? 2 : 1);
+    }
+
+    uint32_t index = m_radio_queue.length;
+    if (p_evt->priority == RADIO_EVENT_PRIORITY_HIGH)
+    {
+        while (index > first_movable)
+        {
+            const radio_queue_entry_t* p_prev = &m_radio_queue.entries[RADIO_QUEUE_INDEX(index - 1)];
+            if (p_prev->evt.priority != RADIO_EVENT_PRIORITY_NORMAL ||
+                p_prev->evt.event_type == RADIO_EVENT_TYPE_RX ||
+                p_prev->overtaken_count >= RADIO_EVENT_OVERTAKE_MAX)
+            {
+                break;
+            }
+            index--;
+        }
+    }
+
+    for (uint32_t i = m_radio_queue.length; i > index; --i)
+    {
+        m_radio_queue.entries[RADIO_QUEUE_INDEX(i)] = m_radio_queue.entries[RADIO_QUEUE_INDEX(i - 1)];
+        m_radio_queue.entries[RADIO_QUEUE_INDEX(i)].overtaken_count++;
+    }
+    m_radio_queue.entries[RADIO_QUEUE_INDEX(index)].evt = *p_evt;
+    m_radio_queue.entries[RADIO_QUEUE_INDEX(index)].overtaken_count = 0;
+    m_radio_queue.length++;
+
+    _ENABLE_IRQS(was_masked);
+    return NRF_SUCCESS;
+}
+
 static void purge_preemptable(void)
 {
-    uint32_t events_in_queue = fifo_get_len(&m_radio_fifo);
-    while (events_in_queue > 1)
+    while (m_radio_queue.length > 1)
     {
-        radio_event_t current_evt;
-        if (fifo_peek(&m_radio_fifo, &current_evt) == NRF_SUCCESS &&
-            current_evt.event_type == RADIO_EVENT_TYPE_RX_PREEMPTABLE)
+        radio_event_t* p_current_evt = radio_queue_peek(0);
+        if (p_current_evt->event_type == RADIO_EVENT_TYPE_RX_PREEMPTABLE)
         {
             /* event is preemptable, stop it */
-            fifo_pop(&m_radio_fifo, NULL);
+            uint8_t* p_packet = p_current_evt->packet_ptr;
+            radio_queue_pop();
 
             radio_disable();
             while (NRF_RADIO->STATE != RADIO_STATE_STATE_Disabled);
             NRF_RADIO->EVENTS_END = 0;
 
             /* propagate failed rx event */
-            m_rx_cb(current_evt.packet_ptr, false, 0xFFFFFFFF, 100);
-            --events_in_queue;
+            m_rx_cb(p_packet, false, 0xFFFFFFFF, 100);
         }
         else
         {
@@ -135,6 +224,32 @@ static void radio_channel_set(uint8_t ch)
 
 }
 
+/** Only the packet pointer may change between chained transmissions, the
+    rest of the radio configuration is latched at ramp-up. */
+static bool tx_is_chainable(const radio_event_t* p_evt, const radio_event_t* p_next_evt)
+{
+    return (p_next_evt->event_type == RADIO_EVENT_TYPE_TX &&
+            p_next_evt->channel == p_evt->channel &&
+            p_next_evt->access_address == p_evt->access_address &&
+            p_next_evt->tx_power == p_evt->tx_power);
+}
+
+/** Let the radio go straight from the given TX to the next one in the queue,
+    skipping the disabled state, if their radio configurations match. */
+static void tx_chain_setup(const radio_event_t* p_evt)
+{
+    const radio_event_t* p_next_evt = radio_queue_peek(1);
+    m_tx_chained = (p_next_evt != NULL && tx_is_chainable(p_evt, p_next_evt));
+    if (m_tx_chained)
+    {
+        NRF_RADIO->SHORTS |= RADIO_SHORTS_DISABLED_TXEN_Msk;
+    }
+    else
+    {
+        NRF_RADIO->SHORTS &= ~RADIO_SHORTS_DISABLED_TXEN_Msk;
+    }
+}
+
 static void setup_event(radio_event_t* p_evt)
 {
     NRF_RADIO->SHORTS = RADIO_SHORTS_READY_START_Msk | RADIO_SHORTS_END_DISABLE_Msk | RADIO_SHORTS_ADDRESS_RSSISTART_Msk;
@@ -150,6 +265,8 @@ static void setup_event(radio_event_t* p_evt)
         DEBUG_RADIO_SET_STATE(PIN_RADIO_STATE_TX);
         NRF_RADIO->TXADDRESS = p_evt->access_address;
         NRF_RADIO->TXPOWER  = p_evt->tx_power;
+        NRF_RADIO->EVENTS_DISABLED = 0;
+        tx_chain_setup(p_evt);
         NRF_RADIO->TASKS_TXEN = 1;
         m_radio_state = RADIO_STATE_TX;
         
@@ -215,6 +332,15 @@ void radio_init(radio_idle_cb_t idle_cb,
                         | (((RADIO_PCNF1_WHITEEN_Enabled)   << RADIO_PCNF1_WHITEEN_Pos) & RADIO_PCNF1_WHITEEN_Msk)	// enable packet whitening
                       );
 
+#ifdef NRF52
+    if (m_radio_mode == RBC_MESH_RADIO_MODE_BLE_2MBIT)
+    {
+        /* 2Mbit BLE packets have a two byte preamble */
+        NRF_RADIO->MODE   = ((RADIO_MODE_MODE_Ble_2Mbit << RADIO_MODE_MODE_Pos) & RADIO_MODE_MODE_Msk);
+        NRF_RADIO->PCNF0 |= ((RADIO_PCNF0_PLEN_16bit << RADIO_PCNF0_PLEN_Pos) & RADIO_PCNF0_PLEN_Msk);
+    }
+#endif
+
     /* CRC config */
     NRF_RADIO->CRCPOLY = ((0x00065B << RADIO_CRCPOLY_CRCPOLY_Pos) & RADIO_CRCPOLY_CRCPOLY_Msk);    // CRC polynomial function
     NRF_RADIO->CRCCNF = (((RADIO_CRCCNF_SKIPADDR_Skip) << RADIO_CRCCNF_SKIPADDR_Pos) & RADIO_CRCCNF_SKIPADDR_Msk)
@@ -224,18 +350,16 @@ void radio_init(radio_idle_cb_t idle_cb,
     /* Lock interframe spacing, so that the radio won't send too soon / start RX too early */
     NRF_RADIO->TIFS = 148;
 
-    /* init radio packet fifo */
+    /* init radio event queue */
     if (m_radio_state == RADIO_STATE_NEVER_USED)
     {
         /* this flushes the queue */
-        m_radio_fifo.array_len = RBC_MESH_RADIO_QUEUE_LENGTH;
-        m_radio_fifo.elem_array = m_radio_fifo_queue;
-        m_radio_fifo.elem_size = sizeof(radio_event_t);
-        m_radio_fifo.memcpy_fptr = NULL;
-        fifo_init(&m_radio_fifo);
+        m_radio_queue.head = 0;
+        m_radio_queue.length = 0;
     }
 
     m_radio_state = RADIO_STATE_DISABLED;
+    m_tx_chained = false;
     NRF_RADIO->EVENTS_END = 0;
 
     NVIC_ClearPendingIRQ(RADIO_IRQn);
@@ -247,7 +371,7 @@ void radio_init(radio_idle_cb_t idle_cb,
     DEBUG_RADIO_CLEAR_PIN(PIN_RADIO_STATE_RX);
     DEBUG_RADIO_CLEAR_PIN(PIN_RADIO_STATE_TX);
 
-    if (fifo_is_empty(&m_radio_fifo))
+    if (m_radio_queue.length == 0)
     {
         m_idle_cb();
     }
@@ -265,6 +389,11 @@ void radio_alt_aa_set(uint32_t access_address)
     m_alt_aa = access_address;
 }
 
+void radio_mode_set(rbc_mesh_radio_mode_t radio_mode)
+{
+    m_radio_mode = radio_mode;
+}
+
 uint32_t radio_order(radio_event_t* p_radio_event)
 {
     if (p_radio_event == NULL)
@@ -278,7 +407,7 @@ uint32_t radio_order(radio_event_t* p_radio_event)
         return NRF_ERROR_INVALID_ADDR;
     }
 
-    if (fifo_push(&m_radio_fifo, p_radio_event) != NRF_SUCCESS)
+    if (radio_queue_insert(p_radio_event) != NRF_SUCCESS)
     {
         return NRF_ERROR_NO_MEM;
     }
@@ -300,6 +429,7 @@ void radio_disable(void)
     NRF_RADIO->INTENCLR = 0xFFFFFFFF;
     NRF_RADIO->TASKS_DISABLE = 1;
     m_radio_state = RADIO_STATE_DISABLED;
+    m_tx_chained = false;
     DEBUG_RADIO_SET_STATE(PIN_RADIO_STATE_IDLE);
 }
 
@@ -320,26 +450,44 @@ void radio_event_handler(void)
             rssi = NRF_RADIO->RSSISAMPLE;
         }
 
-        radio_event_t prev_evt;
         NRF_RADIO->EVENTS_END = 0;
 
         /* pop the event that just finished */
-        uint32_t error_code = fifo_pop(&m_radio_fifo, &prev_evt);
-        APP_ERROR_CHECK(error_code);
+        radio_event_t* p_prev_evt = radio_queue_peek(0);
+        APP_ERROR_CHECK_BOOL(p_prev_evt != NULL);
+        bool is_rx = (p_prev_evt->event_type == RADIO_EVENT_TYPE_RX ||
+                      p_prev_evt->event_type == RADIO_EVENT_TYPE_RX_PREEMPTABLE);
+        uint8_t* p_packet = p_prev_evt->packet_ptr;
+        radio_queue_pop();
+
+        if (m_tx_chained)
+        {
+            /* The radio ramps up for the next TX on its own once the
+               END_DISABLE short has taken effect. Hand it the next packet
+               before it starts, and decide whether to chain the one after. */
+            while (!NRF_RADIO->EVENTS_DISABLED);
+            NRF_RADIO->EVENTS_DISABLED = 0;
+
+            radio_event_t* p_next_evt = radio_queue_peek(0);
+            APP_ERROR_CHECK_BOOL(p_next_evt != NULL);
+            NRF_RADIO->PACKETPTR = (uint32_t) p_next_evt->packet_ptr;
+            tx_chain_setup(p_next_evt);
+        }
+        else
+        {
+            DEBUG_RADIO_SET_STATE(PIN_RADIO_STATE_IDLE);
+            m_radio_state = RADIO_STATE_DISABLED;
+        }
 
         /* send to super space */
-        if (prev_evt.event_type == RADIO_EVENT_TYPE_RX ||
-            prev_evt.event_type == RADIO_EVENT_TYPE_RX_PREEMPTABLE)
+        if (is_rx)
         {
-            m_rx_cb(prev_evt.packet_ptr, crc_status, crc, rssi);
+            m_rx_cb(p_packet, crc_status, crc, rssi);
         }
         else
         {
-            m_tx_cb(prev_evt.packet_ptr);
+            m_tx_cb(p_packet);
         }
-
-        DEBUG_RADIO_SET_STATE(PIN_RADIO_STATE_IDLE);
-        m_radio_state = RADIO_STATE_DISABLED;
     }
     else
     {
@@ -349,10 +497,10 @@ void radio_event_handler(void)
     if (m_radio_state == RADIO_STATE_DISABLED ||
         m_radio_state == RADIO_STATE_NEVER_USED)
     {
-        radio_event_t evt;
-        if (fifo_peek(&m_radio_fifo, &evt) == NRF_SUCCESS)
+        radio_event_t* p_evt = radio_queue_peek(0);
+        if (p_evt != NULL)
         {
-            setup_event(&evt);
+            setup_event(p_evt);
         }
         else
         {
@@ -83,7 +83,9 @@ uint32_t rand_prng_get(prng_t* p_prng)
     return p_prng->d;
 }
 
-#ifndef __linux__ /* TODO: Add Windows random generator for software testing on windows */
+#if defined(HOST)
+/* The host HAL provides a seedable rand_hw_rng_get(), see host/src/host_hal.c */
+#elif !defined(__linux__) /* TODO: Add Windows random generator for software testing on windows */
 
 uint32_t rand_hw_rng_get(uint8_t* p_result, uint16_t len)
 {
@@ -34,9 +34,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "timer_scheduler.h"
 #include "event_handler.h"
 #include "version_handler.h"
+#include "ack_handler.h"
 #include "transport_control.h"
 #include "mesh_packet.h"
 #include "mesh_gatt.h"
+#include "mesh_stats.h"
 #include "dfu_app.h"
 #include "fifo.h"
 
@@ -55,28 +57,6 @@ static uint32_t         m_interval_min_ms;
 static fifo_t           m_rbc_event_fifo;
 static rbc_mesh_event_t m_rbc_event_buffer[RBC_MESH_APP_EVENT_QUEUE_LENGTH];
 
-/*****************************************************************************
-* Static Functions
-*****************************************************************************/
-#if defined(WITH_ACK_MASTER) 
-static uint32_t top_queue_counter[4] __attribute__((at(0x20002F98)))={0};
-static uint32_t top_queue_drop __attribute__((at(0x20002FA8))) =0;
-#endif
-
-#if defined (WITHOUT_ACK_MASTER)
-static uint32_t top_queue_counter[4] __attribute__((at(0x200026B4))) ={0};
-static uint32_t top_queue_drop __attribute__((at(0x200026C4))) =0;
-#endif
-
-#if defined(WITH_ACK_SLAVE)
-static uint32_t top_queue_counter[4] __attribute__((at(0x200026A0)))  ={0};
-static uint32_t top_queue_drop __attribute__((at(0x200026B0)))  =0;
-#endif
-
-#if defined(WITHOUT_ACK_SLAVE)
-static uint32_t top_queue_counter[4] __attribute__((at(0x200026A0)))  ={0};
-static uint32_t top_queue_drop __attribute__((at(0x200026B0))) =0;
-#endif
 /*****************************************************************************
 * Interface Functions
 *****************************************************************************/
@@ -102,10 +82,22 @@ uint32_t rbc_mesh_init(rbc_mesh_init_params_t init_params)
         return NRF_ERROR_INVALID_PARAM;
     }
 
+    if (init_params.radio_mode == RBC_MESH_RADIO_MODE_BLE_2MBIT)
+    {
+#ifndef NRF52
+        return NRF_ERROR_NOT_SUPPORTED; /* the nRF51 radio only does 1Mbit BLE */
+#endif
+    }
+    else if (init_params.radio_mode != RBC_MESH_RADIO_MODE_BLE_1MBIT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    mesh_stats_init();
     timer_sch_init();
     event_handler_init();
     mesh_packet_init();
-    tc_init(init_params.access_addr, init_params.channel);
+    tc_init(init_params.access_addr, init_params.channel, init_params.radio_mode);
 
 
     uint32_t error_code;
@@ -242,6 +234,38 @@ uint32_t rbc_mesh_tx_event_set(rbc_mesh_value_handle_t handle, bool do_tx_event)
     return vh_tx_event_set(handle, do_tx_event);
 }
 
+uint32_t rbc_mesh_high_priority_set(rbc_mesh_value_handle_t handle, bool high_priority)
+{
+    if (m_mesh_state == MESH_STATE_UNINITIALIZED)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (handle > RBC_MESH_APP_MAX_HANDLE)
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+
+    return vh_high_priority_set(handle, high_priority);
+}
+
+uint32_t rbc_mesh_value_trickle_params_set(rbc_mesh_value_handle_t handle, uint16_t i_min_ms, uint8_t i_max, uint8_t k)
+{
+    if (m_mesh_state == MESH_STATE_UNINITIALIZED)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (handle > RBC_MESH_APP_MAX_HANDLE)
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+
+    trickle_params_t params;
+    params.i_min_ms = i_min_ms;
+    params.i_max = i_max;
+    params.k = k;
+    return vh_value_trickle_params_set(handle, &params);
+}
+
 /****** Getters and setters ******/
 
 uint32_t rbc_mesh_value_set(rbc_mesh_value_handle_t handle, uint8_t* data, uint16_t len)
@@ -256,11 +280,45 @@ uint32_t rbc_mesh_value_set(rbc_mesh_value_handle_t handle, uint8_t* data, uint1
     }
 
     /* no critical errors if this call fails, ignore return */
-    mesh_gatt_value_set(handle, data, len);
+    if (len <= RBC_MESH_VALUE_MAX_LEN)
+    {
+        mesh_gatt_value_set(handle, data, len);
+    }
 
     return vh_local_update(handle, data, len);
 }
 
+uint32_t rbc_mesh_value_set_acked(rbc_mesh_value_handle_t handle, uint8_t* data, uint16_t len)
+{
+    if (m_mesh_state == MESH_STATE_UNINITIALIZED)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (handle > RBC_MESH_APP_MAX_HANDLE)
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+
+    /* no critical errors if this call fails, ignore return */
+    if (len <= RBC_MESH_VALUE_MAX_LEN)
+    {
+        mesh_gatt_value_set(handle, data, len);
+    }
+
+    return ack_handler_local_update(handle, data, len);
+}
+
+uint32_t rbc_mesh_ack_sink_set(bool is_sink)
+{
+    if (m_mesh_state == MESH_STATE_UNINITIALIZED)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    ack_handler_sink_set(is_sink);
+    return NRF_SUCCESS;
+}
+
 uint32_t rbc_mesh_value_get(rbc_mesh_value_handle_t handle, uint8_t* data, uint16_t* len)
 {
     if (handle > RBC_MESH_APP_MAX_HANDLE)
@@ -329,6 +387,51 @@ void rbc_mesh_tx_power_set(rbc_mesh_txpower_t tx_power)
     vh_tx_power_set(tx_power);
 }
 
+uint32_t rbc_mesh_stats_get(rbc_mesh_stats_t* p_stats)
+{
+    if (m_mesh_state == MESH_STATE_UNINITIALIZED)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (p_stats == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    mesh_stats_get(p_stats);
+    return NRF_SUCCESS;
+}
+
+uint32_t rbc_mesh_channel_map_set(uint8_t channel_map, uint32_t dwell_time_ms)
+{
+    if (m_mesh_state == MESH_STATE_UNINITIALIZED)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (channel_map & ~RBC_MESH_ADV_CHANNEL_MAP_ALL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    /* only need a dwell time if there's more than one channel */
+    if ((channel_map & (channel_map - 1)) &&
+        (dwell_time_ms < RBC_MESH_CHANNEL_DWELL_TIME_MIN_MS ||
+         dwell_time_ms > RBC_MESH_CHANNEL_DWELL_TIME_MAX_MS))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    if (channel_map == 0)
+    {
+        vh_tx_channels_set(m_channel, 1);
+    }
+    else
+    {
+        vh_tx_channels_set(37, channel_map);
+    }
+    tc_rx_channel_map_set(channel_map, dwell_time_ms * 1000); /* ms -> us */
+    return NRF_SUCCESS;
+}
+
 
 void rbc_mesh_ble_evt_handler(ble_evt_t* p_evt)
 {
@@ -359,36 +462,34 @@ uint32_t rbc_mesh_event_push(rbc_mesh_event_t* p_event)
     
     uint32_t error_code = fifo_push(&m_rbc_event_fifo, p_event);
     
-    #if defined(WITH_ACK_MASTER) || defined (WITHOUT_ACK_MASTER)|| defined (WITH_ACK_SLAVE)|| defined (WITHOUT_ACK_SLAVE)
-    
-    
-		
-		if (error_code != NRF_SUCCESS)
-			   top_queue_drop++;
-		
-		 switch (p_event->type)
-         {
+    if (error_code != NRF_SUCCESS)
+    {
+        mesh_stats_inc(RBC_MESH_STAT_APP_QUEUE_DROP);
+    }
+    else
+    {
+        mesh_stats_max_set(RBC_MESH_STAT_APP_QUEUE_HIGH_WATERMARK, fifo_get_len(&m_rbc_event_fifo));
+        switch (p_event->type)
+        {
             case RBC_MESH_EVENT_TYPE_NEW_VAL:
-					top_queue_counter[0]++;
-				    break;
-						
+                mesh_stats_inc(RBC_MESH_STAT_APP_EVT_NEW_VAL);
+                break;
             case RBC_MESH_EVENT_TYPE_UPDATE_VAL:
-					top_queue_counter[1]++;
-					break;
+                mesh_stats_inc(RBC_MESH_STAT_APP_EVT_UPDATE_VAL);
+                break;
             case RBC_MESH_EVENT_TYPE_CONFLICTING_VAL:
-					top_queue_counter[2]++;
-				    break;
-			case RBC_MESH_EVENT_TYPE_TX:
-					top_queue_counter[3]++;
-					break;
-						
-			default:
-					break;
-		}
-         
-      #endif
-        
-    
+                mesh_stats_inc(RBC_MESH_STAT_APP_EVT_CONFLICTING_VAL);
+                break;
+            case RBC_MESH_EVENT_TYPE_TX:
+                mesh_stats_inc(RBC_MESH_STAT_APP_EVT_TX);
+                break;
+            case RBC_MESH_EVENT_TYPE_ACKED:
+                mesh_stats_inc(RBC_MESH_STAT_APP_EVT_ACKED);
+                break;
+            default:
+                break;
+        }
+    }
 
     if (error_code == NRF_SUCCESS && p_event->params.rx.p_data != NULL)
     {
@@ -74,7 +74,7 @@ static serial_data_t tx_fifo_buffer[SERIAL_QUEUE_SIZE];
 
 static uint8_t dummy_data = 0;
 static serial_data_t rx_buffer;
-static serial_data_t tx_buffer;
+static serial_data_t* p_tx_buffer; /* points into the tx queue while transmitting */
 
 static serial_state_t serial_state;
 static bool has_pending_tx = false;
@@ -130,10 +130,11 @@ static void do_transmit(void)
 
     bool ordered_buffer = false;
 
-    if (fifo_pop(&tx_fifo, &tx_buffer) == NRF_SUCCESS)
+    /* transmit directly from the queue, the slot is released once the master has received it */
+    if (fifo_pop_peek_ptr(&tx_fifo, (void**) &p_tx_buffer) == NRF_SUCCESS)
     {
-        tx_len = tx_buffer.buffer[SERIAL_LENGTH_POS] + 2;
-        tx_ptr = (uint8_t*) &tx_buffer;
+        tx_len = p_tx_buffer->buffer[SERIAL_LENGTH_POS] + 2;
+        tx_ptr = (uint8_t*) p_tx_buffer;
         memset(rx_buffer.buffer, 0, SERIAL_DATA_MAX_LEN);
         error_code = spi_slave_buffers_set(tx_ptr,
                                           rx_buffer.buffer,
@@ -219,11 +220,12 @@ void spi_event_handler(spi_slave_evt_t evt)
             if (doing_tx)
             {
                 doing_tx = false;
-                if (evt.tx_amount < tx_buffer.buffer[SERIAL_LENGTH_POS] + 2)
+                if (evt.tx_amount >= p_tx_buffer->buffer[SERIAL_LENGTH_POS] + 2)
                 {
-                    /* master failed to receive our event. Re-send it. */
-                    serial_handler_event_send((serial_evt_t*)tx_buffer.buffer);
+                    fifo_pop_release(&tx_fifo);
                 }
+                /* else: master failed to receive our event. Leave it at the
+                   head of the queue to re-send it. */
             }
             /* handle incoming */
             if (rx_buffer.buffer[SERIAL_LENGTH_POS] > 0)
@@ -283,11 +285,13 @@ void serial_handler_init(void)
     tx_fifo.elem_array = tx_fifo_buffer;
     tx_fifo.elem_size = sizeof(serial_data_t);
     tx_fifo.memcpy_fptr = NULL;
+    tx_fifo.spsc = false;
     fifo_init(&tx_fifo);
     rx_fifo.array_len = SERIAL_QUEUE_SIZE;
     rx_fifo.elem_array = rx_fifo_buffer;
     rx_fifo.elem_size = sizeof(serial_data_t);
     rx_fifo.memcpy_fptr = NULL;
+    rx_fifo.spsc = true; /* pushed in the SPI IRQ, popped in the event handler */
     fifo_init(&rx_fifo);
 
     nrf_gpio_cfg_output(PIN_RDYN);
@@ -342,10 +346,16 @@ bool serial_handler_event_send(serial_evt_t* evt)
     enable_pin_listener(false);
     NVIC_DisableIRQ(SPI1_TWI1_IRQn); /* critical section */
 
-    serial_data_t raw_data;
-    raw_data.status_byte = 0;
-    memcpy(raw_data.buffer, evt, evt->length + 1);
-    fifo_push(&tx_fifo, &raw_data);
+    serial_data_t* p_raw_data;
+    if (fifo_push_reserve(&tx_fifo, (void**) &p_raw_data) != NRF_SUCCESS)
+    {
+        enable_pin_listener(serial_state == SERIAL_STATE_IDLE);
+        NVIC_EnableIRQ(SPI1_TWI1_IRQn);
+        return false;
+    }
+    p_raw_data->status_byte = 0;
+    memcpy(p_raw_data->buffer, evt, evt->length + 1);
+    fifo_push_commit(&tx_fifo);
 
     if (fifo_is_full(&rx_fifo))
     {
@@ -367,17 +377,18 @@ bool serial_handler_command_get(serial_cmd_t* cmd)
     race condition */
     NVIC_DisableIRQ(SPI1_TWI1_IRQn);
     enable_pin_listener(false);
-    serial_data_t temp;
-    if (fifo_pop(&rx_fifo, &temp) != NRF_SUCCESS)
+    serial_data_t* p_data;
+    if (fifo_pop_peek_ptr(&rx_fifo, (void**) &p_data) != NRF_SUCCESS)
     {
         enable_pin_listener(true);
         NVIC_EnableIRQ(SPI1_TWI1_IRQn);
         return false;
     }
-    if (temp.buffer[SERIAL_LENGTH_POS] > 0)
+    if (p_data->buffer[SERIAL_LENGTH_POS] > 0)
     {
-        memcpy(cmd, temp.buffer, temp.buffer[SERIAL_LENGTH_POS] + 1);
+        memcpy(cmd, p_data->buffer, p_data->buffer[SERIAL_LENGTH_POS] + 1);
     }
+    fifo_pop_release(&rx_fifo);
 
 
     /* just made room in the queue */
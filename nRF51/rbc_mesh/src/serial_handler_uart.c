@@ -59,7 +59,6 @@ static serial_data_t    m_rx_fifo_buffer[SERIAL_QUEUE_SIZE];
 static serial_data_t    m_tx_fifo_buffer[SERIAL_QUEUE_SIZE];
 
 static serial_state_t   m_serial_state;
-static serial_data_t    m_tx_buffer;
 static uint32_t         m_tx_len;
 static uint8_t*         mp_tx_ptr;
 static bool             m_suspend;
@@ -83,10 +82,12 @@ static void mesh_aci_command_check_cb(void* p_context)
 /** @brief Process packet queue, always done in the async context */
 static void do_transmit(void* p_context)
 {
-    if (fifo_pop(&m_tx_fifo, &m_tx_buffer) == NRF_SUCCESS)
+    serial_data_t* p_tx_buffer;
+    /* transmit directly from the queue, the slot is released when the transmission is done */
+    if (fifo_pop_peek_ptr(&m_tx_fifo, (void**) &p_tx_buffer) == NRF_SUCCESS)
     {
-        m_tx_len = ((serial_evt_t*) m_tx_buffer.buffer)->length; /* should be serial_evt_t->length+1, but will be decremented after the push below, so we don't bother */
-        mp_tx_ptr = &m_tx_buffer.buffer[0];
+        m_tx_len = ((serial_evt_t*) p_tx_buffer->buffer)->length; /* should be serial_evt_t->length+1, but will be decremented after the push below, so we don't bother */
+        mp_tx_ptr = &p_tx_buffer->buffer[0];
 
         NRF_UART0->EVENTS_TXDRDY = 0;
         NRF_UART0->TASKS_STARTTX = 1;
@@ -117,26 +118,38 @@ static void schedule_transmit(void)
 
 static void char_rx(uint8_t c)
 {
-    static serial_data_t rx_buf = {0};
-    static uint8_t* pp = rx_buf.buffer;
+    static serial_data_t overflow_buf; /* receives commands when there's no room in the queue */
+    static serial_data_t* p_rx_buf = NULL;
+    static uint8_t* pp;
+
+    if (p_rx_buf == NULL)
+    {
+        /* start of a new command, receive it directly into the queue */
+        if (fifo_push_reserve(&m_rx_fifo, (void**) &p_rx_buf) != NRF_SUCCESS)
+        {
+            p_rx_buf = &overflow_buf;
+        }
+        pp = p_rx_buf->buffer;
+    }
 
     *(pp++) = c;
 
-    uint32_t len = (uint32_t)(pp - rx_buf.buffer);
-    if (len >= sizeof(rx_buf) || (len > 1 && len >= rx_buf.buffer[0] + 1)) /* end of command */
+    uint32_t len = (uint32_t)(pp - p_rx_buf->buffer);
+    if (len >= sizeof(p_rx_buf->buffer) || (len > 1 && len >= p_rx_buf->buffer[0] + 1)) /* end of command */
     {
-        if (fifo_push(&m_rx_fifo, &rx_buf) != NRF_SUCCESS)
+        if (p_rx_buf == &overflow_buf)
         {
             /* respond inline, queue was full */
             serial_evt_t fail_evt;
             fail_evt.length = 3;
             fail_evt.opcode = SERIAL_EVT_OPCODE_CMD_RSP;
-            fail_evt.params.cmd_rsp.command_opcode = ((serial_cmd_t*) rx_buf.buffer)->opcode;
+            fail_evt.params.cmd_rsp.command_opcode = ((serial_cmd_t*) p_rx_buf->buffer)->opcode;
             fail_evt.params.cmd_rsp.status = ACI_STATUS_ERROR_BUSY;
             serial_handler_event_send(&fail_evt);
         }
         else
         {
+            fifo_push_commit(&m_rx_fifo);
 #ifdef BOOTLOADER
             NVIC_SetPendingIRQ(SWI2_IRQn);
 #else
@@ -153,7 +166,7 @@ static void char_rx(uint8_t c)
             m_serial_state = SERIAL_STATE_WAIT_FOR_QUEUE;
             NRF_UART0->TASKS_STOPRX = 1;
         }
-        pp = rx_buf.buffer;
+        p_rx_buf = NULL;
     }
 }
 
@@ -181,6 +194,7 @@ void UART0_IRQHandler(void)
         else
         {
             NRF_UART0->TASKS_STOPTX = 1;
+            fifo_pop_release(&m_tx_fifo);
             if (m_serial_state != SERIAL_STATE_WAIT_FOR_QUEUE)
             {
                 m_serial_state = SERIAL_STATE_IDLE;
@@ -205,11 +219,13 @@ void serial_handler_init(void)
     m_tx_fifo.elem_array = m_tx_fifo_buffer;
     m_tx_fifo.elem_size = sizeof(serial_data_t);
     m_tx_fifo.memcpy_fptr = NULL;
+    m_tx_fifo.spsc = false; /* events are pushed from both the UART IRQ and the event handler */
     fifo_init(&m_tx_fifo);
     m_rx_fifo.array_len = SERIAL_QUEUE_SIZE;
     m_rx_fifo.elem_array = m_rx_fifo_buffer;
     m_rx_fifo.elem_size = sizeof(serial_data_t);
     m_rx_fifo.memcpy_fptr = NULL;
+    m_rx_fifo.spsc = true; /* pushed in the UART IRQ, popped in the event handler */
     fifo_init(&m_rx_fifo);
 
     m_suspend = false;
@@ -258,15 +274,19 @@ void serial_wait_for_completion(void)
 
 bool serial_handler_event_send(serial_evt_t* evt)
 {
-    if (fifo_is_full(&m_tx_fifo))
+    serial_data_t* p_raw_data;
+    uint32_t was_masked;
+    /* events may be sent from both the UART IRQ and the event handler, keep them from sharing a slot */
+    _DISABLE_IRQS(was_masked);
+    if (fifo_push_reserve(&m_tx_fifo, (void**) &p_raw_data) != NRF_SUCCESS)
     {
+        _ENABLE_IRQS(was_masked);
         return false;
     }
-
-    serial_data_t raw_data;
-    raw_data.status_byte = 0;
-    memcpy(raw_data.buffer, evt, evt->length + 1);
-    fifo_push(&m_tx_fifo, &raw_data);
+    p_raw_data->status_byte = 0;
+    memcpy(p_raw_data->buffer, evt, evt->length + 1);
+    fifo_push_commit(&m_tx_fifo);
+    _ENABLE_IRQS(was_masked);
 
     if (m_serial_state == SERIAL_STATE_IDLE)
     {
@@ -278,15 +298,16 @@ bool serial_handler_event_send(serial_evt_t* evt)
 
 bool serial_handler_command_get(serial_cmd_t* cmd)
 {
-    serial_data_t temp;
-    if (fifo_pop(&m_rx_fifo, &temp) != NRF_SUCCESS)
+    serial_data_t* p_data;
+    if (fifo_pop_peek_ptr(&m_rx_fifo, (void**) &p_data) != NRF_SUCCESS)
     {
         return false;
     }
-    if (((serial_cmd_t*) temp.buffer)->length > 0)
+    if (((serial_cmd_t*) p_data->buffer)->length > 0)
     {
-        memcpy(cmd, temp.buffer, ((serial_cmd_t*) temp.buffer)->length + 1);
+        memcpy(cmd, p_data->buffer, ((serial_cmd_t*) p_data->buffer)->length + 1);
     }
+    fifo_pop_release(&m_rx_fifo);
 
     if (m_serial_state == SERIAL_STATE_WAIT_FOR_QUEUE)
     {
@@ -38,12 +38,37 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /** Time in us to regard as immidiate when firing several timers at once */
 #define TIMER_MARGIN    (100)
 
+#ifdef TIMER_SCH_TIMING_WHEEL
+/** Each wheel tick is 2^TIMER_WHEEL_TICK_BITS us */
+#define TIMER_WHEEL_TICK_BITS           (7)
+#define TIMER_WHEEL_SLOT_BITS           (5)
+#define TIMER_WHEEL_SLOTS               (1 << TIMER_WHEEL_SLOT_BITS)
+/** Enough levels to cover the entire timestamp range */
+#define TIMER_WHEEL_LEVELS              ((32 - TIMER_WHEEL_TICK_BITS) / TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_TICK_MASK           ((1UL << (32 - TIMER_WHEEL_TICK_BITS)) - 1)
+
+#if (TIMER_WHEEL_TICK_BITS + TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS != 32)
+    #error "The timing wheel levels must cover the entire timestamp range"
+#endif
+
+#define TIMESTAMP_TO_TICK(timestamp)    ((uint32_t) (timestamp) >> TIMER_WHEEL_TICK_BITS)
+#define TICK_TO_TIMESTAMP(tick)         ((timestamp_t) ((tick) << TIMER_WHEEL_TICK_BITS))
+#define LEVEL_SHIFT(level)              ((level) * TIMER_WHEEL_SLOT_BITS)
+#define TICK_SLOT(tick, level)          (((tick) >> LEVEL_SHIFT(level)) & (TIMER_WHEEL_SLOTS - 1))
+#endif
+
 /*****************************************************************************
 * Local typedefs
 *****************************************************************************/
 typedef struct
 {
+#ifdef TIMER_SCH_TIMING_WHEEL
+    timer_event_t* p_slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS]; /** Unsorted event lists for each wheel slot */
+    uint32_t occupied[TIMER_WHEEL_LEVELS];  /** Bitmap of non-empty slots for each level */
+    uint32_t cursor;                        /** Wheel tick of the last processed slot. No events are scheduled before it. */
+#else
     timer_event_t* p_head;
+#endif
     uint32_t pending_reschedules;
 } scheduler_t;
 
@@ -56,6 +81,273 @@ static scheduler_t m_scheduler; /** Global scheduler instance */
 *****************************************************************************/
 static void timer_cb(timestamp_t timestamp);
 
+#ifdef TIMER_SCH_TIMING_WHEEL
+/** Index of the lowest set bit in a non-zero bitmap. */
+static uint32_t lowest_bit_get(uint32_t bitmap)
+{
+    uint32_t index = 0;
+    if ((bitmap & 0xFFFF) == 0) { index += 16; bitmap >>= 16; }
+    if ((bitmap & 0x00FF) == 0) { index +=  8; bitmap >>=  8; }
+    if ((bitmap & 0x000F) == 0) { index +=  4; bitmap >>=  4; }
+    if ((bitmap & 0x0003) == 0) { index +=  2; bitmap >>=  2; }
+    if ((bitmap & 0x0001) == 0) { index +=  1; }
+    return index;
+}
+
+static bool wheel_is_empty(void)
+{
+    for (uint32_t level = 0; level < TIMER_WHEEL_LEVELS; ++level)
+    {
+        if (m_scheduler.occupied[level])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Get the earliest non-empty slot in the wheel. Levels are searched from the
+  bottom, as all events on a level expire before the events on the levels
+  above it. */
+static bool wheel_next_slot_get(uint32_t* p_level, uint32_t* p_slot)
+{
+    for (uint32_t level = 0; level < TIMER_WHEEL_LEVELS; ++level)
+    {
+        uint32_t current = TICK_SLOT(m_scheduler.cursor, level);
+        uint32_t bitmap = m_scheduler.occupied[level];
+        if (bitmap == 0)
+        {
+            continue;
+        }
+
+        /* Events due before the cursor are kept in the cursor's level 0 slot,
+           higher levels only hold events after the cursor's slot. */
+        uint32_t ahead;
+        if (level == 0)
+        {
+            ahead = bitmap & (0xFFFFFFFF << current);
+        }
+        else
+        {
+            ahead = (current == TIMER_WHEEL_SLOTS - 1) ? 0 : bitmap & (0xFFFFFFFF << (current + 1));
+        }
+
+        if (ahead)
+        {
+            *p_level = level;
+            *p_slot = lowest_bit_get(ahead);
+            return true;
+        }
+        else if (level == TIMER_WHEEL_LEVELS - 1)
+        {
+            /* the top level wraps around with the timestamp */
+            *p_level = level;
+            *p_slot = lowest_bit_get(bitmap);
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Get the first tick covered by the given slot, relative to the cursor. */
+static uint32_t wheel_slot_tick_get(uint32_t level, uint32_t slot)
+{
+    uint32_t block_bits = LEVEL_SHIFT(level + 1);
+    uint32_t base = (block_bits >= 32) ? 0 : (m_scheduler.cursor & ~((1UL << block_bits) - 1));
+    return (base | (slot << LEVEL_SHIFT(level))) & TIMER_WHEEL_TICK_MASK;
+}
+
+/** Detach the event list in the given slot, and return its head. */
+static timer_event_t* wheel_slot_detach(uint32_t level, uint32_t slot)
+{
+    timer_event_t* p_head = m_scheduler.p_slots[level][slot];
+    m_scheduler.p_slots[level][slot] = NULL;
+    m_scheduler.occupied[level] &= ~(1UL << slot);
+    return p_head;
+}
+
+/** Move the cursor up to the current time if the wheel is empty, to keep it
+  close to the timestamps being scheduled. Must only be called before
+  scheduling new events, never while the wheel is being processed, as the
+  cursor may be ahead of the current time then. The cursor never moves
+  backwards. */
+static void wheel_cursor_update(timestamp_t time_now)
+{
+    if (wheel_is_empty() &&
+        TIMER_OLDER_THAN(TICK_TO_TIMESTAMP(m_scheduler.cursor), time_now))
+    {
+        m_scheduler.cursor = TIMESTAMP_TO_TICK(time_now);
+    }
+}
+
+static void add_evt(timer_event_t* p_evt)
+{
+    uint32_t tick = TIMESTAMP_TO_TICK(p_evt->timestamp);
+    if (TIMER_OLDER_THAN(p_evt->timestamp, TICK_TO_TIMESTAMP(m_scheduler.cursor)))
+    {
+        tick = m_scheduler.cursor;
+    }
+
+    /* the level is decided by the highest slot index the tick differs from the cursor in */
+    uint32_t diff = tick ^ m_scheduler.cursor;
+    uint32_t level = 0;
+    while ((diff >> LEVEL_SHIFT(level + 1)) != 0 && level < TIMER_WHEEL_LEVELS - 1)
+    {
+        level++;
+    }
+    uint32_t slot = TICK_SLOT(tick, level);
+
+    timer_event_t** pp_head = &m_scheduler.p_slots[level][slot];
+    p_evt->p_next = *pp_head;
+    if (p_evt->p_next != NULL)
+    {
+        p_evt->p_next->pp_prev = &p_evt->p_next;
+    }
+    p_evt->pp_prev = pp_head;
+    *pp_head = p_evt;
+    m_scheduler.occupied[level] |= (1UL << slot);
+}
+
+static uint32_t remove_evt(timer_event_t* p_evt)
+{
+    if (p_evt->pp_prev == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    *p_evt->pp_prev = p_evt->p_next;
+    if (p_evt->p_next != NULL)
+    {
+        p_evt->p_next->pp_prev = p_evt->pp_prev;
+    }
+    else if (p_evt->pp_prev >= &m_scheduler.p_slots[0][0] &&
+             p_evt->pp_prev <= &m_scheduler.p_slots[TIMER_WHEEL_LEVELS - 1][TIMER_WHEEL_SLOTS - 1] &&
+             *p_evt->pp_prev == NULL)
+    {
+        /* was the only event in its slot */
+        uint32_t index = p_evt->pp_prev - &m_scheduler.p_slots[0][0];
+        m_scheduler.occupied[index / TIMER_WHEEL_SLOTS] &= ~(1UL << (index % TIMER_WHEEL_SLOTS));
+    }
+
+    p_evt->p_next = NULL;
+    p_evt->pp_prev = NULL;
+    return NRF_SUCCESS;
+}
+
+/** Redistribute the events in the given slot to the levels below, after the
+  cursor has moved to the beginning of it. */
+static void wheel_cascade(uint32_t level, uint32_t slot)
+{
+    timer_event_t* p_evt = wheel_slot_detach(level, slot);
+    while (p_evt)
+    {
+        timer_event_t* p_next = p_evt->p_next;
+        add_evt(p_evt);
+        p_evt = p_next;
+    }
+}
+
+static void fire_timers(timestamp_t time_now)
+{
+    if (m_scheduler.pending_reschedules)
+    {
+        return;
+    }
+
+    const timestamp_t fire_limit = time_now + TIMER_MARGIN;
+    uint32_t level;
+    uint32_t slot;
+    while (wheel_next_slot_get(&level, &slot))
+    {
+        uint32_t tick = wheel_slot_tick_get(level, slot);
+        /* The cursor slot may hold events that are overdue, even if the cursor has passed the time */
+        if (!(level == 0 && tick == m_scheduler.cursor) &&
+            TIMER_OLDER_THAN(fire_limit, TICK_TO_TIMESTAMP(tick)))
+        {
+            break;
+        }
+
+        m_scheduler.cursor = tick;
+        if (level > 0)
+        {
+            wheel_cascade(level, slot);
+            continue;
+        }
+
+        bool queue_full = false;
+        timer_event_t* p_evt = wheel_slot_detach(level, slot);
+        while (p_evt)
+        {
+            timer_event_t* p_next = p_evt->p_next;
+            p_evt->p_next = NULL;
+            p_evt->pp_prev = NULL;
+
+            if (!queue_full && TIMER_OLDER_THAN(p_evt->timestamp, fire_limit))
+            {
+                async_event_t evt;
+                evt.type = EVENT_TYPE_TIMER_SCH;
+                evt.callback.timer_sch.cb = p_evt->cb;
+                evt.callback.timer_sch.p_context = p_evt->p_context;
+                evt.callback.timer_sch.timestamp = time_now;
+                if (event_handler_push(&evt) != NRF_SUCCESS)
+                {
+                    /* event queue full, put the rest back */
+                    queue_full = true;
+                    add_evt(p_evt);
+                }
+                else if (p_evt->interval != 0)
+                {
+                    do
+                    {
+                        p_evt->timestamp += p_evt->interval;
+                    } while (TIMER_OLDER_THAN(p_evt->timestamp, fire_limit));
+
+                    add_evt(p_evt);
+                }
+            }
+            else
+            {
+                add_evt(p_evt);
+            }
+            p_evt = p_next;
+        }
+
+        if (queue_full || m_scheduler.p_slots[level][slot] != NULL)
+        {
+            /* the remaining events in the slot aren't due yet */
+            break;
+        }
+    }
+}
+
+static void setup_timeout(timestamp_t time_now)
+{
+    uint32_t level;
+    uint32_t slot;
+    if (wheel_next_slot_get(&level, &slot))
+    {
+        /* the slots aren't sorted, find the earliest event in the next one */
+        timer_event_t* p_evt = m_scheduler.p_slots[level][slot];
+        timestamp_t timeout = p_evt->timestamp;
+        for (p_evt = p_evt->p_next; p_evt != NULL; p_evt = p_evt->p_next)
+        {
+            if (TIMER_OLDER_THAN(p_evt->timestamp, timeout))
+            {
+                timeout = p_evt->timestamp;
+            }
+        }
+
+        if (TIMER_OLDER_THAN(time_now, timeout))
+        {
+            timer_order_cb(TIMER_INDEX_SCHEDULER, timeout, timer_cb, TIMER_ATTR_NONE);
+        }
+        else
+        {
+            timer_order_cb(TIMER_INDEX_SCHEDULER, time_now + TIMER_MARGIN, timer_cb, TIMER_ATTR_NONE);
+        }
+    }
+}
+#else
 static void add_evt(timer_event_t* p_evt)
 {
     if (m_scheduler.p_head == NULL ||
@@ -86,11 +378,10 @@ static uint32_t remove_evt(timer_event_t* p_evt)
         return NRF_SUCCESS;
     }
 
+    /* the timestamp may already have been changed by timer_sch_reschedule(),
+       so it can't be used to end the search early. */
     timer_event_t* p_temp = m_scheduler.p_head;
-    while (p_temp &&
-           p_temp->p_next &&
-           !TIMER_OLDER_THAN(p_evt->timestamp, p_temp->p_next->timestamp)
-          )
+    while (p_temp && p_temp->p_next)
     {
         if (p_temp->p_next == p_evt)
         {
@@ -157,12 +448,16 @@ static void setup_timeout(timestamp_t time_now)
         }
     }
 }
+#endif /* TIMER_SCH_TIMING_WHEEL */
 
 static void async_schedule(void* p_context)
 {
     TICK_PIN(3);
     timer_event_t* p_evt = (timer_event_t*) p_context;
     timestamp_t time_now = timer_now();
+#ifdef TIMER_SCH_TIMING_WHEEL
+    wheel_cursor_update(time_now);
+#endif
     add_evt(p_evt);
 
     fire_timers(time_now);
@@ -182,6 +477,9 @@ static void async_reschedule(void* p_context)
     TICK_PIN(3);
     timestamp_t time_now = timer_now();
     remove_evt(p_context);
+#ifdef TIMER_SCH_TIMING_WHEEL
+    wheel_cursor_update(time_now);
+#endif
     add_evt(p_context);
 
     uint32_t was_masked;
@@ -205,7 +503,19 @@ static void timer_cb(timestamp_t timestamp)
 *****************************************************************************/
 uint32_t timer_sch_init(void)
 {
+#ifdef TIMER_SCH_TIMING_WHEEL
+    for (uint32_t level = 0; level < TIMER_WHEEL_LEVELS; ++level)
+    {
+        for (uint32_t slot = 0; slot < TIMER_WHEEL_SLOTS; ++slot)
+        {
+            m_scheduler.p_slots[level][slot] = NULL;
+        }
+        m_scheduler.occupied[level] = 0;
+    }
+    m_scheduler.cursor = TIMESTAMP_TO_TICK(timer_now());
+#else
     m_scheduler.p_head = NULL;
+#endif
     return NRF_SUCCESS;
 }
 
@@ -216,6 +526,9 @@ uint32_t timer_sch_schedule(timer_event_t* p_timer_evt)
         return NRF_ERROR_NULL;
     }
     p_timer_evt->p_next = NULL; /* sanitize linked list pointer */
+#ifdef TIMER_SCH_TIMING_WHEEL
+    p_timer_evt->pp_prev = NULL;
+#endif
     async_event_t evt;
     evt.type = EVENT_TYPE_GENERIC;
     evt.callback.generic.cb = async_schedule;
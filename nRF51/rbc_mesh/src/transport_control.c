@@ -40,8 +40,12 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "timer_scheduler.h"
 #include "rbc_mesh_common.h"
 #include "version_handler.h"
+#include "handle_storage.h"
+#include "ack_handler.h"
+#include "mesh_stats.h"
 #include "mesh_aci.h"
 #include "app_error.h"
+#include "toolchain.h"
 
 #if defined(WITH_ACK_MASTER) || defined (WITHOUT_ACK_MASTER)|| defined (WITH_ACK_SLAVE)
 
@@ -65,6 +69,16 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /* event push isn't present in the API header file. */
 extern uint32_t rbc_mesh_event_push(rbc_mesh_event_t* p_evt);
 
+#if (RBC_MESH_RX_FILTER_ENTRIES & (RBC_MESH_RX_FILTER_ENTRIES - 1))
+    #error "RBC_MESH_RX_FILTER_ENTRIES must be power of two"
+#endif
+
+#define RX_FILTER_INDEX(handle)     ((handle) & (RBC_MESH_RX_FILTER_ENTRIES - 1))
+
+#define ADV_CHANNEL_FIRST           (37)
+#define ADV_CHANNEL_LAST            (39)
+/** More than one channel in the map */
+#define CHANNEL_MAP_IS_HOPPING(map) (((map) & ((map) - 1)) != 0)
 /******************************************************************************
 * Local typedefs
 ******************************************************************************/
@@ -72,77 +86,47 @@ typedef struct
 {
     uint32_t access_address;
     uint8_t channel;
-    bool queue_saturation; /* flag indicating a full processing queue */
+    uint8_t rx_channel; /* channel currently listened on */
+    uint8_t rx_channel_map; /* advertising channels to hop between, or 0 to stay on the mesh channel */
+    tc_rx_backoff_state_t rx_backoff_state; /* receive overload controller state */
+    uint8_t rx_packets_queued; /* received packets in the event queue */
+    uint8_t rx_duty_count; /* packets processed since the last throttled search */
 } tc_state_t;
 
+/** Value version known to the handle storage, recognized in the radio callback. */
+typedef struct
+{
+    rbc_mesh_value_handle_t handle;     /** RBC_MESH_INVALID_HANDLE if the entry is empty */
+    uint16_t version;
+    uint32_t data_hash;                 /** hash of the value length and contents */
+    uint32_t rx_timestamp;              /** time of the first duplicate waiting to be counted */
+    uint8_t rx_count;                   /** duplicates waiting to be counted in the handle storage */
+} rx_filter_entry_t;
+
 /******************************************************************************
 * Static globals
 ******************************************************************************/
 static tc_state_t m_state;
 static rbc_mesh_packet_peek_cb_t mp_packet_peek_cb;
+static rx_filter_entry_t m_rx_filter[RBC_MESH_RX_FILTER_ENTRIES];
+static tc_rx_filter_stats_t m_rx_filter_stats;
+static tc_rx_backoff_status_t m_rx_backoff_status;
+static timer_event_t m_rx_hop_timer_evt;
 
-/* STATS */
-#ifdef PACKET_STATS
-
-
-#if defined (WITH_ACK_MASTER) 
-static struct
-{
-    uint32_t queue_drop;
-    uint32_t queue_ok;
-    uint32_t crc_fail;
-} m_packet_stats __attribute__((at(0x20003030)))  = {0};
-
-
-#elif defined(WITHOUT_ACK_MASTER) 
-static struct
-{
-    uint32_t queue_drop;
-    uint32_t queue_ok;
-    uint32_t crc_fail;
-} m_packet_stats __attribute__((at(0x2000273C))) = {0};
-
-
-
-#elif defined(WITH_ACK_SLAVE)
-static struct
-{
-    uint32_t queue_drop;
-    uint32_t queue_ok;
-    uint32_t crc_fail;
-} m_packet_stats __attribute__((at(0x20002750))) = {0};
-
-#elif defined(WITHOUT_ACK_SLAVE)
-static struct
-{
-    uint32_t queue_drop;
-    uint32_t queue_ok;
-    uint32_t crc_fail;
-} m_packet_stats __attribute__((at(0x20002738))) = {0};
-
-#else
-static struct
-{
-    uint32_t queue_drop;
-    uint32_t queue_ok;
-    uint32_t crc_fail;
-} m_packet_stats = {0};
-
-#endif
-
-#endif
 /******************************************************************************
 * Static functions
 ******************************************************************************/
 static void rx_cb(uint8_t* p_data, bool success, uint32_t crc, uint8_t rssi);
 static void tx_cb(uint8_t* p_data);
+static void rx_filter_count(void* p_context);
 
 static void order_search(void)
 {
     radio_event_t evt;
 
     evt.event_type = RADIO_EVENT_TYPE_RX_PREEMPTABLE;
-    evt.channel = m_state.channel;
+    evt.priority = RADIO_EVENT_PRIORITY_NORMAL;
+    evt.channel = m_state.rx_channel;
 
     if (!mesh_packet_acquire((mesh_packet_t**) &evt.packet_ptr))
     {
@@ -157,11 +141,126 @@ static void order_search(void)
 }
 
 
+/** FNV-1a hash of the value length and contents */
+static uint32_t rx_filter_hash(const mesh_adv_data_t* p_adv_data)
+{
+    uint32_t hash = 2166136261UL ^ p_adv_data->adv_data_length;
+    hash *= 16777619UL;
+    for (uint32_t i = 0; i < (uint32_t) p_adv_data->adv_data_length - MESH_PACKET_ADV_OVERHEAD; ++i)
+    {
+        hash ^= p_adv_data->data[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+/** Check whether the packet is a single value the device already has, and
+    count it if it is. Executed in STACK_LOW. */
+static bool rx_filter_duplicate(mesh_packet_t* p_packet)
+{
+    if (mp_packet_peek_cb != NULL)
+    {
+        return false;
+    }
+
+    mesh_adv_data_t* p_adv_data = mesh_packet_adv_data_get(p_packet);
+    if (p_adv_data == NULL ||
+        p_adv_data->handle > RBC_MESH_APP_MAX_HANDLE ||
+        p_adv_data->adv_data_length < MESH_PACKET_ADV_OVERHEAD ||
+        mesh_packet_adv_data_next(p_packet, p_adv_data) != NULL)
+    {
+        return false;
+    }
+
+    rx_filter_entry_t* p_entry = &m_rx_filter[RX_FILTER_INDEX(p_adv_data->handle)];
+    if (p_entry->handle != p_adv_data->handle ||
+        p_entry->version != p_adv_data->version ||
+        p_entry->data_hash != rx_filter_hash(p_adv_data))
+    {
+        m_rx_filter_stats.passed++;
+        return false;
+    }
+
+    if (p_entry->rx_count == 0)
+    {
+        /* count it in the trickle instance as soon as possible, so that it
+           lands in the interval it was received in. Duplicates received
+           before that are counted along with it. */
+        async_event_t evt;
+        evt.type = EVENT_TYPE_GENERIC;
+        evt.callback.generic.cb = rx_filter_count;
+        evt.callback.generic.p_context = p_entry;
+        if (event_handler_push(&evt) != NRF_SUCCESS)
+        {
+            /* the queue is full, the duplicate would have been dropped anyway */
+            m_rx_filter_stats.filtered++;
+            return true;
+        }
+        p_entry->rx_timestamp = timer_now();
+    }
+    if (p_entry->rx_count < UINT8_MAX)
+    {
+        p_entry->rx_count++;
+    }
+    m_rx_filter_stats.filtered++;
+    return true;
+}
+
+/** Count the duplicates recognized by the filter as consistent receptions
+    in the handle storage. Executed in APP_LOW. */
+static void rx_filter_count(void* p_context)
+{
+    rx_filter_entry_t* p_entry = (rx_filter_entry_t*) p_context;
+    rx_filter_entry_t entry;
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    entry = *p_entry;
+    p_entry->rx_count = 0;
+    _ENABLE_IRQS(was_masked);
+
+    if (entry.handle == RBC_MESH_INVALID_HANDLE || entry.rx_count == 0)
+    {
+        return;
+    }
+
+    /* the stored version may have changed since the entry was added */
+    handle_info_t info;
+    if (handle_storage_info_get(entry.handle, &info) != NRF_SUCCESS ||
+        info.version != entry.version)
+    {
+        _DISABLE_IRQS(was_masked);
+        if (p_entry->handle == entry.handle &&
+            p_entry->version == entry.version)
+        {
+            p_entry->handle = RBC_MESH_INVALID_HANDLE;
+        }
+        _ENABLE_IRQS(was_masked);
+        mesh_packet_ref_count_dec(info.p_packet);
+        return;
+    }
+    mesh_packet_ref_count_dec(info.p_packet);
+
+    for (uint32_t i = 0; i < entry.rx_count; ++i)
+    {
+        handle_storage_rx_consistent(entry.handle, entry.rx_timestamp);
+    }
+    /* the sender may have missed our acknowledgement */
+    ack_handler_value_rx(entry.handle, entry.version);
+}
+
 /* immediate radio callback, executed in STACK_LOW */
 static void rx_cb(uint8_t* p_data, bool success, uint32_t crc, uint8_t rssi)
 {
     if (success && ((mesh_packet_t*) p_data)->header.length <= MESH_PACKET_BLE_OVERHEAD + BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH)
     {
+        mesh_stats_inc(RBC_MESH_STAT_RX_OK);
+        if (rx_filter_duplicate((mesh_packet_t*) p_data))
+        {
+            /* already known, no need to queue it for processing */
+            mesh_packet_ref_count_dec((mesh_packet_t*) p_data);
+            return;
+        }
+
         async_event_t evt;
         evt.type = EVENT_TYPE_PACKET;
         evt.callback.packet.payload = p_data;
@@ -173,23 +272,28 @@ static void rx_cb(uint8_t* p_data, bool success, uint32_t crc, uint8_t rssi)
         if (event_handler_push(&evt) != NRF_SUCCESS)
         {
             mesh_packet_ref_count_dec((mesh_packet_t*) p_data);
-            m_state.queue_saturation = true;
-#ifdef PACKET_STATS
-            m_packet_stats.queue_drop++;
-#endif
+            if (m_state.rx_backoff_state != TC_RX_BACKOFF_STATE_SUSPENDED)
+            {
+                m_state.rx_backoff_state = TC_RX_BACKOFF_STATE_SUSPENDED;
+                m_rx_backoff_status.suspend_count++;
+            }
+            m_rx_backoff_status.queue_drops++;
         }
         else
         {
-#ifdef PACKET_STATS
-            m_packet_stats.queue_ok++;
-#endif
+            m_state.rx_packets_queued++;
+            if (m_state.rx_backoff_state == TC_RX_BACKOFF_STATE_NORMAL &&
+                m_state.rx_packets_queued >= RBC_MESH_RX_BACKOFF_HIGH_WATERMARK)
+            {
+                m_state.rx_backoff_state = TC_RX_BACKOFF_STATE_THROTTLED;
+                m_state.rx_duty_count = 0;
+                m_rx_backoff_status.throttle_count++;
+            }
         }
     }
     else if (crc < 0x1000000) /* don't want to trigger on artifical crc values */
     {
-#ifdef PACKET_STATS
-        m_packet_stats.crc_fail++;
-#endif
+        mesh_stats_inc(RBC_MESH_STAT_RX_CRC_FAIL);
     }
 
     /* no longer needed in this context */
@@ -206,22 +310,32 @@ static void async_tx_cb(void* p_context)
 {
     mesh_packet_t* p_packet = (mesh_packet_t*) p_context;
     rbc_mesh_event_t tx_event;
-    mesh_adv_data_t* p_adv_data = mesh_packet_adv_data_get(p_packet);
-    bool doing_tx_event = false;
-    if (p_adv_data != NULL &&
-        vh_tx_event_flag_get(p_adv_data->handle, &doing_tx_event) == NRF_SUCCESS
-        && doing_tx_event)
-    {
-        tx_event.type = RBC_MESH_EVENT_TYPE_TX;
-        tx_event.params.tx.value_handle  = p_adv_data->handle;
-        tx_event.params.tx.p_data        = p_adv_data->data;
-        tx_event.params.tx.data_len      = p_adv_data->adv_data_length - MESH_PACKET_ADV_OVERHEAD;
-        tx_event.params.tx.timestamp_us  = timer_now();
-
-        rbc_mesh_event_push(&tx_event); /* will take care of the reference counting itself. */
+    /* the packet may carry several values, notify for each of them */
+    for (mesh_adv_data_t* p_adv_data = mesh_packet_adv_data_get(p_packet);
+         p_adv_data != NULL;
+         p_adv_data = mesh_packet_adv_data_next(p_packet, p_adv_data))
+    {
+        bool doing_tx_event = false;
+        if (vh_tx_event_flag_get(p_adv_data->handle, &doing_tx_event) == NRF_SUCCESS
+            && doing_tx_event)
+        {
+            tx_event.type = RBC_MESH_EVENT_TYPE_TX;
+            tx_event.params.tx.value_handle  = p_adv_data->handle;
+            tx_event.params.tx.p_data        = p_adv_data->data;
+            tx_event.params.tx.data_len      = p_adv_data->adv_data_length - MESH_PACKET_ADV_OVERHEAD;
+            if (vh_value_is_large(p_adv_data->handle))
+            {
+                /* only a segment of the value was sent */
+                tx_event.params.tx.p_data    = NULL;
+                tx_event.params.tx.data_len  = 0;
+            }
+            tx_event.params.tx.timestamp_us  = timer_now();
+
+            rbc_mesh_event_push(&tx_event); /* will take care of the reference counting itself. */
 #ifdef RBC_MESH_SERIAL
-        mesh_aci_rbc_event_handler(&tx_event);
+            mesh_aci_rbc_event_handler(&tx_event);
 #endif
+        }
     }
     mesh_packet_ref_count_dec(p_packet); /* event-handler reference popped. */
 }
@@ -229,6 +343,7 @@ static void async_tx_cb(void* p_context)
 /* radio callback, executed in STACK_LOW */
 static void tx_cb(uint8_t* p_data)
 {
+    mesh_stats_inc(RBC_MESH_STAT_TX);
     /* have to defer tx-event handling to async context to avoid race
        conditions in the handle_storage */
     async_event_t tx_cb_evt =
@@ -249,12 +364,88 @@ static void tx_cb(uint8_t* p_data)
 static void radio_idle_callback(void)
 {
     /* If the processor is unable to keep up, we should back down, and give it time */
-    if (!m_state.queue_saturation)
+    if (m_state.rx_backoff_state != TC_RX_BACKOFF_STATE_NORMAL &&
+        m_state.rx_packets_queued == 0)
+    {
+        /* nothing left to process, the packet handler won't resume */
+        m_state.rx_backoff_state = TC_RX_BACKOFF_STATE_NORMAL;
+    }
+
+    if (m_state.rx_backoff_state == TC_RX_BACKOFF_STATE_NORMAL)
+    {
+        order_search();
+    }
+}
+
+/** Account for a processed packet, and resume reception if the queue has
+    drained enough. Executed in APP_LOW. */
+static void rx_backoff_packet_done(uint32_t rx_timestamp, uint32_t processing_start)
+{
+    const uint32_t time_now = timer_now();
+    m_rx_backoff_status.avg_processing_time_us =
+        (m_rx_backoff_status.avg_processing_time_us * 7 + (time_now - processing_start)) / 8;
+    m_rx_backoff_status.avg_queue_time_us =
+        (m_rx_backoff_status.avg_queue_time_us * 7 + (processing_start - rx_timestamp)) / 8;
+
+    bool do_search = false;
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    if (m_state.rx_packets_queued > 0)
+    {
+        m_state.rx_packets_queued--;
+    }
+    if (m_state.rx_backoff_state != TC_RX_BACKOFF_STATE_NORMAL)
+    {
+        if (m_state.rx_packets_queued <= RBC_MESH_RX_BACKOFF_LOW_WATERMARK)
+        {
+            m_state.rx_backoff_state = TC_RX_BACKOFF_STATE_NORMAL;
+            do_search = true;
+        }
+        else if (m_state.rx_backoff_state == TC_RX_BACKOFF_STATE_THROTTLED &&
+                 ++m_state.rx_duty_count >= RBC_MESH_RX_BACKOFF_DUTY_CYCLE)
+        {
+            m_state.rx_duty_count = 0;
+            do_search = true;
+        }
+    }
+    _ENABLE_IRQS(was_masked);
+
+    if (do_search)
+    {
+        order_search();
+    }
+}
+
+/** Move reception to the next channel in the map. Executed in APP_LOW. */
+static void rx_hop_timeout(timestamp_t timestamp, void* p_context)
+{
+    if (!CHANNEL_MAP_IS_HOPPING(m_state.rx_channel_map))
+    {
+        return; /* the map changed before the timer could be aborted */
+    }
+
+    uint8_t channel = m_state.rx_channel;
+    do
+    {
+        channel = (channel >= ADV_CHANNEL_LAST) ? ADV_CHANNEL_FIRST : channel + 1;
+    } while (!(m_state.rx_channel_map & (1 << (channel - ADV_CHANNEL_FIRST))));
+    m_state.rx_channel = channel;
+
+    /* preempt the search on the old channel. If the radio is busy, the new
+       search will purge the old one when it reaches the head of the queue. */
+    if (m_state.rx_backoff_state == TC_RX_BACKOFF_STATE_NORMAL)
+    {
         order_search();
+    }
 }
 
 static void mesh_framework_packet_handle(mesh_adv_data_t* p_adv_data, uint32_t timestamp)
 {
+    if (p_adv_data->handle == MESH_ACK_HANDLE)
+    {
+        ack_handler_rx(p_adv_data, timestamp);
+        return;
+    }
 #ifdef MESH_DFU
     mesh_dfu_adv_data_t* p_dfu = (mesh_dfu_adv_data_t*) p_adv_data;
     /* Tell the shared BL about the packet */
@@ -262,6 +453,7 @@ static void mesh_framework_packet_handle(mesh_adv_data_t* p_adv_data, uint32_t t
     rx_cmd.type = BL_CMD_TYPE_RX;
     rx_cmd.params.rx.length = p_dfu->adv_data_length - DFU_PACKET_ADV_OVERHEAD;
     rx_cmd.params.rx.p_dfu_packet = &p_dfu->dfu_packet;
+    rx_cmd.params.rx.from_serial = false;
     dfu_cmd_send(&rx_cmd);
 #endif
 }
@@ -269,9 +461,17 @@ static void mesh_framework_packet_handle(mesh_adv_data_t* p_adv_data, uint32_t t
 /******************************************************************************
 * Interface functions
 ******************************************************************************/
-void tc_init(uint32_t access_address, uint8_t channel)
+void tc_init(uint32_t access_address, uint8_t channel, rbc_mesh_radio_mode_t radio_mode)
 {
     mp_packet_peek_cb = NULL;
+    for (uint32_t i = 0; i < RBC_MESH_RX_FILTER_ENTRIES; ++i)
+    {
+        m_rx_filter[i].handle = RBC_MESH_INVALID_HANDLE;
+    }
+    memset(&m_rx_filter_stats, 0, sizeof(m_rx_filter_stats));
+    memset(&m_rx_backoff_status, 0, sizeof(m_rx_backoff_status));
+    m_state.rx_channel_map = 0;
+    radio_mode_set(radio_mode);
     tc_radio_params_set(access_address, channel);
 }
 
@@ -281,11 +481,60 @@ void tc_radio_params_set(uint32_t access_address, uint8_t channel)
     {
         m_state.access_address = access_address;
         m_state.channel = channel;
+        if (m_state.rx_channel_map == 0)
+        {
+            m_state.rx_channel = channel;
+        }
         radio_alt_aa_set(access_address);
         timeslot_restart();
     }
 }
 
+void tc_rx_channel_map_set(uint8_t channel_map, uint32_t dwell_time_us)
+{
+    APP_ERROR_CHECK_BOOL((channel_map & ~RBC_MESH_ADV_CHANNEL_MAP_ALL) == 0);
+
+    event_handler_critical_section_begin();
+    const bool was_hopping = CHANNEL_MAP_IS_HOPPING(m_state.rx_channel_map);
+    const bool is_hopping = CHANNEL_MAP_IS_HOPPING(channel_map);
+
+    m_state.rx_channel_map = channel_map;
+    if (channel_map == 0)
+    {
+        m_state.rx_channel = m_state.channel;
+    }
+    else
+    {
+        m_state.rx_channel = ADV_CHANNEL_FIRST;
+        while (!(channel_map & (1 << (m_state.rx_channel - ADV_CHANNEL_FIRST))))
+        {
+            m_state.rx_channel++;
+        }
+    }
+
+    const timestamp_t time_now = timer_now();
+    if (is_hopping)
+    {
+        m_rx_hop_timer_evt.interval = dwell_time_us;
+        if (was_hopping)
+        {
+            APP_ERROR_CHECK(timer_sch_reschedule(&m_rx_hop_timer_evt, time_now + dwell_time_us));
+        }
+        else
+        {
+            m_rx_hop_timer_evt.cb = rx_hop_timeout;
+            m_rx_hop_timer_evt.p_context = NULL;
+            m_rx_hop_timer_evt.timestamp = time_now + dwell_time_us;
+            APP_ERROR_CHECK(timer_sch_schedule(&m_rx_hop_timer_evt));
+        }
+    }
+    else if (was_hopping)
+    {
+        APP_ERROR_CHECK(timer_sch_abort(&m_rx_hop_timer_evt));
+    }
+    event_handler_critical_section_end();
+}
+
 void tc_on_ts_begin(void)
 {
     radio_init(radio_idle_callback, rx_cb, tx_cb);
@@ -308,6 +557,7 @@ uint32_t tc_tx(mesh_packet_t* p_packet, const tc_tx_config_t* p_config)
     event.channel = p_config->first_channel;
     event.event_type = RADIO_EVENT_TYPE_TX;
     event.tx_power = (uint8_t) p_config->tx_power;
+    event.priority = p_config->priority;
 
     /* send packet on each channel in the channel map */
     for (uint32_t i = 0; i < 32; ++i)
@@ -337,6 +587,7 @@ void tc_packet_handler(uint8_t* data, uint32_t crc, uint32_t timestamp, uint8_t
 {
     APP_ERROR_CHECK_BOOL(data != NULL);
     SET_PIN(PIN_RX);
+    const uint32_t processing_start = timer_now();
     mesh_packet_t* p_packet = (mesh_packet_t*) data;
 
     if (p_packet->header.length > BLE_GAP_ADDR_LEN + BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH)
@@ -344,6 +595,7 @@ void tc_packet_handler(uint8_t* data, uint32_t crc, uint32_t timestamp, uint8_t
         /* invalid packet, ignore */
         CLEAR_PIN(PIN_RX);
         mesh_packet_ref_count_dec(p_packet); /* from rx_cb */
+        rx_backoff_packet_done(timestamp, processing_start);
 
         return;
     }
@@ -369,27 +621,46 @@ void tc_packet_handler(uint8_t* data, uint32_t crc, uint32_t timestamp, uint8_t
 
     mesh_adv_data_t* p_mesh_adv_data = mesh_packet_adv_data_get(p_packet);
 
-    if (p_mesh_adv_data != NULL)
+    /* the version handler stores the packet it gets as the value, so values
+       packed together in one advertisement must get a packet each. */
+    const bool is_packed = (mesh_packet_adv_data_next(p_packet, p_mesh_adv_data) != NULL);
+
+    while (p_mesh_adv_data != NULL)
     {
         /* filter mesh packets on handle range */
-        if (p_mesh_adv_data->handle <= RBC_MESH_APP_MAX_HANDLE)
+        if (p_mesh_adv_data->handle > RBC_MESH_APP_MAX_HANDLE)
+        {
+            mesh_framework_packet_handle(p_mesh_adv_data, timestamp);
+        }
+        else if (p_mesh_adv_data->adv_data_length < MESH_PACKET_ADV_OVERHEAD)
+        {
+            /* invalid value, ignore */
+        }
+        else if (!is_packed)
         {
             vh_rx(p_packet, timestamp, rssi);
         }
         else
         {
-            mesh_framework_packet_handle(p_mesh_adv_data, timestamp);
+            mesh_packet_t* p_value_packet = NULL;
+            if (!mesh_packet_acquire(&p_value_packet))
+            {
+                break;
+            }
+            if (mesh_packet_adv_data_extract(p_value_packet, p_packet, p_mesh_adv_data) == NRF_SUCCESS)
+            {
+                vh_rx(p_value_packet, timestamp, rssi);
+            }
+            mesh_packet_ref_count_dec(p_value_packet);
         }
+
+        p_mesh_adv_data = mesh_packet_adv_data_next(p_packet, p_mesh_adv_data);
     }
 
     /* this packet is no longer needed in this context */
     mesh_packet_ref_count_dec(p_packet); /* from rx_cb */
 
-    if (m_state.queue_saturation)
-    {
-        order_search();
-        m_state.queue_saturation = false;
-    }
+    rx_backoff_packet_done(timestamp, processing_start);
 
     CLEAR_PIN(PIN_RX);
 }
@@ -398,3 +669,45 @@ void tc_packet_peek_cb_set(rbc_mesh_packet_peek_cb_t packet_peek_cb)
 {
     mp_packet_peek_cb = packet_peek_cb;
 }
+
+void tc_rx_filter_add(mesh_adv_data_t* p_adv_data)
+{
+    rx_filter_entry_t entry;
+    entry.handle = p_adv_data->handle;
+    entry.version = p_adv_data->version;
+    entry.data_hash = rx_filter_hash(p_adv_data);
+    entry.rx_timestamp = 0;
+    entry.rx_count = 0;
+
+    rx_filter_entry_t* p_entry = &m_rx_filter[RX_FILTER_INDEX(p_adv_data->handle)];
+
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    if (p_entry->handle == entry.handle &&
+        p_entry->version == entry.version &&
+        p_entry->data_hash == entry.data_hash)
+    {
+        entry.rx_timestamp = p_entry->rx_timestamp;
+        entry.rx_count = p_entry->rx_count;
+    }
+    *p_entry = entry;
+    _ENABLE_IRQS(was_masked);
+}
+
+void tc_rx_filter_stats_get(tc_rx_filter_stats_t* p_stats)
+{
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    *p_stats = m_rx_filter_stats;
+    _ENABLE_IRQS(was_masked);
+}
+
+void tc_rx_backoff_status_get(tc_rx_backoff_status_t* p_status)
+{
+    uint32_t was_masked;
+    _DISABLE_IRQS(was_masked);
+    *p_status = m_rx_backoff_status;
+    p_status->state = m_state.rx_backoff_state;
+    p_status->packets_queued = m_state.rx_packets_queued;
+    _ENABLE_IRQS(was_masked);
+}
@@ -33,6 +33,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "app_error.h"
 #include "rand.h"
 #include "timer.h"
+#include "mesh_stats.h"
 
 #include "nrf_soc.h"
 #ifdef NRF51
@@ -43,6 +44,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string.h>
 
 #define TIME_MARGIN (1000)
+#define TRICKLE_INTERVAL_LIMIT  (1UL << 30) /* upper bound on instance specific I_max, in us */
 /*****************************************************************************
 * Static Globals
 *****************************************************************************/
@@ -56,6 +58,39 @@ static prng_t g_rand;
 /*****************************************************************************
 * Static Functions
 *****************************************************************************/
+static uint32_t i_min_get(trickle_t* trickle)
+{
+    if (trickle->params.i_min_ms == 0)
+    {
+        return g_i_min;
+    }
+    return trickle->params.i_min_ms * 1000UL;
+}
+
+static uint32_t i_max_get(trickle_t* trickle)
+{
+    uint32_t i_min = i_min_get(trickle);
+    if (trickle->params.i_max == 0)
+    {
+        return g_i_max * i_min;
+    }
+    /* saturate to stay within the range of TIMER_OLDER_THAN */
+    if (i_min > (TRICKLE_INTERVAL_LIMIT >> trickle->params.i_max))
+    {
+        return TRICKLE_INTERVAL_LIMIT;
+    }
+    return (i_min << trickle->params.i_max);
+}
+
+static uint8_t k_get(trickle_t* trickle)
+{
+    if (trickle->params.k == 0)
+    {
+        return g_k;
+    }
+    return trickle->params.k;
+}
+
 /**
 * @brief Do calculations for beginning of a trickle interval. Is called from
 *   trickle_step function.
@@ -89,10 +124,11 @@ static void check_interval(trickle_t* trickle, uint32_t time_now)
 {
     if (!TIMER_OLDER_THAN(time_now, trickle->i) && trickle_is_enabled(trickle))
     {
-        if (trickle->i_relative < g_i_max * g_i_min)
+        uint32_t i_max = i_max_get(trickle);
+        if (trickle->i_relative <= (i_max >> 1))
             trickle->i_relative <<= 1;
         else
-            trickle->i_relative = g_i_max * g_i_min;
+            trickle->i_relative = i_max;
         /* we've started a new interval since we last touched this trickle */
         trickle->c = 0;
         trickle->i = trickle->i_relative + time_now;
@@ -111,6 +147,11 @@ void trickle_setup(uint32_t i_min, uint32_t i_max, uint8_t k)
     rand_prng_seed(&g_rand);
 }
 
+void trickle_params_set(trickle_t* trickle, const trickle_params_t* p_params)
+{
+    trickle->params = *p_params;
+}
+
 void trickle_rx_consistent(trickle_t* trickle, uint32_t time_now)
 {
     if (trickle_is_enabled(trickle))
@@ -127,7 +168,7 @@ void trickle_rx_consistent(trickle_t* trickle, uint32_t time_now)
 void trickle_rx_inconsistent(trickle_t* trickle, uint32_t time_now)
 {
     TICK_PIN(PIN_INCONSISTENT);
-    if (trickle->i_relative > g_i_min)
+    if (trickle->i_relative > i_min_get(trickle))
     {
         trickle_timer_reset(trickle, time_now);
     }
@@ -136,7 +177,7 @@ void trickle_rx_inconsistent(trickle_t* trickle, uint32_t time_now)
 void trickle_timer_reset(trickle_t* trickle, uint32_t time_now)
 {
     trickle->i = time_now;
-    trickle->i_relative = g_i_min;
+    trickle->i_relative = i_min_get(trickle);
 
     refresh_t(trickle, time_now);
     trickle_interval_begin(trickle);
@@ -159,8 +200,10 @@ void trickle_tx_timeout(trickle_t* trickle, bool* out_do_tx, uint32_t time_now)
     }
     else
     {
-        *out_do_tx = (trickle->c < g_k);
+        /* c only counts RXs in the current interval */
         check_interval(trickle, time_now);
+        *out_do_tx = (trickle->c < k_get(trickle));
+        mesh_stats_inc(*out_do_tx ? RBC_MESH_STAT_TRICKLE_TX : RBC_MESH_STAT_TRICKLE_SUPPRESSED);
         if (!(*out_do_tx))
         {
             /* will never get a call to tx_register, order next t manually */
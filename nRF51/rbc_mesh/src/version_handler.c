@@ -30,6 +30,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "version_handler.h"
 
+#include "ack_handler.h"
 #include "handle_storage.h"
 #include "transport_control.h"
 #include "timer.h"
@@ -53,16 +54,37 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define TIMESLOT_STARTUP_DELAY_US       (100)
 
+#if (MESH_SEGMENT_COUNT_MAX > 32)
+    #error "Large values can not be split into more than 32 segments"
+#endif
+
 /* event push isn't present in the API header file. */
 extern uint32_t rbc_mesh_event_push(rbc_mesh_event_t* p_evt);
 
 
+/******************************************************************************
+* Static typedefs
+******************************************************************************/
+/** Contents and reassembly state of a large value */
+typedef struct
+{
+    uint16_t version;           /**< Version of the value in the data buffer. */
+    uint16_t length;            /**< Length of the value, only valid when no segments are missing. */
+    uint32_t segments_missing;  /**< Bitfield of segments that haven't been received yet. */
+    uint8_t segment_count;      /**< Number of segments in the value, 0 if the buffer holds no valid value. */
+    uint8_t tx_segment;         /**< Next segment to transmit. */
+    uint8_t data[RBC_MESH_LARGE_VALUE_MAX_LEN];
+} large_value_t;
+
 /******************************************************************************
 * Static globals
 ******************************************************************************/
 static bool             m_is_initialized = false;
 static timer_event_t    m_tx_timer_evt;
 static tc_tx_config_t   m_tx_config;
+#if (RBC_MESH_LARGE_VALUE_COUNT > 0)
+static large_value_t    m_large_values[RBC_MESH_LARGE_VALUE_COUNT];
+#endif
 /******************************************************************************
 * Static functions
 ******************************************************************************/
@@ -118,6 +140,298 @@ static bool payload_has_conflict(mesh_adv_data_t* p_old_adv, mesh_adv_data_t* p_
 }
 
 
+static large_value_t* large_value_get(rbc_mesh_value_handle_t handle)
+{
+#if (RBC_MESH_LARGE_VALUE_COUNT > 0)
+    if (handle >= RBC_MESH_LARGE_VALUE_HANDLE_BASE &&
+        handle < RBC_MESH_LARGE_VALUE_HANDLE_BASE + RBC_MESH_LARGE_VALUE_COUNT)
+    {
+        return &m_large_values[handle - RBC_MESH_LARGE_VALUE_HANDLE_BASE];
+    }
+#endif
+    return NULL;
+}
+
+/** Build a packet carrying the given segment of a large value. */
+static uint32_t large_value_segment_build(mesh_packet_t** pp_packet,
+        rbc_mesh_value_handle_t handle,
+        const large_value_t* p_value,
+        uint8_t index,
+        uint16_t version)
+{
+    mesh_segment_t segment;
+    const uint32_t offset = index * MESH_SEGMENT_DATA_MAX_LEN;
+    uint32_t length = p_value->length - offset;
+    if (length > MESH_SEGMENT_DATA_MAX_LEN)
+    {
+        length = MESH_SEGMENT_DATA_MAX_LEN;
+    }
+    segment.index = index;
+    segment.count = p_value->segment_count;
+    memcpy(segment.data, &p_value->data[offset], length);
+
+    if (!mesh_packet_acquire(pp_packet))
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    uint32_t error_code = mesh_packet_build(*pp_packet,
+            handle,
+            version,
+            (uint8_t*) &segment,
+            MESH_SEGMENT_OVERHEAD + length);
+    if (error_code != NRF_SUCCESS)
+    {
+        mesh_packet_ref_count_dec(*pp_packet);
+    }
+    return error_code;
+}
+
+/** Split the given data into segments, and start broadcasting it as a new version. */
+static uint32_t large_value_local_update(rbc_mesh_value_handle_t handle,
+        large_value_t* p_value,
+        uint8_t* data,
+        uint16_t length)
+{
+    if (length > RBC_MESH_LARGE_VALUE_MAX_LEN)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+    if (data == NULL && length > 0)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    event_handler_critical_section_begin();
+
+    if (length > 0)
+    {
+        memcpy(p_value->data, data, length);
+    }
+    p_value->length = length;
+    p_value->segment_count = (length == 0) ? 1 : (length + MESH_SEGMENT_DATA_MAX_LEN - 1) / MESH_SEGMENT_DATA_MAX_LEN;
+    p_value->segments_missing = 0;
+    p_value->tx_segment = 1 % p_value->segment_count;
+
+    mesh_packet_t* p_packet = NULL;
+    uint32_t error_code = large_value_segment_build(&p_packet, handle, p_value, 0,
+            1); /* Will be overwritten by the handle storage */
+    if (error_code == NRF_SUCCESS)
+    {
+        error_code = handle_storage_local_packet_set(p_packet);
+        if (error_code == NRF_SUCCESS)
+        {
+            p_value->version = mesh_packet_adv_data_get(p_packet)->version;
+        }
+        mesh_packet_ref_count_dec(p_packet);
+    }
+
+    if (error_code != NRF_SUCCESS)
+    {
+        /* the buffer no longer matches the segments in the handle storage */
+        p_value->segment_count = 0;
+    }
+
+    event_handler_critical_section_end();
+
+    if (error_code == NRF_SUCCESS)
+    {
+        vh_order_update(timer_now());
+    }
+    return error_code;
+}
+
+/** Let the next segment of a large value take the place of the one that was just transmitted. */
+static void large_value_tx_advance(rbc_mesh_value_handle_t handle)
+{
+    large_value_t* p_value = large_value_get(handle);
+    if (p_value == NULL ||
+        p_value->segment_count <= 1 ||
+        p_value->segments_missing != 0)
+    {
+        /* single segment, or the buffer is busy with a new version */
+        return;
+    }
+
+    handle_info_t info;
+    if (handle_storage_info_get(handle, &info) != NRF_SUCCESS)
+    {
+        return;
+    }
+    mesh_packet_ref_count_dec(info.p_packet);
+
+    if (info.version != p_value->version)
+    {
+        return;
+    }
+
+    mesh_packet_t* p_packet = NULL;
+    if (large_value_segment_build(&p_packet, handle, p_value, p_value->tx_segment, info.version) == NRF_SUCCESS)
+    {
+        if (handle_storage_packet_set(handle, p_packet) == NRF_SUCCESS)
+        {
+            p_value->tx_segment = (p_value->tx_segment + 1) % p_value->segment_count;
+        }
+        mesh_packet_ref_count_dec(p_packet);
+    }
+}
+
+/** Receive a segment of a large value. The value is stored and reported once all segments of a new version are in. */
+static uint32_t large_value_rx(large_value_t* p_value,
+        mesh_packet_t* p_packet,
+        mesh_adv_data_t* p_adv_data,
+        uint32_t timestamp,
+        uint8_t rssi)
+{
+    mesh_segment_t* p_segment = (mesh_segment_t*) p_adv_data->data;
+    uint32_t segment_length = p_adv_data->adv_data_length - MESH_PACKET_ADV_OVERHEAD;
+    if (segment_length < MESH_SEGMENT_OVERHEAD)
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+    segment_length -= MESH_SEGMENT_OVERHEAD;
+
+    if (p_segment->count == 0 ||
+        p_segment->count > MESH_SEGMENT_COUNT_MAX ||
+        p_segment->index >= p_segment->count ||
+        (p_segment->index + 1 < p_segment->count && segment_length != MESH_SEGMENT_DATA_MAX_LEN) ||
+        p_segment->index * MESH_SEGMENT_DATA_MAX_LEN + segment_length > RBC_MESH_LARGE_VALUE_MAX_LEN)
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    handle_info_t info;
+    const bool is_new = (handle_storage_info_get(p_adv_data->handle, &info) == NRF_ERROR_NOT_FOUND);
+    const int16_t delta = version_delta(info.version, p_adv_data->version);
+
+    /* prepare app event, the data has to be read with vh_value_get() */
+    rbc_mesh_event_t evt;
+    evt.params.rx.version_delta = delta;
+    evt.params.rx.ble_adv_addr.addr_type = p_packet->header.addr_type;
+    memcpy(evt.params.rx.ble_adv_addr.addr, p_packet->addr, BLE_GAP_ADDR_LEN);
+    evt.params.rx.rssi = -((int8_t) rssi);
+    evt.params.rx.p_data = NULL;
+    evt.params.rx.data_len = p_value->length;
+    evt.params.rx.value_handle = p_adv_data->handle;
+    evt.params.rx.timestamp_us = timestamp;
+
+    if (!is_new && delta < 0)
+    {
+        handle_storage_rx_inconsistent(p_adv_data->handle, timestamp);
+        vh_order_update(timestamp);
+        mesh_packet_ref_count_dec(info.p_packet);
+        return NRF_SUCCESS;
+    }
+
+    if (!is_new && delta == 0)
+    {
+        if (p_value->segment_count == p_segment->count &&
+            p_value->segments_missing == 0 &&
+            p_value->version == p_adv_data->version &&
+            memcmp(&p_value->data[p_segment->index * MESH_SEGMENT_DATA_MAX_LEN],
+                p_segment->data,
+                segment_length) != 0)
+        {
+            evt.type = RBC_MESH_EVENT_TYPE_CONFLICTING_VAL;
+            rbc_mesh_event_push(&evt); /* not really important whether this succeeds. */
+
+#ifdef RBC_MESH_SERIAL
+            mesh_aci_rbc_event_handler(&evt);
+#endif
+        }
+        else if (p_value->segments_missing == 0 &&
+                 p_value->version == p_adv_data->version)
+        {
+            /* the sender may have missed our acknowledgement */
+            ack_handler_value_rx(p_adv_data->handle, p_adv_data->version);
+        }
+        handle_storage_rx_consistent(p_adv_data->handle, timestamp);
+        mesh_packet_ref_count_dec(info.p_packet);
+        return NRF_SUCCESS;
+    }
+
+    /* newer version, collect the segment */
+    if (p_value->version != p_adv_data->version || p_value->segment_count == 0)
+    {
+        if (p_value->segments_missing != 0 &&
+            version_delta(p_value->version, p_adv_data->version) < 0)
+        {
+            /* already collecting an even newer version */
+            mesh_packet_ref_count_dec(info.p_packet);
+            return NRF_SUCCESS;
+        }
+
+        p_value->version = p_adv_data->version;
+        p_value->segment_count = p_segment->count;
+        p_value->segments_missing = (p_segment->count == 32) ? UINT32_MAX : ((1UL << p_segment->count) - 1);
+        p_value->length = 0;
+        if (!is_new)
+        {
+            /* make the neighbors aware that we're behind */
+            handle_storage_rx_inconsistent(p_adv_data->handle, timestamp);
+            vh_order_update(timestamp);
+        }
+    }
+
+    if (p_segment->count != p_value->segment_count)
+    {
+        mesh_packet_ref_count_dec(info.p_packet);
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    if (p_value->segments_missing & (1UL << p_segment->index))
+    {
+        memcpy(&p_value->data[p_segment->index * MESH_SEGMENT_DATA_MAX_LEN], p_segment->data, segment_length);
+        p_value->segments_missing &= ~(1UL << p_segment->index);
+        if (p_segment->index + 1 == p_segment->count)
+        {
+            p_value->length = p_segment->index * MESH_SEGMENT_DATA_MAX_LEN + segment_length;
+        }
+    }
+
+    if (p_value->segments_missing != 0)
+    {
+        mesh_packet_ref_count_dec(info.p_packet);
+        return NRF_SUCCESS;
+    }
+
+    /* all segments are in, store the value like any other update */
+    evt.type = (is_new ? RBC_MESH_EVENT_TYPE_NEW_VAL : RBC_MESH_EVENT_TYPE_UPDATE_VAL);
+    evt.params.rx.data_len = p_value->length;
+
+    /* First allocate an element in the storage to ensure that we're not out of memory. */
+    uint32_t error_code = handle_storage_info_set(p_adv_data->handle, &info);
+    if (error_code != NRF_SUCCESS)
+    {
+        mesh_packet_ref_count_dec(info.p_packet);
+        return error_code;
+    }
+
+    mesh_packet_take_ownership(p_packet);
+    handle_info_t new_info =
+    {
+        .p_packet = p_packet,
+        .version = p_adv_data->version
+    };
+
+    if (rbc_mesh_event_push(&evt) == NRF_SUCCESS)
+    {
+        /* assert if this doesn't work. The empty allocation above should have prevented any errors this time. */
+        APP_ERROR_CHECK(handle_storage_info_set(p_adv_data->handle, &new_info));
+        p_value->tx_segment = (p_segment->index + 1) % p_segment->count;
+        ack_handler_value_rx(p_adv_data->handle, p_adv_data->version);
+    }
+
+    vh_order_update(timestamp);
+
+#ifdef RBC_MESH_SERIAL
+    mesh_aci_rbc_event_handler(&evt);
+#endif
+
+    mesh_packet_ref_count_dec(info.p_packet);
+    return NRF_SUCCESS;
+}
+
 static void transmit_all_instances(uint32_t timestamp, void* p_context);
 
 static void order_next_transmission(uint32_t time_now)
@@ -141,29 +455,121 @@ static void order_next_transmission(uint32_t time_now)
     }
 }
 
+/**
+* Pack the values of the later packets in the list into the same advertisement
+* as the packet at the given index, as long as they fit. The packets that got
+* packed are released and removed from the list, and the packet at the index is
+* replaced by the packed packet.
+*/
+static void tx_packets_pack(mesh_packet_t** pp_tx_packets, uint32_t index, uint32_t count)
+{
+    mesh_adv_data_t* p_first_adv = mesh_packet_adv_data_get(pp_tx_packets[index]);
+    if (p_first_adv == NULL)
+    {
+        return;
+    }
+
+    mesh_packet_t* p_packed = NULL;
+    uint32_t space_left = BLE_ADV_PACKET_PAYLOAD_MAX_LENGTH - (p_first_adv->adv_data_length + 1);
+    for (uint32_t i = index + 1; i < count; ++i)
+    {
+        mesh_adv_data_t* p_adv = mesh_packet_adv_data_get(pp_tx_packets[i]);
+        if (p_adv == NULL || (uint32_t) p_adv->adv_data_length + 1 > space_left)
+        {
+            continue;
+        }
+
+        if (p_packed == NULL)
+        {
+            /* only take a packet from the pool once we know there's something to pack */
+            if (!mesh_packet_acquire(&p_packed))
+            {
+                return;
+            }
+            mesh_packet_build_empty(p_packed);
+            APP_ERROR_CHECK(mesh_packet_adv_data_append(p_packed, p_first_adv));
+        }
+
+        APP_ERROR_CHECK(mesh_packet_adv_data_append(p_packed, p_adv));
+        space_left -= p_adv->adv_data_length + 1;
+        mesh_packet_ref_count_dec(pp_tx_packets[i]);
+        pp_tx_packets[i] = NULL;
+    }
+
+    if (p_packed != NULL)
+    {
+        mesh_packet_ref_count_dec(pp_tx_packets[index]);
+        pp_tx_packets[index] = p_packed;
+    }
+}
+
+/** A packet is sent with high priority if any of the values in it has the high priority flag. */
+static radio_event_priority_t tx_packet_priority(mesh_packet_t* p_packet)
+{
+    for (mesh_adv_data_t* p_adv = mesh_packet_adv_data_get(p_packet);
+            p_adv != NULL;
+            p_adv = mesh_packet_adv_data_next(p_packet, p_adv))
+    {
+        bool high_priority = false;
+        if (handle_storage_flag_get(p_adv->handle, HANDLE_FLAG_HIGH_PRIORITY, &high_priority) == NRF_SUCCESS &&
+            high_priority)
+        {
+            return RADIO_EVENT_PRIORITY_HIGH;
+        }
+    }
+    return RADIO_EVENT_PRIORITY_NORMAL;
+}
+
+/** Number of packets we can fetch per round, tc_tx() queues a radio event for every channel in the map. */
+static uint32_t tx_packets_per_round(void)
+{
+    uint32_t channel_count = 0;
+    for (uint8_t channel_map = m_tx_config.channel_map; channel_map != 0; channel_map &= (channel_map - 1))
+    {
+        channel_count++;
+    }
+    if (channel_count <= 1)
+    {
+        return RBC_MESH_RADIO_QUEUE_LENGTH - 1;
+    }
+    uint32_t count = (RBC_MESH_RADIO_QUEUE_LENGTH - 1) / channel_count;
+    return (count > 0) ? count : 1;
+}
+
 static void transmit_all_instances(uint32_t timestamp, void* p_context)
 {
     SET_PIN(8);
     mesh_packet_t* pp_tx_packets[RBC_MESH_RADIO_QUEUE_LENGTH - 1];
-    uint32_t count = RBC_MESH_RADIO_QUEUE_LENGTH - 1;
+    uint32_t count = tx_packets_per_round();
 
     uint32_t error_code = handle_storage_tx_packets_get(timestamp, pp_tx_packets, &count);
     if (error_code == NRF_SUCCESS)
     {
         for (uint32_t i = 0; i < count; ++i)
         {
-            error_code = tc_tx(pp_tx_packets[i], &m_tx_config);
+            if (pp_tx_packets[i] == NULL)
+            {
+                continue; /* packed into an earlier packet */
+            }
+
+            tx_packets_pack(pp_tx_packets, i, count);
+
+            tc_tx_config_t tx_config = m_tx_config;
+            tx_config.priority = tx_packet_priority(pp_tx_packets[i]);
+            error_code = tc_tx(pp_tx_packets[i], &tx_config);
             if (error_code == NRF_SUCCESS)
             {
                 mesh_adv_data_t* p_adv = mesh_packet_adv_data_get(pp_tx_packets[i]);
-                if (p_adv)
+                if (p_adv == NULL)
                 {
-                    PIN_OUT(p_adv->handle, 8);
-                    APP_ERROR_CHECK(handle_storage_transmitted(p_adv->handle, timestamp));
+                    APP_ERROR_CHECK(NRF_ERROR_INVALID_DATA);
                 }
-                else
+                while (p_adv)
                 {
-                    APP_ERROR_CHECK(NRF_ERROR_INVALID_DATA);
+                    PIN_OUT(p_adv->handle, 8);
+                    APP_ERROR_CHECK(handle_storage_transmitted(p_adv->handle, timestamp));
+                    large_value_tx_advance(p_adv->handle);
+                    p_adv = mesh_packet_adv_data_next(pp_tx_packets[i], p_adv);
                 }
             }
             mesh_packet_ref_count_dec(pp_tx_packets[i]);
@@ -196,6 +602,9 @@ uint32_t vh_init(uint32_t min_interval_us,
     m_tx_config.first_channel = channel;
     m_tx_config.channel_map = 1; /* Only the first channel */
     m_tx_config.tx_power = tx_power;
+    m_tx_config.priority = RADIO_EVENT_PRIORITY_NORMAL;
+
+    ack_handler_init(&m_tx_config);
 
     m_is_initialized = true;
     return NRF_SUCCESS;
@@ -211,6 +620,12 @@ void vh_tx_power_set(rbc_mesh_txpower_t tx_power)
     m_tx_config.tx_power = tx_power;
 }
 
+void vh_tx_channels_set(uint8_t first_channel, uint8_t channel_map)
+{
+    m_tx_config.first_channel = first_channel;
+    m_tx_config.channel_map = channel_map;
+}
+
 uint32_t vh_rx(mesh_packet_t* p_packet, uint32_t timestamp, uint8_t rssi)
 {
     mesh_adv_data_t* p_adv_data = mesh_packet_adv_data_get(p_packet);
@@ -219,6 +634,12 @@ uint32_t vh_rx(mesh_packet_t* p_packet, uint32_t timestamp, uint8_t rssi)
         return NRF_ERROR_INVALID_DATA;
     }
 
+    large_value_t* p_large_value = large_value_get(p_adv_data->handle);
+    if (p_large_value != NULL)
+    {
+        return large_value_rx(p_large_value, p_packet, p_adv_data, timestamp, rssi);
+    }
+
     handle_info_t info;
     uint32_t error_code = handle_storage_info_get(p_adv_data->handle, &info);
 
@@ -264,6 +685,9 @@ uint32_t vh_rx(mesh_packet_t* p_packet, uint32_t timestamp, uint8_t rssi)
             mesh_gatt_value_set(p_adv_data->handle,
                 p_adv_data->data,
                 p_adv_data->adv_data_length - MESH_PACKET_ADV_OVERHEAD);
+
+            ack_handler_value_rx(p_adv_data->handle, p_adv_data->version);
+            tc_rx_filter_add(p_adv_data);
         }
 
         vh_order_update(timestamp);
@@ -296,6 +720,13 @@ uint32_t vh_rx(mesh_packet_t* p_packet, uint32_t timestamp, uint8_t rssi)
 #endif
         }
 
+        else
+        {
+            /* the sender may have missed our acknowledgement */
+            ack_handler_value_rx(p_adv_data->handle, p_adv_data->version);
+            tc_rx_filter_add(p_adv_data);
+        }
+
         handle_storage_rx_consistent(p_adv_data->handle, timestamp);
     }
     else /* delta > 0 */
@@ -326,6 +757,9 @@ uint32_t vh_rx(mesh_packet_t* p_packet, uint32_t timestamp, uint8_t rssi)
             mesh_gatt_value_set(p_adv_data->handle,
                 p_adv_data->data,
                 p_adv_data->adv_data_length - MESH_PACKET_ADV_OVERHEAD);
+
+            ack_handler_value_rx(p_adv_data->handle, p_adv_data->version);
+            tc_rx_filter_add(p_adv_data);
         }
 
         vh_order_update(timestamp);
@@ -339,13 +773,24 @@ uint32_t vh_rx(mesh_packet_t* p_packet, uint32_t timestamp, uint8_t rssi)
     return NRF_SUCCESS;
 }
 
-uint32_t vh_local_update(rbc_mesh_value_handle_t handle, uint8_t* data, uint8_t length)
+uint32_t vh_local_update(rbc_mesh_value_handle_t handle, uint8_t* data, uint16_t length)
 {
     if (!m_is_initialized)
     {
         return NRF_ERROR_INVALID_STATE;
     }
 
+    large_value_t* p_large_value = large_value_get(handle);
+    if (p_large_value != NULL)
+    {
+        return large_value_local_update(handle, p_large_value, data, length);
+    }
+
+    if (length > RBC_MESH_VALUE_MAX_LEN)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
     uint32_t error_code;
     mesh_packet_t* p_packet = NULL;
 
@@ -411,6 +856,34 @@ uint32_t vh_value_get(rbc_mesh_value_handle_t handle, uint8_t* data, uint16_t* l
         return NRF_ERROR_NOT_FOUND;
     }
 
+    large_value_t* p_large_value = large_value_get(handle);
+    if (p_large_value != NULL)
+    {
+        mesh_packet_ref_count_dec(info.p_packet);
+
+        event_handler_critical_section_begin();
+        if (p_large_value->segment_count == 0)
+        {
+            error_code = NRF_ERROR_NOT_FOUND;
+        }
+        else if (p_large_value->segments_missing != 0 ||
+                 p_large_value->version != info.version)
+        {
+            error_code = NRF_ERROR_BUSY;
+        }
+        else if (p_large_value->length > *length)
+        {
+            error_code = NRF_ERROR_INVALID_LENGTH;
+        }
+        else
+        {
+            memcpy(data, p_large_value->data, p_large_value->length);
+            *length = p_large_value->length;
+        }
+        event_handler_critical_section_end();
+        return error_code;
+    }
+
     mesh_adv_data_t* p_adv_data = mesh_packet_adv_data_get(info.p_packet);
     if (p_adv_data == NULL)
     {
@@ -431,6 +904,11 @@ uint32_t vh_value_get(rbc_mesh_value_handle_t handle, uint8_t* data, uint16_t* l
     return NRF_SUCCESS;
 }
 
+bool vh_value_is_large(rbc_mesh_value_handle_t handle)
+{
+    return (large_value_get(handle) != NULL);
+}
+
 uint32_t vh_tx_event_set(rbc_mesh_value_handle_t handle, bool do_tx_event)
 {
     if (!m_is_initialized)
@@ -471,6 +949,20 @@ uint32_t vh_tx_event_flag_get(rbc_mesh_value_handle_t handle, bool* p_is_doing_t
     return error_code;
 }
 
+uint32_t vh_high_priority_set(rbc_mesh_value_handle_t handle, bool high_priority)
+{
+    if (!m_is_initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    if (handle == RBC_MESH_INVALID_HANDLE)
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+
+    return handle_storage_flag_set_async(handle, HANDLE_FLAG_HIGH_PRIORITY, high_priority);
+}
 
 uint32_t vh_value_enable(rbc_mesh_value_handle_t handle)
 {
@@ -545,6 +1037,26 @@ uint32_t vh_value_persistence_set(rbc_mesh_value_handle_t handle, bool persisten
     return error_code;
 }
 
+uint32_t vh_value_trickle_params_set(rbc_mesh_value_handle_t handle, const trickle_params_t* p_params)
+{
+    if (!m_is_initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    if (handle == RBC_MESH_INVALID_HANDLE)
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+
+    uint32_t error_code = handle_storage_trickle_params_set(handle, p_params);
+    if (error_code == NRF_SUCCESS)
+    {
+        vh_order_update(timer_now()); /* the value may be due earlier with the new profile */
+    }
+    return error_code;
+}
+
 uint32_t vh_value_persistence_get(rbc_mesh_value_handle_t handle, bool* p_persistent)
 {
     if (!m_is_initialized)